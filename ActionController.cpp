@@ -0,0 +1,29 @@
+#include "ActionController.h"
+
+/// <summary>
+/// Constructor
+/// </summary>
+ActionController::ActionController() :
+	_jump	(false) {}
+
+/// <summary>
+/// Destructor
+/// </summary>
+ActionController::~ActionController() = default;
+
+/// <summary>
+/// Sets the decision for the next step
+/// </summary>
+/// <param name="jump">True if the player should jump</param>
+void ActionController::setJump(const bool jump) {
+	_jump = jump;
+}
+
+/// <summary>
+/// Returns the decision set for this step
+/// </summary>
+/// <param name="player">Player asking for its next action</param>
+/// <returns></returns>
+bool ActionController::isJumpRequested(const Player& player) {
+	return _jump;
+}
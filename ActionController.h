@@ -0,0 +1,22 @@
+#ifndef ACTIONCONTROLLER_HPP
+#define ACTIONCONTROLLER_HPP
+
+#include "Controller.h"
+
+/// <summary>
+/// Jumps when told to from outside, for decisions that are made before the step
+/// </summary>
+class ActionController : public Controller {
+	public:
+		ActionController();
+		~ActionController();
+
+		void setJump(bool jump);
+
+		bool isJumpRequested(const Player& player) override;
+
+	private:
+		bool _jump;
+};
+
+#endif //ACTIONCONTROLLER_HPP
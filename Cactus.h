@@ -1,9 +1,12 @@
 #ifndef DINO_CACTUS_HPP
 #define DINO_CACTUS_HPP
 
-#include "GameObject.h"
+#include <d2d1.h>
 
-class Cactus : public GameObj {
+/// <summary>
+/// Properties of the cactus entities, see CactusFactory for their components
+/// </summary>
+class Cactus {
 	public:
 		enum CACTUS_TYPE {
 			normal = 0,
@@ -11,23 +14,12 @@ class Cactus : public GameObj {
 			high = 2
 		};
 
-		Cactus();
-		~Cactus();
+		static const int HEALTH = 1;
 
-		void onUpdate(double deltaTime) override;
-		void onRender(ID2D1HwndRenderTarget* renderTarget) override;
-		void initialize() override;
-		void handleCollision(Transform2D* collidedObject) override;
-
-		virtual CACTUS_TYPE	getType() const;
-		void setType(CACTUS_TYPE type);
-
-	private:
-		int _width  = 25;
-		int _height = 25;
-		CACTUS_TYPE								_type;
+		static float getSpeed();
+		static D2D1_SIZE_F getSize(CACTUS_TYPE type);
+		static D2D1_COLOR_F getColor();
 	};
 
 
 #endif //DINO_CACTUS_HPP
-
@@ -1,5 +1,8 @@
 #include "CactusFactory.h"
 #include "ChromeDino.h"
+#include "Components.h"
+#include "Logger.h"
+#include "SpriteAtlas.h"
 #include "Utils.h"
 
 /// <summary>
@@ -20,7 +23,7 @@ CactusFactory::~CactusFactory() = default;
 /// Initializes the factory
 /// </summary>
 void CactusFactory::initialize() {
-	if (!_logic) return;
+	if (!_logic || !_logic->getDino()) return;
 	const auto factory = _logic->getDino()->getDirect2dFactory();
 
 	if (!factory) return;
@@ -51,6 +54,7 @@ void CactusFactory::initialize() {
 		}
 		Utils::safeRelease(&sink);
 	}
+	LOG_IF_FAILED(hr, "Creating the triangle geometry");
 
 	//Create the hexagon geometry
 	hr = factory->CreatePathGeometry(&_hexagonGeometry);
@@ -81,22 +85,27 @@ void CactusFactory::initialize() {
 		}
 		Utils::safeRelease(&sink);
 	}
-	
+	LOG_IF_FAILED(hr, "Creating the hexagon geometry");
 }
 
 /// <summary>
-/// Creates a new cactus of the specified type
+/// Creates a new cactus entity of the specified type
 /// </summary>
+/// <param name="world">World to create the cactus in</param>
 /// <param name="type">Type of cactus</param>
 /// <param name="x">x Position</param>
 /// <param name="y">y Position</param>
-/// <returns></returns>
-Cactus* CactusFactory::make_cactus(const Cactus::CACTUS_TYPE type, const float x, const float y) const {
-	Cactus* newCactus = new Cactus();
-	if (newCactus) {
-		newCactus->initialize();
-		newCactus->setPos(x, y);
-		newCactus->setType(type);
-	}
-	return newCactus;
+/// <returns>The new entity</returns>
+Entity CactusFactory::make_cactus(World& world, const Cactus::CACTUS_TYPE type, const float x, const float y) const {
+	const auto size = Cactus::getSize(type);
+
+	return world.create(
+		TransformComponent{ toScalar(x), toScalar(y), toScalar(size.width), toScalar(size.height) },
+		VelocityComponent{ toScalar(-Cactus::getSpeed()), toScalar(0.0) },
+		HealthComponent{ Cactus::HEALTH },
+		ColliderComponent{ Transform2D::LAYER::cactus },
+		RenderColorComponent{ Cactus::getColor() },
+		SpriteComponent{ SpriteAtlas::cactus_normal + static_cast<uint32_t>(type) },
+		CactusComponent{ type }
+	);
 }
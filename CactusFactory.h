@@ -1,7 +1,10 @@
 #ifndef CACTUSFACTORY_HPP
 #define CACTUSFACTORY_HPP
 
+#include <d2d1.h>
+
 #include "Cactus.h"
+#include "Ecs.h"
 
 class Logic;
 
@@ -15,7 +18,7 @@ class CactusFactory {
 		CactusFactory(Logic* game);
 		~CactusFactory();
 
-		Cactus*	make_cactus(Cactus::CACTUS_TYPE type, float x, float y) const;
+		Entity	make_cactus(World& world, Cactus::CACTUS_TYPE type, float x, float y) const;
 
 		void initialize();
 };
@@ -1,12 +1,27 @@
-#include <iostream>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
 
 #include "ChromeDino.h"
 #include "Input.h"
+#include "Logger.h"
 #include "Resolution.h"
 #include "Utils.h"
 
 using namespace D2D1;
 
+//Number of simulation ticks per second
+static const double SIMULATION_RATE = 60.0;
+
+//Seconds of frames kept by the flight recorder
+static const uint32_t RECORDED_SECONDS = 30;
+
+//Maximum number of living particles
+static const size_t PARTICLE_CAPACITY = 128 * 1024;
+
+//Area of the score and the entity counts
+static const D2D1_RECT_F TEXT_BOX = { 0.0f, 0.0f, 300.0f, 60.0f };
+
 /// <summary>
 /// Constructor
 /// </summary>
@@ -16,13 +31,36 @@ ChromeDino::ChromeDino() :
 	_renderTarget	 (nullptr), 
 	_writeFactory	 (nullptr), 
 	_textFormat	     (nullptr),
-	_logic			 (this) {}
+	_particleBitmap	 (nullptr),
+	_particleLayer	 (WIDTH, HEIGHT),
+	_particleBounds	 (RectU()),
+	_hasParticles	 (false),
+	_frameBitmap	 (nullptr),
+	_damage			 (WIDTH, HEIGHT),
+	_incremental	 (false),
+	_keyboard		 (_input),
+	_logic			 (this),
+	_running		 (false) {
+	_frameEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	_logic.enableParticles(PARTICLE_CAPACITY);
+}
 
 /// <summary>
 /// Destructor
 /// </summary>
 ChromeDino::~ChromeDino() {
+	_running = false;
+	if (_simulationThread.joinable()) {
+		_simulationThread.join();
+	}
+	if (_frameEvent) {
+		CloseHandle(_frameEvent);
+	}
 	Utils::safeRelease(&_direct2dFactory);
+	_background.discardBitmaps();
+	_atlas.discardBitmap();
+	Utils::safeRelease(&_frameBitmap);
+	Utils::safeRelease(&_particleBitmap);
 	Utils::safeRelease(&_renderTarget);
 }
 
@@ -72,6 +110,7 @@ HRESULT ChromeDino::initialize() {
 			this
 		);
 		hr = _hwnd ? S_OK : E_FAIL;
+		LOG_IF_FAILED(hr, "Creating the window");
 
 		//Show the window if it was created
 		if (SUCCEEDED(hr)) {
@@ -84,20 +123,31 @@ HRESULT ChromeDino::initialize() {
 }
 
 /// <summary>
-/// Runs the message loop of the window
+/// Runs the message loop of the window and renders the latest simulated frame.
+/// The simulation runs on its own thread, so slow rendering does not slow down the game
 /// </summary>
 void ChromeDino::runGameLoop() {
 	MSG msg;
 	msg.message = WM_NULL;
 
+	if (_demoController) {
+		_logic.addPlayer(_demoController.get());
+	} else {
+		_logic.addPlayer(&_keyboard);
+	}
 	_logic.initialize();
+	LOG_INFO("Game started with {} controlling the player", _demoController ? "a trained network" : "the keyboard");
+
+	_running = true;
+	_simulationThread = std::thread(&ChromeDino::runSimulation, this);
+
 	//Get all the messages from this thread's windows
 	while(msg.message != WM_QUIT) {
 		//Check for message
 		if(PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
 			auto wasHandled = false;
 			//Handle all keyboard messages
-			wasHandled = Input::getInstance().tryHandleKeyboardMessage(msg);
+			wasHandled = _input.tryHandleKeyboardMessage(msg);
 
 			if (!wasHandled) {
 				TranslateMessage(&msg);
@@ -105,20 +155,165 @@ void ChromeDino::runGameLoop() {
 				DispatchMessage(&msg);
 			}
 		} else {
-			if(Input::getInstance().isKeyDown(Input::Escape)) {
-				break;
+			//Sleep until the simulation published a frame or a message arrived
+			MsgWaitForMultipleObjects(1, &_frameEvent, FALSE, INFINITE, QS_ALLINPUT);
+
+			if (_frames.acquireLatest()) {
+				onRender();
 			}
+		}
+	}
+
+	_running = false;
+	_simulationThread.join();
 
-			//Update and render the game
-			_timer.Tick([&]() {
-				onUpdate(_timer);
-			});
+	LOG_INFO("Game ended after {} frames with a score of {}", _logic.getFrameCount(), _logic.getScore());
+	if (_incremental) {
+		LOG_INFO("Redrew {} percent of the pixels per frame on average", _damage.getAverageFraction() * 100.0);
+	}
+}
 
-			onRender();
+/// <summary>
+/// Runs the simulation at a fixed rate and publishes a snapshot after every tick
+/// </summary>
+void ChromeDino::runSimulation() {
+	_timer.SetFixedTimeStep(true);
+	_timer.SetTargetElapsedSeconds(1.0 / SIMULATION_RATE);
+	_timer.ResetElapsedTime();
+
+	while (_running) {
+		const auto frameCount = _timer.GetFrameCount();
+
+		//Update the game, every update sees the input up to its own time
+		_timer.Tick([&]() {
+			_input.sampleUntil(_timer.GetTickTimestamp());
+			onUpdate(_timer);
+		});
+
+		if (_timer.GetFrameCount() != frameCount) {
+			_logic.writeSnapshot(_frames.getWriteBuffer());
+			_frames.publish();
+			SetEvent(_frameEvent);
+		} else {
+			//Wait for the next tick
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
 		}
 	}
 }
 
+/// <summary>
+/// Stops the simulation and closes the window, callable from any thread
+/// </summary>
+void ChromeDino::requestClose() {
+	if (_running.exchange(false)) {
+		PostMessage(_hwnd, WM_CLOSE, 0, 0);
+	}
+}
+
+/// <summary>
+/// Plays the course stored in a file instead of a generated one
+/// </summary>
+/// <param name="path">Path of the course file</param>
+/// <returns>HRESULT</returns>
+HRESULT ChromeDino::loadCourse(const char* path) {
+	auto hr = _courseFile.open(path);
+
+	if (SUCCEEDED(hr)) {
+		_logic.setObstacleSource(&_courseFile);
+	} else {
+		LOG_ERROR("Loading the course {} failed with {}", path, Logger::hresult(hr));
+	}
+	return hr;
+}
+
+/// <summary>
+/// Records the state of every frame into a trace file
+/// </summary>
+/// <param name="path">Path of the trace file</param>
+/// <returns>HRESULT</returns>
+HRESULT ChromeDino::startTrace(const char* path) {
+	auto hr = _tracer.open(path);
+
+	if (SUCCEEDED(hr)) {
+		_logic.setTracer(&_tracer);
+	} else {
+		LOG_ERROR("Starting the trace {} failed with {}", path, Logger::hresult(hr));
+	}
+	return hr;
+}
+
+/// <summary>
+/// Keeps the last seconds of the game in a flight recorder file, it stays readable after a crash
+/// </summary>
+/// <param name="path">Path of the recording</param>
+/// <returns>HRESULT</returns>
+HRESULT ChromeDino::startRecording(const char* path) {
+	const auto usesCourseFile = &_logic.getCourse() == static_cast<const ObstacleSource*>(&_courseFile);
+	auto hr = _recorder.open(path, RECORDED_SECONDS, _logic.getCourseSeed(), usesCourseFile ? FlightRecorder::FLAG_COURSE_FILE : 0);
+
+	if (SUCCEEDED(hr)) {
+		_logic.setRecorder(&_recorder);
+	} else {
+		LOG_WARNING("Starting the flight recorder {} failed with {}", path, Logger::hresult(hr));
+	}
+	return hr;
+}
+
+/// <summary>
+/// Maps the sprites of the game from an atlas file, the sprites are painted if the file can not be used
+/// </summary>
+/// <param name="path">Path of the atlas file</param>
+/// <returns>HRESULT</returns>
+HRESULT ChromeDino::loadAtlas(const char* path) {
+	const auto hr = _atlas.open(path);
+
+	if (FAILED(hr)) {
+		LOG_INFO("Opening the atlas {} failed with {}, painting the sprites", path, Logger::hresult(hr));
+		_atlas.createDefault();
+	}
+	return hr;
+}
+
+/// <summary>
+/// Lets a trained network play instead of the keyboard, for the demo mode
+/// </summary>
+/// <param name="path">Path of the genome file</param>
+/// <returns>HRESULT</returns>
+HRESULT ChromeDino::loadGenome(const char* path) {
+	NeuralPopulation::Genome genome;
+	auto hr = NeuralPopulation::loadGenome(path, genome);
+
+	if (SUCCEEDED(hr)) {
+		_demoNetwork.reset(new NeuralPopulation(1));
+		_demoNetwork->getGenome(0) = genome;
+		_demoNetwork->pack();
+		_demoController.reset(new NeuralController(*_demoNetwork, 0));
+	} else {
+		LOG_ERROR("Loading the genome {} failed with {}", path, Logger::hresult(hr));
+	}
+	return hr;
+}
+
+/// <summary>
+/// Draws the frames on the CPU instead of with Direct2D, has to be called before the window is created
+/// </summary>
+void ChromeDino::useSoftwareRenderer() {
+	_softwareRenderer.reset(new SoftwareRenderer(WIDTH, HEIGHT));
+	_softwareRenderer->setAtlas(&_atlas);
+	_softwareRenderer->setIncremental(_incremental);
+}
+
+/// <summary>
+/// Draws only the pixels that changed since the last frame, the window keeps the rest.
+/// Has to be called before the window is created
+/// </summary>
+void ChromeDino::useIncrementalRendering() {
+	_incremental = true;
+	if (_softwareRenderer) {
+		_softwareRenderer->setIncremental(true);
+	}
+}
+
 /// <summary>
 /// Returns the direct2d factory
 /// </summary>
@@ -168,6 +363,7 @@ HRESULT ChromeDino::createDeviceIndependantResources() {
 
 		_textFormat->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_CENTER);
 	}
+	LOG_IF_FAILED(hr, "Creating the device independent resources");
 
 	return hr;
 }
@@ -190,12 +386,45 @@ HRESULT ChromeDino::createDeviceResources() {
 			rc.bottom - rc.top
 		);
 
-		// Create a Direct2D render target.
+		// Create a Direct2D render target, in incremental mode it keeps the pixels of the last frame.
 		hr = _direct2dFactory->CreateHwndRenderTarget(
 			RenderTargetProperties(),
-			HwndRenderTargetProperties(_hwnd, size),
+			HwndRenderTargetProperties(_hwnd, size, _incremental ? D2D1_PRESENT_OPTIONS_RETAIN_CONTENTS : D2D1_PRESENT_OPTIONS_NONE),
 			&_renderTarget
 		);
+		LOG_IF_FAILED(hr, "Creating the render target");
+		_damage.invalidate();
+
+		//The particles are drawn on the CPU and uploaded into this bitmap
+		if (SUCCEEDED(hr)) {
+			hr = _renderTarget->CreateBitmap(
+				SizeU(WIDTH, HEIGHT),
+				nullptr,
+				0,
+				BitmapProperties(PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED)),
+				&_particleBitmap
+			);
+			LOG_IF_FAILED(hr, "Creating the particle bitmap");
+		}
+		if (SUCCEEDED(hr)) {
+			hr = _background.createBitmaps(_renderTarget);
+			LOG_IF_FAILED(hr, "Creating the background bitmaps");
+		}
+		if (SUCCEEDED(hr) && _atlas.isLoaded()) {
+			hr = _atlas.createBitmap(_renderTarget);
+			LOG_IF_FAILED(hr, "Creating the atlas bitmap");
+		}
+		//The software renderer draws whole frames that are uploaded into this bitmap
+		if (SUCCEEDED(hr) && _softwareRenderer) {
+			hr = _renderTarget->CreateBitmap(
+				SizeU(WIDTH, HEIGHT),
+				nullptr,
+				0,
+				BitmapProperties(PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED)),
+				&_frameBitmap
+			);
+			LOG_IF_FAILED(hr, "Creating the frame bitmap");
+		}
 	}
 	return hr;
 }
@@ -204,6 +433,10 @@ HRESULT ChromeDino::createDeviceResources() {
 /// Releases the device resources
 /// </summary>
 void ChromeDino::discardDeviceResources() {
+	_background.discardBitmaps();
+	_atlas.discardBitmap();
+	Utils::safeRelease(&_frameBitmap);
+	Utils::safeRelease(&_particleBitmap);
 	Utils::safeRelease(&_renderTarget);
 }
 
@@ -222,32 +455,176 @@ HRESULT ChromeDino::onRender() {
 
 		_renderTarget->SetTransform(Matrix3x2F::Identity());
 
-		//clear the window to white
-		_renderTarget->Clear(ColorF(ColorF::LightSkyBlue)); 
-
-		//Render the game
-		_logic.onRender(_renderTarget, _textFormat);
+		//Render the latest frame of the game
+		drawSnapshot(_frames.getReadBuffer());
 
 		//End drawing
 		hr = _renderTarget->EndDraw();
 	}
 	if (hr == D2DERR_RECREATE_TARGET) {
+		LOG_WARNING("The render target was lost and gets recreated");
 		hr = S_OK;
 		discardDeviceResources();
 	}
+	LOG_IF_FAILED(hr, "Drawing the frame");
 
 	return hr;
 }
 
 /// <summary>
-/// Updates the game logic
+/// Draws a simulated frame, in incremental mode only the rectangles damaged since the last frame
+/// </summary>
+/// <param name="snapshot">Frame to draw</param>
+void ChromeDino::drawSnapshot(const FrameSnapshot& snapshot) {
+	//One brush for all rects, only its color changes
+	ID2D1SolidColorBrush* brush;
+	if (FAILED(_renderTarget->CreateSolidColorBrush(ColorF(ColorF::Black), &brush))) return;
+
+	//Create string to display
+	std::wstringstream ss;
+	ss << L"Score: ";
+	ss << std::setw(4) << std::setfill(L'0') << static_cast<int>(snapshot.score);
+	ss << L"\nDrawn: " << snapshot.drawn << L" Culled: " << snapshot.culled;
+	const auto str = ss.str();
+
+	//Pixels drawn on the CPU are prepared once, no matter in how many rectangles they are shown
+	if (_softwareRenderer) {
+		_softwareRenderer->render(snapshot);
+	} else {
+		splatParticles(snapshot);
+	}
+
+	if (_incremental) {
+		_damage.begin();
+		_damage.addSnapshot(snapshot, _background);
+		_damage.add(TEXT_BOX, std::hash<std::wstring>()(str));
+		_damage.end();
+
+		//The target kept the last frame, the whole scene is drawn again but clipped to the damage
+		for (const auto& rect : _damage.getRects()) {
+			_renderTarget->PushAxisAlignedClip(
+				RectF(static_cast<float>(rect.left), static_cast<float>(rect.top), static_cast<float>(rect.right), static_cast<float>(rect.bottom)),
+				D2D1_ANTIALIAS_MODE_ALIASED);
+			drawScene(snapshot, str, brush, rect);
+			_renderTarget->PopAxisAlignedClip();
+		}
+	} else {
+		drawScene(snapshot, str, brush, RectU(0, 0, WIDTH, HEIGHT));
+	}
+
+	Utils::safeRelease(&brush);
+}
+
+/// <summary>
+/// Draws the sky, the background, the entities, the particles and the text
+/// </summary>
+/// <param name="snapshot">Frame to draw</param>
+/// <param name="text">Score and entity counts</param>
+/// <param name="brush">Brush for the rects and the text</param>
+/// <param name="area">Pixels that get drawn, the software frame is only uploaded there</param>
+void ChromeDino::drawScene(const FrameSnapshot& snapshot, const std::wstring& text, ID2D1SolidColorBrush* brush, const D2D1_RECT_U& area) {
+	if (_softwareRenderer) {
+		drawSoftwareFrame(area);
+	} else {
+		//Clear the window to the sky, the background layers are cached bitmaps
+		_renderTarget->Clear(ColorF(ColorF::LightSkyBlue));
+		_background.draw(_renderTarget, snapshot.time);
+
+		//Sprites are drawn from the atlas, rectangles without one are filled
+		auto* atlas = _atlas.getBitmap();
+		for (auto& rect : snapshot.rects) {
+			if (atlas && rect.sprite != FrameSnapshot::NO_SPRITE) {
+				const auto source = _atlas.getSourceRect(rect.sprite);
+				_renderTarget->DrawBitmap(atlas, rect.rect, 1.0f, D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR, &source);
+			} else {
+				brush->SetColor(rect.color);
+				_renderTarget->FillRectangle(rect.rect, brush);
+			}
+		}
+
+		drawParticles();
+	}
+
+	//Render kills
+	brush->SetColor(ColorF(ColorF::Black));
+	_renderTarget->DrawText(
+		text.c_str(),
+		static_cast<UINT32>(text.length()),
+		_textFormat,
+		TEXT_BOX,
+		brush
+	);
+}
+
+/// <summary>
+/// Splats the particles of a frame on the CPU and uploads them into the particle bitmap,
+/// only the rectangle around the particles is cleared and uploaded
+/// </summary>
+/// <param name="snapshot">Frame to draw</param>
+void ChromeDino::splatParticles(const FrameSnapshot& snapshot) {
+	if (_hasParticles) {
+		_particleLayer.clearRect(_particleBounds, 0);
+	}
+	_hasParticles = ParticleSystem::splat(snapshot, _particleLayer, 1.0f, _particleBounds);
+	if (!_hasParticles || !_particleBitmap) return;
+
+	const auto* pixels = _particleLayer.getRow(_particleBounds.top) + _particleBounds.left;
+	if (FAILED(_particleBitmap->CopyFromMemory(&_particleBounds, pixels, _particleLayer.getPitch()))) {
+		_hasParticles = false;
+	}
+}
+
+/// <summary>
+/// Draws the splatted particles with a single bitmap
+/// </summary>
+void ChromeDino::drawParticles() {
+	if (!_hasParticles || !_particleBitmap) return;
+
+	const auto rect = RectF(
+		static_cast<float>(_particleBounds.left),
+		static_cast<float>(_particleBounds.top),
+		static_cast<float>(_particleBounds.right),
+		static_cast<float>(_particleBounds.bottom)
+	);
+	_renderTarget->DrawBitmap(_particleBitmap, rect, 1.0f, D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR, &rect);
+}
+
+/// <summary>
+/// Shows a part of the frame drawn on the CPU, only that part is uploaded into the bitmap
+/// </summary>
+/// <param name="area">Pixels to show</param>
+void ChromeDino::drawSoftwareFrame(const D2D1_RECT_U& area) {
+	if (!_frameBitmap || area.left >= area.right || area.top >= area.bottom) return;
+
+	const auto& frame = _softwareRenderer->getFrame();
+	const auto* pixels = frame.getRow(area.top) + area.left;
+	if (FAILED(_frameBitmap->CopyFromMemory(&area, pixels, frame.getPitch()))) return;
+
+	const auto rect = RectF(
+		static_cast<float>(area.left),
+		static_cast<float>(area.top),
+		static_cast<float>(area.right),
+		static_cast<float>(area.bottom)
+	);
+	_renderTarget->DrawBitmap(_frameBitmap, rect, 1.0f, D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR, &rect);
+}
+
+/// <summary>
+/// Updates the game logic, runs on the simulation thread
 /// </summary>
 /// <param name="timer">Timer to get delta time</param>
 void ChromeDino::onUpdate(const StepTimer& timer) {
+	//Catch-up ticks after the game ended are skipped
+	if (!_running) return;
+
+	if (_demoNetwork) {
+		_demoNetwork->decide(_logic);
+	}
+
 	auto delta = timer.GetElapsedSeconds();
-	if(_logic.onUpdate(delta)) {
+	if(_logic.onUpdate(delta) || _input.isKeyDown(Input::Escape)) {
 		//Game ended
-		PostQuitMessage(0);
+		requestClose();
 	}
 }
 
@@ -263,6 +640,7 @@ void ChromeDino::onResize(UINT width, UINT height) {
 		// the next time EndDraw is called.
 		_renderTarget->Resize(SizeU(width, height));
 	}
+	_damage.invalidate();
 }
 
 /// <summary>
@@ -4,9 +4,26 @@
 #include <windows.h>
 #include <d2d1.h>
 #include <Dwrite.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
 
 #include "StepTimer.h"
 #include "Logic.h"
+#include "CourseFile.h"
+#include "DamageTracker.h"
+#include "FlightRecorder.h"
+#include "StateTracer.h"
+#include "KeyboardController.h"
+#include "NeuralController.h"
+#include "NeuralPopulation.h"
+#include "FrameSnapshot.h"
+#include "Framebuffer.h"
+#include "ParallaxBackground.h"
+#include "SoftwareRenderer.h"
+#include "SpriteAtlas.h"
+#include "TripleBuffer.h"
 
 //Base address of dos module, same as the address of the current instance
 #ifndef HINST_THISCOMPONENT
@@ -20,6 +37,13 @@ class ChromeDino {
 	    ~ChromeDino();
 
 	    HRESULT	initialize();
+	    HRESULT	loadCourse(const char* path);
+	    HRESULT	startTrace(const char* path);
+	    HRESULT	loadGenome(const char* path);
+	    HRESULT	startRecording(const char* path);
+	    HRESULT	loadAtlas(const char* path);
+	    void useSoftwareRenderer();
+	    void useIncrementalRendering();
 	    ID2D1Factory* getDirect2dFactory() const;
 
 	    void runGameLoop();
@@ -30,9 +54,32 @@ class ChromeDino {
 		ID2D1HwndRenderTarget* _renderTarget;
 		IDWriteFactory*		   _writeFactory;
 		IDWriteTextFormat*	   _textFormat;
+		ID2D1Bitmap*		   _particleBitmap;
+		Framebuffer			   _particleLayer;
+		D2D1_RECT_U			   _particleBounds;
+		bool				   _hasParticles;
+		ParallaxBackground	   _background;
+		ID2D1Bitmap*		   _frameBitmap;
+		SpriteAtlas			   _atlas;
+		DamageTracker		   _damage;
+		bool				   _incremental;
 		StepTimer			   _timer;
+		Input				   _input;
+		KeyboardController	   _keyboard;
+		CourseFile			   _courseFile;
+		StateTracer			   _tracer;
+		FlightRecorder		   _recorder;
 		Logic				   _logic;
 
+		std::unique_ptr<NeuralPopulation> _demoNetwork;
+		std::unique_ptr<NeuralController> _demoController;
+		std::unique_ptr<SoftwareRenderer> _softwareRenderer;
+
+		std::thread					_simulationThread;
+		std::atomic<bool>			_running;
+		TripleBuffer<FrameSnapshot> _frames;
+		HANDLE						_frameEvent;
+
 		HRESULT	createDeviceIndependantResources();
 		HRESULT	createDeviceResources();
 
@@ -40,7 +87,14 @@ class ChromeDino {
 
 		HRESULT	onRender();
 
+		void drawSnapshot(const FrameSnapshot& snapshot);
+		void drawScene(const FrameSnapshot& snapshot, const std::wstring& text, ID2D1SolidColorBrush* brush, const D2D1_RECT_U& area);
+		void splatParticles(const FrameSnapshot& snapshot);
+		void drawParticles();
+		void drawSoftwareFrame(const D2D1_RECT_U& area);
+		void runSimulation();
 		void onUpdate(const StepTimer& timer);
+		void requestClose();
 		void onResize(UINT width, UINT height);
 
 		static LRESULT CALLBACK	wndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
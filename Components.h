@@ -0,0 +1,80 @@
+#ifndef COMPONENTS_HPP
+#define COMPONENTS_HPP
+
+#include <d2d1.h>
+
+#include "Cactus.h"
+#include "Transform2d.h"
+
+/// <summary>
+/// Position and size of an entity, y is the bottom edge like in Transform2D
+/// </summary>
+struct TransformComponent {
+	Scalar x;
+	Scalar y;
+	Scalar w;
+	Scalar h;
+};
+
+/// <summary>
+/// Movement per second
+/// </summary>
+struct VelocityComponent {
+	Scalar x;
+	Scalar y;
+};
+
+/// <summary>
+/// Entities with health of zero or less get destroyed at the end of the frame
+/// </summary>
+struct HealthComponent {
+	int value;
+};
+
+/// <summary>
+/// Collision layer of an entity
+/// </summary>
+struct ColliderComponent {
+	Transform2D::LAYER layer;
+};
+
+/// <summary>
+/// Fill color of an entity
+/// </summary>
+struct RenderColorComponent {
+	D2D1_COLOR_F color;
+};
+
+/// <summary>
+/// Sprite of the atlas an entity is drawn with
+/// </summary>
+struct SpriteComponent {
+	uint32_t sprite;
+};
+
+/// <summary>
+/// Marks an entity as a cactus of the given type
+/// </summary>
+struct CactusComponent {
+	Cactus::CACTUS_TYPE type;
+};
+
+/// <summary>
+/// Returns the axis-aligned bounding box of a transform
+/// </summary>
+/// <param name="transform">Transform of the entity</param>
+/// <returns>Rect</returns>
+inline D2D1_RECT_F getAABB(const TransformComponent& transform) {
+	return D2D1::RectF(toFloat(transform.x), toFloat(transform.y - transform.h), toFloat(transform.x + transform.w), toFloat(transform.y));
+}
+
+/// <summary>
+/// Returns the bounding box of a transform in simulation numbers
+/// </summary>
+/// <param name="transform">Transform of the entity</param>
+/// <returns></returns>
+inline Bounds getBounds(const TransformComponent& transform) {
+	return Bounds{ transform.x, transform.y - transform.h, transform.x + transform.w, transform.y };
+}
+
+#endif //COMPONENTS_HPP
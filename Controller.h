@@ -0,0 +1,22 @@
+#ifndef CONTROLLER_HPP
+#define CONTROLLER_HPP
+
+class Player;
+
+/// <summary>
+/// Source of the decisions of a player.
+/// Players are updated in parallel, so a controller shared by several players has to be thread safe
+/// </summary>
+class Controller {
+	public:
+		virtual ~Controller() = default;
+
+		/// <summary>
+		/// Returns true if the player should jump this frame
+		/// </summary>
+		/// <param name="player">Player asking for its next action</param>
+		/// <returns></returns>
+		virtual bool isJumpRequested(const Player& player) = 0;
+};
+
+#endif //CONTROLLER_HPP
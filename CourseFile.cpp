@@ -0,0 +1,234 @@
+#include <cmath>
+
+#include "CourseFile.h"
+#include "Cactus.h"
+#include "Logger.h"
+
+//Identifies course files
+static const char COURSE_MAGIC[4] = { 'D', 'C', 'R', 'S' };
+
+//Largest position of a record, leaves room for the size and the movement of a cactus in 16.16 fixed point
+static const float MAX_POSITION = 16384.0f;
+
+static_assert(sizeof(CourseFile::Header) == 32, "Course file header has to stay 32 bytes");
+
+/// <summary>
+/// Constructor
+/// </summary>
+CourseFile::CourseFile() :
+	_file		(INVALID_HANDLE_VALUE),
+	_mapping	(nullptr),
+	_view		(nullptr),
+	_header		(nullptr),
+	_records	(nullptr),
+	_next		(0),
+	_checked	(0),
+	_ended		(false) {}
+
+/// <summary>
+/// Destructor
+/// </summary>
+CourseFile::~CourseFile() {
+	close();
+}
+
+/// <summary>
+/// Maps a course file into memory and checks its header
+/// </summary>
+/// <param name="path">Path of the course file</param>
+/// <returns>HRESULT</returns>
+HRESULT CourseFile::open(const char* path) {
+	close();
+
+	_file = CreateFile(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	auto hr = _file != INVALID_HANDLE_VALUE ? S_OK : E_FAIL;
+
+	LARGE_INTEGER size;
+	if (SUCCEEDED(hr)) {
+		hr = GetFileSizeEx(_file, &size) && size.QuadPart >= static_cast<LONGLONG>(sizeof(Header)) ? S_OK : E_INVALIDARG;
+	}
+	if (SUCCEEDED(hr)) {
+		_mapping = CreateFileMapping(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		hr = _mapping ? S_OK : E_FAIL;
+	}
+	if (SUCCEEDED(hr)) {
+		_view = MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+		hr = _view ? S_OK : E_FAIL;
+	}
+	if (SUCCEEDED(hr)) {
+		//Only accept files that hold every record the header promises
+		_header = static_cast<const Header*>(_view);
+		const auto available = (static_cast<uint64_t>(size.QuadPart) - sizeof(Header)) / sizeof(ObstacleRecord);
+
+		if (memcmp(_header->magic, COURSE_MAGIC, sizeof(COURSE_MAGIC)) != 0 ||
+			_header->version != VERSION ||
+			_header->recordSize != sizeof(ObstacleRecord) ||
+			_header->recordCount > available) {
+			hr = E_INVALIDARG;
+		}
+	}
+	if (SUCCEEDED(hr)) {
+		_records = reinterpret_cast<const ObstacleRecord*>(static_cast<const char*>(_view) + sizeof(Header));
+		_next = 0;
+		_checked = 0;
+		_ended = false;
+	} else {
+		close();
+	}
+	return hr;
+}
+
+/// <summary>
+/// Unmaps the course file
+/// </summary>
+void CourseFile::close() {
+	if (_view) {
+		UnmapViewOfFile(_view);
+	}
+	if (_mapping) {
+		CloseHandle(_mapping);
+	}
+	if (_file != INVALID_HANDLE_VALUE) {
+		CloseHandle(_file);
+	}
+	_file = INVALID_HANDLE_VALUE;
+	_mapping = nullptr;
+	_view = nullptr;
+	_header = nullptr;
+	_records = nullptr;
+	_next = 0;
+	_checked = 0;
+	_ended = false;
+}
+
+/// <summary>
+/// Writes the next obstacles of a source into a new course file.
+/// The file is written through a mapping as well, so huge courses never go through a stream
+/// </summary>
+/// <param name="path">Path of the course file</param>
+/// <param name="source">Source of the obstacles, gets consumed</param>
+/// <param name="count">Number of obstacles to write</param>
+/// <param name="seed">Seed the source was created with, stored for reference</param>
+/// <returns>HRESULT</returns>
+HRESULT CourseFile::write(const char* path, ObstacleSource& source, const uint64_t count, const uint64_t seed) {
+	const auto size = sizeof(Header) + count * sizeof(ObstacleRecord);
+
+	auto file = CreateFile(path, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	auto hr = file != INVALID_HANDLE_VALUE ? S_OK : E_FAIL;
+
+	HANDLE mapping = nullptr;
+	void* view = nullptr;
+	if (SUCCEEDED(hr)) {
+		mapping = CreateFileMapping(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size & 0xFFFFFFFF), nullptr);
+		hr = mapping ? S_OK : E_FAIL;
+	}
+	if (SUCCEEDED(hr)) {
+		view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0);
+		hr = view ? S_OK : E_FAIL;
+	}
+	if (SUCCEEDED(hr)) {
+		auto* header = static_cast<Header*>(view);
+		memcpy(header->magic, COURSE_MAGIC, sizeof(COURSE_MAGIC));
+		header->version = VERSION;
+		header->recordSize = sizeof(ObstacleRecord);
+		header->reserved = 0;
+		header->recordCount = count;
+		header->seed = seed;
+
+		auto* records = reinterpret_cast<ObstacleRecord*>(static_cast<char*>(view) + sizeof(Header));
+		for (uint64_t i = 0; i < count; i++) {
+			if (source.getLookahead() == 0) {
+				hr = E_FAIL;
+				break;
+			}
+			records[i] = source.peek(0);
+			source.advance();
+			source.retire(1);
+		}
+	}
+
+	if (view) {
+		UnmapViewOfFile(view);
+	}
+	if (mapping) {
+		CloseHandle(mapping);
+	}
+	if (file != INVALID_HANDLE_VALUE) {
+		CloseHandle(file);
+	}
+	return hr;
+}
+
+/// <summary>
+/// Returns the number of obstacles in the course
+/// </summary>
+/// <returns></returns>
+uint64_t CourseFile::getRecordCount() const {
+	return _header ? _header->recordCount : 0;
+}
+
+/// <summary>
+/// Returns the seed the course was generated with
+/// </summary>
+/// <returns></returns>
+uint64_t CourseFile::getSeed() const {
+	return _header ? _header->seed : 0;
+}
+
+/// <summary>
+/// Returns the number of checked obstacles that have not been spawned yet.
+/// A record is only checked once it comes up, so opening stays instant for huge courses.
+/// The course ends at the first record that fails the check
+/// </summary>
+/// <returns></returns>
+size_t CourseFile::getLookahead() const {
+	if (_checked == _next && _checked < getRecordCount() && !_ended) {
+		if (isValid(_checked)) {
+			_checked++;
+		} else {
+			_ended = true;
+			LOG_WARNING("Course record {} is invalid, the course ends there", _checked);
+		}
+	}
+	return static_cast<size_t>(_checked - _next);
+}
+
+/// <summary>
+/// Returns an upcoming obstacle, read directly from the mapped file
+/// </summary>
+/// <param name="index">0 for the next obstacle to spawn, has to be less than getLookahead()</param>
+/// <returns></returns>
+const ObstacleRecord& CourseFile::peek(const size_t index) const {
+	return _records[_next + index];
+}
+
+/// <summary>
+/// Marks the next obstacle as spawned
+/// </summary>
+void CourseFile::advance() {
+	if (_next < _checked) {
+		_next++;
+	}
+}
+
+/// <summary>
+/// Returns true if the spawn logic can trust a record: a known cactus type, finite positions
+/// in range and a finite time that does not run backwards
+/// </summary>
+/// <param name="index">Index of the record</param>
+/// <returns></returns>
+bool CourseFile::isValid(const uint64_t index) const {
+	const auto& record = _records[index];
+	if (record.type > Cactus::high) return false;
+	if (!std::isfinite(record.x) || !std::isfinite(record.y) || !std::isfinite(record.time)) return false;
+	if (std::fabs(record.x) > MAX_POSITION || std::fabs(record.y) > MAX_POSITION || record.time < 0.0) return false;
+
+	return index == 0 || record.time >= _records[index - 1].time;
+}
+
+/// <summary>
+/// Nothing to release, the system pages the mapped records in and out
+/// </summary>
+/// <param name="count">Number of obstacles that left the screen</param>
+void CourseFile::retire(size_t count) {
+}
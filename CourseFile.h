@@ -0,0 +1,65 @@
+#ifndef COURSEFILE_HPP
+#define COURSEFILE_HPP
+
+#include <windows.h>
+#include <cstdint>
+
+#include "ObstacleSource.h"
+
+/// <summary>
+/// Fixed course read from a binary file that is mapped into memory.
+/// The records are used in place, nothing gets parsed or copied
+/// </summary>
+class CourseFile : public ObstacleSource {
+	public:
+		/// <summary>
+		/// Header at the start of every course file, the records follow directly
+		/// </summary>
+		struct Header {
+			char	 magic[4];
+			uint32_t version;
+			uint32_t recordSize;
+			uint32_t reserved;
+			uint64_t recordCount;
+			uint64_t seed;
+		};
+
+		//Version 1 stored the spawn times as float
+		static const uint32_t VERSION = 2;
+
+		CourseFile();
+		~CourseFile();
+
+		HRESULT open(const char* path);
+		void close();
+
+		static HRESULT write(const char* path, ObstacleSource& source, uint64_t count, uint64_t seed);
+
+		uint64_t getRecordCount() const;
+		uint64_t getSeed() const;
+
+		size_t getLookahead() const override;
+		const ObstacleRecord& peek(size_t index) const override;
+
+		void advance() override;
+		void retire(size_t count) override;
+
+		CourseFile(const CourseFile&) = delete;
+		void operator = (const CourseFile&) = delete;
+
+	private:
+		HANDLE				  _file;
+		HANDLE				  _mapping;
+		const void*			  _view;
+		const Header*		  _header;
+		const ObstacleRecord* _records;
+		uint64_t			  _next;
+
+		//Records before this one passed isValid, the course ends early at the first one that fails
+		mutable uint64_t	  _checked;
+		mutable bool		  _ended;
+
+		bool isValid(uint64_t index) const;
+};
+
+#endif //COURSEFILE_HPP
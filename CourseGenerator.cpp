@@ -0,0 +1,133 @@
+#include "CourseGenerator.h"
+#include "Cactus.h"
+#include "Resolution.h"
+
+/// <summary>
+/// Constructor
+/// </summary>
+/// <param name="seed">Seed of the course, equal seeds give equal courses</param>
+/// <param name="params">Parameters of the course</param>
+CourseGenerator::CourseGenerator(const uint64_t seed, const CourseParams& params) :
+	_params		(params) {
+	reset(seed);
+}
+
+/// <summary>
+/// Destructor
+/// </summary>
+CourseGenerator::~CourseGenerator() = default;
+
+/// <summary>
+/// Restarts the course from the beginning
+/// </summary>
+/// <param name="seed">Seed of the course</param>
+void CourseGenerator::reset(const uint64_t seed) {
+	//A zero state would only ever produce zeros
+	_random = seed ^ 0x9E3779B97F4A7C15ull;
+	if (_random == 0) {
+		_random = 1;
+	}
+	_nextTime = 0.0;
+
+	_retired = 0;
+	_next = 0;
+	_generated = 0;
+	fill();
+}
+
+/// <summary>
+/// Sets the parameters used for the chunks generated from now on
+/// </summary>
+/// <param name="params">Parameters of the course</param>
+void CourseGenerator::setParams(const CourseParams& params) {
+	_params = params;
+}
+
+/// <summary>
+/// Returns the number of upcoming obstacles that can be peeked at
+/// </summary>
+/// <returns></returns>
+size_t CourseGenerator::getLookahead() const {
+	return static_cast<size_t>(_generated - _next);
+}
+
+/// <summary>
+/// Returns an upcoming obstacle
+/// </summary>
+/// <param name="index">0 for the next obstacle to spawn, has to be less than getLookahead()</param>
+/// <returns></returns>
+const ObstacleRecord& CourseGenerator::peek(const size_t index) const {
+	return _records[(_next + index) % CAPACITY];
+}
+
+/// <summary>
+/// Marks the next obstacle as spawned
+/// </summary>
+void CourseGenerator::advance() {
+	if (_next < _generated) {
+		_next++;
+	}
+}
+
+/// <summary>
+/// Releases the oldest spawned obstacles once they scrolled off the left edge,
+/// chunks without obstacles on screen get reused for the course ahead
+/// </summary>
+/// <param name="count">Number of obstacles that left the screen</param>
+void CourseGenerator::retire(const size_t count) {
+	_retired += count;
+	if (_retired > _next) {
+		_retired = _next;
+	}
+	fill();
+}
+
+/// <summary>
+/// Generates chunks until every chunk of the ring is in use
+/// </summary>
+void CourseGenerator::fill() {
+	while (_generated / CHUNK_SIZE - _retired / CHUNK_SIZE < CHUNK_COUNT) {
+		generateChunk();
+	}
+}
+
+/// <summary>
+/// Generates the next chunk of the course into the oldest free chunk of the ring
+/// </summary>
+void CourseGenerator::generateChunk() {
+	for (size_t i = 0; i < CHUNK_SIZE; i++) {
+		auto& record = _records[(_generated + i) % CAPACITY];
+
+		//Cacti spawn with different probabilities
+		Cactus::CACTUS_TYPE type = Cactus::CACTUS_TYPE::normal;
+		const auto roll = nextRandom();
+		if (roll >= 1.0f - _params.highChance) {
+			type = Cactus::CACTUS_TYPE::high;
+		} else if (roll >= 1.0f - _params.highChance - _params.wideChance) {
+			type = Cactus::CACTUS_TYPE::wide;
+		}
+
+		record.time = _nextTime;
+		record.x = WIDTH;
+		record.y = HEIGHT - 1;
+		record.type = static_cast<uint32_t>(type);
+		record.reserved = 0;
+
+		_nextTime += _params.minSpawnSpeed + nextRandom() * (_params.maxSpawnSpeed - _params.minSpawnSpeed);
+	}
+	_generated += CHUNK_SIZE;
+}
+
+/// <summary>
+/// Returns the next random number of the course (xorshift64*)
+/// </summary>
+/// <returns>Number in [0, 1)</returns>
+float CourseGenerator::nextRandom() {
+	_random ^= _random >> 12;
+	_random ^= _random << 25;
+	_random ^= _random >> 27;
+	const auto value = _random * 0x2545F4914F6CDD1Dull;
+
+	//Top 24 bits fit exactly into a float
+	return static_cast<float>(value >> 40) / 16777216.0f;
+}
@@ -0,0 +1,66 @@
+#ifndef COURSEGENERATOR_HPP
+#define COURSEGENERATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "ObstacleRecord.h"
+#include "ObstacleSource.h"
+
+/// <summary>
+/// Parameters of the random course
+/// </summary>
+struct CourseParams {
+	float minSpawnSpeed;
+	float maxSpawnSpeed;
+	float wideChance;
+	float highChance;
+
+	CourseParams() :
+		minSpawnSpeed	(1.0f),
+		maxSpawnSpeed	(2.0f),
+		wideChance		(0.2f),
+		highChance		(0.2f) {}
+};
+
+/// <summary>
+/// Generates the course from a seed in fixed size chunks.
+/// The obstacles live in a ring of chunks: the window starts at the oldest obstacle still on screen
+/// and reaches as far ahead as there are free chunks, so memory stays constant for endless runs
+/// </summary>
+class CourseGenerator : public ObstacleSource {
+	public:
+		static const size_t CHUNK_SIZE = 64;
+		static const size_t CHUNK_COUNT = 4;
+		static const size_t CAPACITY = CHUNK_SIZE * CHUNK_COUNT;
+
+		CourseGenerator(uint64_t seed, const CourseParams& params);
+		~CourseGenerator();
+
+		void reset(uint64_t seed);
+		void setParams(const CourseParams& params);
+
+		size_t getLookahead() const override;
+		const ObstacleRecord& peek(size_t index) const override;
+
+		void advance() override;
+		void retire(size_t count) override;
+
+	private:
+		ObstacleRecord _records[CAPACITY];
+		CourseParams   _params;
+
+		uint64_t _random;
+
+		double	 _nextTime;
+
+		uint64_t _retired;
+		uint64_t _next;
+		uint64_t _generated;
+
+		void fill();
+		void generateChunk();
+		float nextRandom();
+};
+
+#endif //COURSEGENERATOR_HPP
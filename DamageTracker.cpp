@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "DamageTracker.h"
+#include "Framebuffer.h"
+#include "ParticleSystem.h"
+
+/// <summary>
+/// Constructor
+/// </summary>
+/// <param name="width">Width of the picture in pixels</param>
+/// <param name="height">Height of the picture in pixels</param>
+/// <param name="scale">Pixels of the picture per unit of the game</param>
+DamageTracker::DamageTracker(const uint32_t width, const uint32_t height, const float scale) :
+	_width			(width),
+	_height			(height),
+	_scale			(scale),
+	_invalid		(true),
+	_area			(0),
+	_touchedPixels	(0),
+	_frames			(0) {}
+
+/// <summary>
+/// Destructor
+/// </summary>
+DamageTracker::~DamageTracker() = default;
+
+/// <summary>
+/// Starts collecting the drawables of a frame
+/// </summary>
+void DamageTracker::begin() {
+	_current.clear();
+}
+
+/// <summary>
+/// Adds a drawable, moving it by less than a pixel also changes its look because it covers other pixels
+/// </summary>
+/// <param name="rect">Bounds in the coordinates of the game, every pixel it touches counts</param>
+/// <param name="look">Value that changes when the drawable looks different inside its bounds</param>
+void DamageTracker::add(const D2D1_RECT_F& rect, const uint64_t look) {
+	const auto toPixel = [](const float value, const uint32_t size) {
+		return static_cast<uint32_t>(std::min(static_cast<float>(size), std::max(0.0f, value)));
+	};
+
+	uint32_t position[4];
+	memcpy(position, &rect, sizeof(position));
+
+	auto moved = look;
+	for (const auto value : position) {
+		moved = mix(moved, value);
+	}
+
+	addBounds(D2D1::RectU(
+		toPixel(std::floor(rect.left * _scale), _width),
+		toPixel(std::floor(rect.top * _scale), _height),
+		toPixel(std::ceil(rect.right * _scale), _width),
+		toPixel(std::ceil(rect.bottom * _scale), _height)), moved);
+}
+
+/// <summary>
+/// Adds everything a renderer draws for a snapshot: the background layers, the rectangles and the particles.
+/// The background has to be painted for the same picture
+/// </summary>
+/// <param name="snapshot">Frame to draw</param>
+/// <param name="background">Background drawn below the snapshot</param>
+void DamageTracker::addSnapshot(const FrameSnapshot& snapshot, const ParallaxBackground& background) {
+	//A layer looks the same as long as it stays at the same column of its strip
+	for (size_t i = 0; i < background.getLayerCount(); i++) {
+		addBounds(background.getLayerBounds(i), background.getLayerOffset(i, snapshot.time));
+	}
+
+	for (const auto& rect : snapshot.rects) {
+		uint32_t color[4];
+		memcpy(color, &rect.color, sizeof(color));
+
+		auto look = mix(rect.sprite, color[0]);
+		look = mix(look, color[1]);
+		look = mix(look, color[2]);
+		look = mix(look, color[3]);
+		add(rect.rect, look);
+	}
+
+	//Particles move every frame, so they are tracked as one box around all of them
+	auto box = D2D1::RectU(_width, _height, 0, 0);
+	D2D1_RECT_U square;
+	for (const auto& particle : snapshot.particles) {
+		if (ParticleSystem::getSplatRect(particle, _width, _height, _scale, square)) {
+			box = unite(box, square);
+		}
+	}
+	addBounds(isEmpty(box) ? D2D1::RectU() : box, snapshot.frame);
+}
+
+/// <summary>
+/// Compares the drawables of the frame with the last frame and finds the damaged rectangles
+/// </summary>
+void DamageTracker::end() {
+	_rects.clear();
+
+	if (_invalid) {
+		damage(D2D1::RectU(0, 0, _width, _height));
+		_invalid = false;
+	} else {
+		const auto count = std::max(_previous.size(), _current.size());
+		for (size_t i = 0; i < count; i++) {
+			const auto* before = i < _previous.size() ? &_previous[i] : nullptr;
+			const auto* after = i < _current.size() ? &_current[i] : nullptr;
+
+			if (before && after && before->look == after->look && memcmp(&before->bounds, &after->bounds, sizeof(D2D1_RECT_U)) == 0) continue;
+
+			if (before) {
+				damage(before->bounds);
+			}
+			if (after) {
+				damage(after->bounds);
+			}
+		}
+	}
+
+	_area = 0;
+	for (const auto& rect : _rects) {
+		_area += getArea(rect);
+	}
+	_touchedPixels += _area;
+	_frames++;
+
+	_previous.swap(_current);
+}
+
+/// <summary>
+/// Damages the whole picture at the end of the next frame, for example after the target was recreated
+/// </summary>
+void DamageTracker::invalidate() {
+	_invalid = true;
+}
+
+/// <summary>
+/// Returns the damaged rectangles of the last frame, they do not overlap
+/// </summary>
+/// <returns>Pixel rectangles, right and bottom are exclusive</returns>
+const std::vector<D2D1_RECT_U>& DamageTracker::getRects() const {
+	return _rects;
+}
+
+/// <summary>
+/// Returns the part of the picture damaged in the last frame
+/// </summary>
+/// <returns>0 to 1</returns>
+float DamageTracker::getFraction() const {
+	const auto pixels = static_cast<uint64_t>(_width) * _height;
+	return pixels > 0 ? static_cast<float>(static_cast<double>(_area) / pixels) : 0.0f;
+}
+
+/// <summary>
+/// Returns the part of the picture damaged per frame, on average over all frames
+/// </summary>
+/// <returns>0 to 1</returns>
+float DamageTracker::getAverageFraction() const {
+	const auto pixels = static_cast<uint64_t>(_width) * _height * _frames;
+	return pixels > 0 ? static_cast<float>(static_cast<double>(_touchedPixels) / pixels) : 0.0f;
+}
+
+/// <summary>
+/// Adds a drawable with bounds in pixels
+/// </summary>
+/// <param name="bounds">Pixels of the drawable, may be empty</param>
+/// <param name="look">Value that changes when the drawable looks different inside its bounds</param>
+void DamageTracker::addBounds(const D2D1_RECT_U& bounds, const uint64_t look) {
+	_current.push_back(Drawable{ bounds, look });
+}
+
+/// <summary>
+/// Adds a rectangle to the damage, merging it with every rectangle it touches
+/// </summary>
+/// <param name="rect">Damaged pixels</param>
+void DamageTracker::damage(const D2D1_RECT_U& rect) {
+	auto merged = Framebuffer::intersect(rect, D2D1::RectU(0, 0, _width, _height));
+	if (isEmpty(merged)) return;
+
+	//The grown rectangle may touch rectangles it did not touch before, so start over after every merge
+	for (size_t i = 0; i < _rects.size();) {
+		if (touches(_rects[i], merged)) {
+			merged = unite(merged, _rects[i]);
+			_rects[i] = _rects.back();
+			_rects.pop_back();
+			i = 0;
+		} else {
+			i++;
+		}
+	}
+	_rects.push_back(merged);
+
+	if (_rects.size() > MAX_RECTS) {
+		mergeClosest();
+	}
+}
+
+/// <summary>
+/// Merges the two rectangles whose union adds the fewest pixels
+/// </summary>
+void DamageTracker::mergeClosest() {
+	size_t first = 0;
+	size_t second = 1;
+	auto smallest = UINT64_MAX;
+
+	for (size_t i = 0; i < _rects.size(); i++) {
+		for (size_t j = i + 1; j < _rects.size(); j++) {
+			const auto growth = getArea(unite(_rects[i], _rects[j])) - getArea(_rects[i]) - getArea(_rects[j]);
+			if (growth < smallest) {
+				smallest = growth;
+				first = i;
+				second = j;
+			}
+		}
+	}
+
+	const auto merged = unite(_rects[first], _rects[second]);
+	_rects.erase(_rects.begin() + second);
+	_rects.erase(_rects.begin() + first);
+	damage(merged);
+}
+
+/// <summary>
+/// Returns true if a rectangle has no pixels
+/// </summary>
+/// <param name="rect">Pixel rectangle</param>
+/// <returns></returns>
+bool DamageTracker::isEmpty(const D2D1_RECT_U& rect) {
+	return rect.left >= rect.right || rect.top >= rect.bottom;
+}
+
+/// <summary>
+/// Returns true if two rectangles overlap or share an edge
+/// </summary>
+/// <param name="a">Pixel rectangle</param>
+/// <param name="b">Pixel rectangle</param>
+/// <returns></returns>
+bool DamageTracker::touches(const D2D1_RECT_U& a, const D2D1_RECT_U& b) {
+	return a.left <= b.right && b.left <= a.right && a.top <= b.bottom && b.top <= a.bottom;
+}
+
+/// <summary>
+/// Returns the smallest rectangle around two rectangles
+/// </summary>
+/// <param name="a">Pixel rectangle</param>
+/// <param name="b">Pixel rectangle</param>
+/// <returns></returns>
+D2D1_RECT_U DamageTracker::unite(const D2D1_RECT_U& a, const D2D1_RECT_U& b) {
+	return D2D1::RectU(std::min(a.left, b.left), std::min(a.top, b.top), std::max(a.right, b.right), std::max(a.bottom, b.bottom));
+}
+
+/// <summary>
+/// Returns the number of pixels of a rectangle
+/// </summary>
+/// <param name="rect">Pixel rectangle</param>
+/// <returns></returns>
+uint64_t DamageTracker::getArea(const D2D1_RECT_U& rect) {
+	return isEmpty(rect) ? 0 : static_cast<uint64_t>(rect.right - rect.left) * (rect.bottom - rect.top);
+}
+
+/// <summary>
+/// Combines a value into the look of a drawable
+/// </summary>
+/// <param name="look">Look so far</param>
+/// <param name="value">Value to add</param>
+/// <returns></returns>
+uint64_t DamageTracker::mix(const uint64_t look, const uint64_t value) {
+	return (look ^ value) * 0x100000001B3ull;
+}
@@ -0,0 +1,69 @@
+#ifndef DAMAGETRACKER_HPP
+#define DAMAGETRACKER_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <d2d1.h>
+
+#include "FrameSnapshot.h"
+#include "ParallaxBackground.h"
+
+/// <summary>
+/// Finds the pixels of a picture that have to be redrawn because something changed since the last frame.
+/// Every frame the drawables are added with their bounds and a value for their look, in the same order each frame.
+/// A drawable with the same bounds and look as the one at its position in the last frame damages nothing,
+/// otherwise its old and new bounds are damaged. The damage is kept as a few rectangles that do not overlap,
+/// rectangles that touch are merged and if there are too many the two that grow the least are merged
+/// </summary>
+class DamageTracker {
+	public:
+		static const size_t MAX_RECTS = 8;
+
+		DamageTracker(uint32_t width, uint32_t height, float scale = 1.0f);
+		~DamageTracker();
+
+		void begin();
+		void add(const D2D1_RECT_F& rect, uint64_t look);
+		void addSnapshot(const FrameSnapshot& snapshot, const ParallaxBackground& background);
+		void end();
+		void invalidate();
+
+		const std::vector<D2D1_RECT_U>& getRects() const;
+		float getFraction() const;
+		float getAverageFraction() const;
+
+	private:
+		/// <summary>
+		/// Pixels of a drawable and what they look like
+		/// </summary>
+		struct Drawable {
+			D2D1_RECT_U bounds;
+			uint64_t	look;
+		};
+
+		uint32_t _width;
+		uint32_t _height;
+		float	 _scale;
+		bool	 _invalid;
+
+		std::vector<Drawable>	 _previous;
+		std::vector<Drawable>	 _current;
+		std::vector<D2D1_RECT_U> _rects;
+
+		uint64_t _area;
+		uint64_t _touchedPixels;
+		uint64_t _frames;
+
+		void addBounds(const D2D1_RECT_U& bounds, uint64_t look);
+		void damage(const D2D1_RECT_U& rect);
+		void mergeClosest();
+
+		static bool isEmpty(const D2D1_RECT_U& rect);
+		static bool touches(const D2D1_RECT_U& a, const D2D1_RECT_U& b);
+		static D2D1_RECT_U unite(const D2D1_RECT_U& a, const D2D1_RECT_U& b);
+		static uint64_t getArea(const D2D1_RECT_U& rect);
+		static uint64_t mix(uint64_t look, uint64_t value);
+};
+
+#endif //DAMAGETRACKER_HPP
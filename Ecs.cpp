@@ -0,0 +1,345 @@
+#include <atomic>
+
+#include "Ecs.h"
+
+//Sizes of the registered component types
+static size_t componentSizes[ComponentRegistry::MAX_COMPONENTS];
+static std::atomic<unsigned int> componentCount(0);
+
+//Alignment of the component arrays inside a chunk
+static const size_t ARRAY_ALIGNMENT = 16;
+
+/// <summary>
+/// Rounds the value up to the array alignment
+/// </summary>
+/// <param name="value">Value to align</param>
+/// <returns></returns>
+static size_t alignUp(const size_t value) {
+	return (value + ARRAY_ALIGNMENT - 1) & ~(ARRAY_ALIGNMENT - 1);
+}
+
+/// <summary>
+/// Registers a new component type
+/// </summary>
+/// <param name="size">Size of the component in bytes</param>
+/// <returns>Id of the component type</returns>
+unsigned int ComponentRegistry::registerComponent(const size_t size) {
+	const auto id = componentCount.fetch_add(1);
+	if (id >= MAX_COMPONENTS) {
+		//A mask can not hold more component types
+		std::terminate();
+	}
+	componentSizes[id] = size;
+	return id;
+}
+
+/// <summary>
+/// Returns the size of a component type
+/// </summary>
+/// <param name="id">Id of the component type</param>
+/// <returns>Size in bytes</returns>
+size_t ComponentRegistry::getSize(const unsigned int id) {
+	return id < MAX_COMPONENTS ? componentSizes[id] : 0;
+}
+
+/// <summary>
+/// Constructor, lays out the arrays of a chunk so that as many entities as possible fit
+/// </summary>
+/// <param name="mask">Components of the archetype</param>
+Archetype::Archetype(const ComponentMask mask) :
+	_mask		(mask),
+	_capacity	(0) {
+	size_t bytesPerEntity = sizeof(Entity);
+	size_t componentTypes = 0;
+	for (unsigned int id = 0; id < ComponentRegistry::MAX_COMPONENTS; id++) {
+		_offsets[id] = 0;
+		if (mask & (1u << id)) {
+			bytesPerEntity += ComponentRegistry::getSize(id);
+			componentTypes++;
+		}
+	}
+
+	//Leave room for aligning every array
+	_capacity = (CHUNK_BYTES - ARRAY_ALIGNMENT * (componentTypes + 1)) / bytesPerEntity;
+
+	auto offset = alignUp(sizeof(Entity) * _capacity);
+	for (unsigned int id = 0; id < ComponentRegistry::MAX_COMPONENTS; id++) {
+		if (mask & (1u << id)) {
+			_offsets[id] = offset;
+			offset = alignUp(offset + ComponentRegistry::getSize(id) * _capacity);
+		}
+	}
+}
+
+/// <summary>
+/// Destructor
+/// </summary>
+Archetype::~Archetype() = default;
+
+/// <summary>
+/// Returns the components of this archetype
+/// </summary>
+/// <returns></returns>
+ComponentMask Archetype::getMask() const {
+	return _mask;
+}
+
+/// <summary>
+/// Returns the number of chunks
+/// </summary>
+/// <returns></returns>
+size_t Archetype::getChunkCount() const {
+	return _chunks.size();
+}
+
+/// <summary>
+/// Returns the number of entities stored in a chunk
+/// </summary>
+/// <param name="chunk">Index of the chunk</param>
+/// <returns></returns>
+size_t Archetype::getChunkSize(const size_t chunk) const {
+	return _chunks[chunk].size;
+}
+
+/// <summary>
+/// Returns the number of entities a chunk can hold
+/// </summary>
+/// <returns></returns>
+size_t Archetype::getChunkCapacity() const {
+	return _capacity;
+}
+
+/// <summary>
+/// Returns the entities stored in a chunk
+/// </summary>
+/// <param name="chunk">Index of the chunk</param>
+/// <returns></returns>
+Entity* Archetype::getEntities(const size_t chunk) const {
+	return reinterpret_cast<Entity*>(_chunks[chunk].data);
+}
+
+/// <summary>
+/// Returns the address of a component of an entity
+/// </summary>
+/// <param name="id">Id of the component type</param>
+/// <param name="chunk">Chunk of the entity</param>
+/// <param name="row">Row of the entity inside the chunk</param>
+/// <returns></returns>
+void* Archetype::getComponent(const unsigned int id, const size_t chunk, const size_t row) const {
+	return _chunks[chunk].data + _offsets[id] + ComponentRegistry::getSize(id) * row;
+}
+
+/// <summary>
+/// Reserves a row for a new entity, only the last chunk is ever partially filled
+/// </summary>
+/// <param name="entity">Entity to store</param>
+/// <param name="chunk">Receives the chunk of the entity</param>
+/// <param name="row">Receives the row of the entity</param>
+void Archetype::allocate(const Entity entity, size_t& chunk, size_t& row) {
+	if (_chunks.empty() || _chunks.back().size == _capacity) {
+		Chunk newChunk;
+		newChunk.storage.reset(new unsigned char[CHUNK_BYTES + ARRAY_ALIGNMENT]);
+
+		const auto address = reinterpret_cast<uintptr_t>(newChunk.storage.get());
+		newChunk.data = newChunk.storage.get() + (alignUp(address) - address);
+		newChunk.size = 0;
+		_chunks.push_back(std::move(newChunk));
+	}
+
+	chunk = _chunks.size() - 1;
+	row = _chunks.back().size++;
+	getEntities(chunk)[row] = entity;
+}
+
+/// <summary>
+/// Removes a row by moving the last entity of the archetype into it
+/// </summary>
+/// <param name="chunk">Chunk of the removed entity</param>
+/// <param name="row">Row of the removed entity</param>
+/// <returns>The entity that was moved into the row or INVALID_ENTITY if none was moved</returns>
+Entity Archetype::remove(const size_t chunk, const size_t row) {
+	const auto lastChunk = _chunks.size() - 1;
+	const auto lastRow = _chunks.back().size - 1;
+	auto moved = INVALID_ENTITY;
+
+	if (chunk != lastChunk || row != lastRow) {
+		moved = getEntities(lastChunk)[lastRow];
+		getEntities(chunk)[row] = moved;
+
+		for (unsigned int id = 0; id < ComponentRegistry::MAX_COMPONENTS; id++) {
+			if (_mask & (1u << id)) {
+				std::memcpy(getComponent(id, chunk, row), getComponent(id, lastChunk, lastRow), ComponentRegistry::getSize(id));
+			}
+		}
+	}
+
+	if (--_chunks.back().size == 0) {
+		_chunks.pop_back();
+	}
+	return moved;
+}
+
+/// <summary>
+/// Constructor
+/// </summary>
+/// <param name="archetype">Archetype of the chunk</param>
+/// <param name="chunk">Index of the chunk</param>
+ChunkView::ChunkView(Archetype* archetype, const size_t chunk) :
+	_archetype	(archetype),
+	_chunk		(chunk) {}
+
+/// <summary>
+/// Returns the number of entities in the chunk
+/// </summary>
+/// <returns></returns>
+size_t ChunkView::size() const {
+	return _archetype->getChunkSize(_chunk);
+}
+
+/// <summary>
+/// Returns the entities of the chunk
+/// </summary>
+/// <returns></returns>
+const Entity* ChunkView::entities() const {
+	return _archetype->getEntities(_chunk);
+}
+
+/// <summary>
+/// Constructor
+/// </summary>
+World::World() :
+	_entityCount	(0) {}
+
+/// <summary>
+/// Destructor
+/// </summary>
+World::~World() = default;
+
+/// <summary>
+/// Destroys an entity and its components
+/// </summary>
+/// <param name="entity">Entity to destroy</param>
+void World::destroy(const Entity entity) {
+	if (!isAlive(entity)) return;
+
+	auto& record = _records[entitySlot(entity)];
+	const auto moved = record.archetype->remove(record.chunk, record.row);
+	if (moved != INVALID_ENTITY) {
+		_records[entitySlot(moved)].chunk = record.chunk;
+		_records[entitySlot(moved)].row = record.row;
+	}
+
+	releaseSlot(entitySlot(entity));
+	_entityCount--;
+}
+
+/// <summary>
+/// Queues an entity for destruction, it stays alive until flushDestroyed is called.
+/// Must not be called from parallel jobs
+/// </summary>
+/// <param name="entity">Entity to destroy</param>
+void World::destroyLater(const Entity entity) {
+	if (!isAlive(entity)) return;
+
+	_destroyQueue.push_back(entity);
+}
+
+/// <summary>
+/// Destroys all queued entities, entities queued twice are only destroyed once
+/// </summary>
+/// <returns>Number of destroyed entities</returns>
+size_t World::flushDestroyed() {
+	const auto count = _entityCount;
+	for (auto entity : _destroyQueue) {
+		destroy(entity);
+	}
+	_destroyQueue.clear();
+	return count - _entityCount;
+}
+
+/// <summary>
+/// Destroys all entities, the archetypes are kept for reuse
+/// </summary>
+void World::clear() {
+	for (auto& archetype : _archetypes) {
+		while (archetype->getChunkCount() > 0) {
+			archetype->remove(archetype->getChunkCount() - 1, archetype->getChunkSize(archetype->getChunkCount() - 1) - 1);
+		}
+	}
+
+	//Keep the slots, handles of the cleared entities must not become alive again
+	_freeSlots.clear();
+	for (uint32_t slot = 0; slot < _records.size(); slot++) {
+		if (_records[slot].archetype != nullptr) {
+			releaseSlot(slot);
+		} else if (_records[slot].generation < MAX_GENERATION) {
+			_freeSlots.push_back(slot);
+		}
+	}
+	_destroyQueue.clear();
+	_entityCount = 0;
+}
+
+/// <summary>
+/// Returns true if the entity exists
+/// </summary>
+/// <param name="entity">Entity to check</param>
+/// <returns></returns>
+bool World::isAlive(const Entity entity) const {
+	const auto slot = entitySlot(entity);
+	return slot < _records.size() &&
+		_records[slot].archetype != nullptr &&
+		_records[slot].generation == entityGeneration(entity);
+}
+
+/// <summary>
+/// Returns the number of existing entities
+/// </summary>
+/// <returns></returns>
+size_t World::getEntityCount() const {
+	return _entityCount;
+}
+
+/// <summary>
+/// Returns the archetype with exactly the given components, creating it if needed
+/// </summary>
+/// <param name="mask">Components of the archetype</param>
+/// <returns></returns>
+Archetype* World::findOrCreateArchetype(const ComponentMask mask) {
+	for (auto& archetype : _archetypes) {
+		if (archetype->getMask() == mask) {
+			return archetype.get();
+		}
+	}
+	_archetypes.emplace_back(new Archetype(mask));
+	return _archetypes.back().get();
+}
+
+/// <summary>
+/// Returns the handle for a new entity, reusing free slots first
+/// </summary>
+/// <returns></returns>
+Entity World::allocateEntity() {
+	if (!_freeSlots.empty()) {
+		const auto slot = _freeSlots.back();
+		_freeSlots.pop_back();
+		return makeEntity(slot, _records[slot].generation);
+	}
+	_records.push_back(Record{ nullptr, 0, 0, 0 });
+	return makeEntity(static_cast<uint32_t>(_records.size() - 1), 0);
+}
+
+/// <summary>
+/// Marks a slot as unused and bumps its generation.
+/// Slots whose generation ran out are never reused, so a handle can not alias a later entity
+/// </summary>
+/// <param name="slot">Slot to release</param>
+void World::releaseSlot(const uint32_t slot) {
+	auto& record = _records[slot];
+	record.archetype = nullptr;
+	record.generation++;
+
+	if (record.generation < MAX_GENERATION) {
+		_freeSlots.push_back(slot);
+	}
+}
@@ -0,0 +1,262 @@
+#ifndef ECS_HPP
+#define ECS_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// Handle of an entity: the low 32 bits are the slot, the next 16 bits the generation of the slot.
+/// Destroying an entity bumps the generation, so old handles of a reused slot are no longer alive
+/// </summary>
+typedef uint64_t Entity;
+typedef uint32_t ComponentMask;
+
+static const Entity INVALID_ENTITY = 0xFFFFFFFFFFFFFFFFull;
+static const uint32_t MAX_GENERATION = 0xFFFF;
+
+/// <summary>
+/// Returns the slot of an entity
+/// </summary>
+/// <param name="entity">Entity handle</param>
+/// <returns></returns>
+inline uint32_t entitySlot(const Entity entity) {
+	return static_cast<uint32_t>(entity & 0xFFFFFFFF);
+}
+
+/// <summary>
+/// Returns the generation of an entity
+/// </summary>
+/// <param name="entity">Entity handle</param>
+/// <returns></returns>
+inline uint32_t entityGeneration(const Entity entity) {
+	return static_cast<uint32_t>((entity >> 32) & MAX_GENERATION);
+}
+
+/// <summary>
+/// Creates the handle of an entity
+/// </summary>
+/// <param name="slot">Slot of the entity</param>
+/// <param name="generation">Generation of the slot</param>
+/// <returns></returns>
+inline Entity makeEntity(const uint32_t slot, const uint32_t generation) {
+	return (static_cast<Entity>(generation & MAX_GENERATION) << 32) | slot;
+}
+
+/// <summary>
+/// Hands out the ids of the component types, every id is one bit of a ComponentMask
+/// </summary>
+class ComponentRegistry {
+	public:
+		static const unsigned int MAX_COMPONENTS = 32;
+
+		static unsigned int registerComponent(size_t size);
+		static size_t getSize(unsigned int id);
+};
+
+/// <summary>
+/// Returns the id of a component type, components are copied as raw memory
+/// </summary>
+/// <returns></returns>
+template<class T>
+unsigned int componentId() {
+	static_assert(std::is_trivially_copyable<T>::value, "Components have to be trivially copyable");
+	static const unsigned int id = ComponentRegistry::registerComponent(sizeof(T));
+	return id;
+}
+
+/// <summary>
+/// Returns the mask containing all the given component types
+/// </summary>
+/// <returns></returns>
+template<class... T>
+ComponentMask componentMask() {
+	ComponentMask mask = 0;
+	int expand[] = { 0, (mask |= 1u << componentId<T>(), 0)... };
+	(void)expand;
+	return mask;
+}
+
+/// <summary>
+/// Table of all the entities that have exactly the same components.
+/// Entities are stored in fixed size chunks, every component has its own array per chunk
+/// </summary>
+class Archetype {
+	public:
+		static const size_t CHUNK_BYTES = 16 * 1024;
+
+		explicit Archetype(ComponentMask mask);
+		~Archetype();
+
+		ComponentMask getMask() const;
+		size_t getChunkCount() const;
+		size_t getChunkSize(size_t chunk) const;
+		size_t getChunkCapacity() const;
+
+		Entity* getEntities(size_t chunk) const;
+		void* getComponent(unsigned int id, size_t chunk, size_t row) const;
+
+		void allocate(Entity entity, size_t& chunk, size_t& row);
+		Entity remove(size_t chunk, size_t row);
+
+		template<class T>
+		T* getArray(const size_t chunk) const {
+			return reinterpret_cast<T*>(_chunks[chunk].data + _offsets[componentId<T>()]);
+		}
+
+	private:
+		struct Chunk {
+			std::unique_ptr<unsigned char[]> storage;
+			unsigned char*					 data;
+			size_t							 size;
+		};
+
+		ComponentMask	   _mask;
+		size_t			   _capacity;
+		size_t			   _offsets[ComponentRegistry::MAX_COMPONENTS];
+		std::vector<Chunk> _chunks;
+};
+
+/// <summary>
+/// One chunk of an archetype, used to split the work of systems
+/// </summary>
+class ChunkView {
+	public:
+		ChunkView(Archetype* archetype, size_t chunk);
+
+		size_t size() const;
+		const Entity* entities() const;
+
+		template<class T>
+		T* get() const {
+			return _archetype->getArray<T>(_chunk);
+		}
+
+	private:
+		Archetype* _archetype;
+		size_t	   _chunk;
+};
+
+/// <summary>
+/// Owns all entities and their components.
+/// Entities must not be created or destroyed while the world is being iterated,
+/// destroyLater queues them until flushDestroyed is called at the end of the frame instead
+/// </summary>
+class World {
+	public:
+		World();
+		~World();
+
+		template<class... T>
+		Entity create(const T&... components) {
+			auto* archetype = findOrCreateArchetype(componentMask<T...>());
+			const auto entity = allocateEntity();
+
+			auto& record = _records[entitySlot(entity)];
+			record.archetype = archetype;
+			archetype->allocate(entity, record.chunk, record.row);
+
+			int expand[] = { 0, (std::memcpy(archetype->getComponent(componentId<T>(), record.chunk, record.row), &components, sizeof(T)), 0)... };
+			(void)expand;
+
+			_entityCount++;
+			return entity;
+		}
+
+		void destroy(Entity entity);
+		void destroyLater(Entity entity);
+		size_t flushDestroyed();
+		void clear();
+
+		bool isAlive(Entity entity) const;
+		size_t getEntityCount() const;
+
+		template<class T>
+		T* get(const Entity entity) const {
+			if (!isAlive(entity)) return nullptr;
+
+			const auto& record = _records[entitySlot(entity)];
+			const auto id = componentId<T>();
+			if ((record.archetype->getMask() & (1u << id)) == 0) return nullptr;
+
+			return static_cast<T*>(record.archetype->getComponent(id, record.chunk, record.row));
+		}
+
+		template<class... T, class F>
+		void forEach(F fn) {
+			const auto mask = componentMask<T...>();
+			for (auto& archetype : _archetypes) {
+				if ((archetype->getMask() & mask) != mask) continue;
+
+				for (size_t chunk = 0; chunk < archetype->getChunkCount(); chunk++) {
+					const auto arrays = std::make_tuple(archetype->template getArray<T>(chunk)...);
+					const auto* entities = archetype->getEntities(chunk);
+					const auto size = archetype->getChunkSize(chunk);
+
+					for (size_t row = 0; row < size; row++) {
+						invoke(fn, entities[row], arrays, row, std::index_sequence_for<T...>());
+					}
+				}
+			}
+		}
+
+		template<class... T>
+		size_t count() const {
+			const auto mask = componentMask<T...>();
+			size_t entities = 0;
+			for (auto& archetype : _archetypes) {
+				if ((archetype->getMask() & mask) != mask) continue;
+
+				for (size_t chunk = 0; chunk < archetype->getChunkCount(); chunk++) {
+					entities += archetype->getChunkSize(chunk);
+				}
+			}
+			return entities;
+		}
+
+		template<class... T>
+		void collectChunks(std::vector<ChunkView>& chunks) const {
+			const auto mask = componentMask<T...>();
+			chunks.clear();
+			for (auto& archetype : _archetypes) {
+				if ((archetype->getMask() & mask) != mask) continue;
+
+				for (size_t chunk = 0; chunk < archetype->getChunkCount(); chunk++) {
+					chunks.emplace_back(archetype.get(), chunk);
+				}
+			}
+		}
+
+		World(const World&) = delete;
+		void operator = (const World&) = delete;
+
+	private:
+		struct Record {
+			Archetype* archetype;
+			size_t	   chunk;
+			size_t	   row;
+			uint32_t   generation;
+		};
+
+		std::vector<std::unique_ptr<Archetype>> _archetypes;
+		std::vector<Record>						_records;
+		std::vector<uint32_t>					_freeSlots;
+		std::vector<Entity>						_destroyQueue;
+		size_t									_entityCount;
+
+		void releaseSlot(uint32_t slot);
+
+		Archetype* findOrCreateArchetype(ComponentMask mask);
+		Entity allocateEntity();
+
+		template<class F, class Tuple, size_t... I>
+		static void invoke(F& fn, Entity entity, const Tuple& arrays, size_t row, std::index_sequence<I...>) {
+			fn(entity, std::get<I>(arrays)[row]...);
+		}
+};
+
+#endif //ECS_HPP
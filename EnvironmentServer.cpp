@@ -0,0 +1,262 @@
+#include <condition_variable>
+#include <mutex>
+#include <string>
+
+#include "EnvironmentServer.h"
+#include "JobSystem.h"
+#include "Logger.h"
+
+//Length of a step, the same as the fixed step of the game
+static const double STEP_SECONDS = 1.0 / 60.0;
+
+//How often the server checks for shutdown while no controller is stepping
+static const DWORD IDLE_TIMEOUT = 1000;
+
+/// <summary>
+/// Checks a named object that was just created, it fails if another server already uses the name
+/// so two servers never share their memory and events
+/// </summary>
+/// <param name="handle">Handle returned by the create function, checked before anything else overwrites the last error</param>
+/// <returns>HRESULT</returns>
+static HRESULT checkCreated(const HANDLE handle) {
+	if (!handle) return E_FAIL;
+
+	return GetLastError() == ERROR_ALREADY_EXISTS ? HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS) : S_OK;
+}
+
+/// <summary>
+/// Constructor
+/// </summary>
+EnvironmentServer::EnvironmentServer() :
+	_mapping		(nullptr),
+	_requestEvent	(nullptr),
+	_responseEvent	(nullptr),
+	_view			(nullptr),
+	_header			(nullptr),
+	_slots			(nullptr),
+	_frames			(nullptr) {}
+
+/// <summary>
+/// Destructor
+/// </summary>
+EnvironmentServer::~EnvironmentServer() {
+	close();
+}
+
+/// <summary>
+/// Creates the shared memory and the events and starts every instance with its own seed
+/// </summary>
+/// <param name="name">Name of the environment, controllers open it by this name</param>
+/// <param name="instanceCount">Number of games to host</param>
+/// <param name="frameSize">Width and height of the grayscale frames, 0 for no frames</param>
+/// <returns>HRESULT</returns>
+HRESULT EnvironmentServer::create(const char* name, const uint32_t instanceCount, const uint32_t frameSize) {
+	close();
+
+	if (frameSize > 0) {
+		_rasterizer.reset(new ObservationRasterizer(frameSize, frameSize));
+	}
+
+	const std::string baseName = std::string("Local\\") + name;
+	const auto framesOffset = sizeof(EnvironmentHeader) + sizeof(EnvironmentSlot) * instanceCount;
+	const auto size = framesOffset + (_rasterizer ? _rasterizer->getFrameSize() * instanceCount : 0);
+
+	_mapping = CreateFileMapping(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+		static_cast<DWORD>(static_cast<uint64_t>(size) >> 32), static_cast<DWORD>(size & 0xFFFFFFFF), baseName.c_str());
+	auto hr = checkCreated(_mapping);
+
+	if (SUCCEEDED(hr)) {
+		_view = MapViewOfFile(_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+		hr = _view ? S_OK : E_FAIL;
+	}
+	if (SUCCEEDED(hr)) {
+		//Auto reset, every signal wakes exactly one step
+		_requestEvent = CreateEvent(nullptr, FALSE, FALSE, (baseName + ".request").c_str());
+		hr = checkCreated(_requestEvent);
+	}
+	if (SUCCEEDED(hr)) {
+		_responseEvent = CreateEvent(nullptr, FALSE, FALSE, (baseName + ".response").c_str());
+		hr = checkCreated(_responseEvent);
+	}
+	if (SUCCEEDED(hr)) {
+		_header = static_cast<EnvironmentHeader*>(_view);
+		_slots = reinterpret_cast<EnvironmentSlot*>(static_cast<char*>(_view) + sizeof(EnvironmentHeader));
+
+		_header->version = ENVIRONMENT_VERSION;
+		_header->instanceCount = instanceCount;
+		_header->slotSize = sizeof(EnvironmentSlot);
+		_header->requestSequence = 0;
+		_header->responseSequence = 0;
+		_header->shutdown = 0;
+		_header->frameWidth = frameSize;
+		_header->frameHeight = frameSize;
+		_header->framesOffset = _rasterizer ? framesOffset : 0;
+		_frames = _rasterizer ? static_cast<uint8_t*>(_view) + framesOffset : nullptr;
+
+		_instances.resize(instanceCount);
+		_logics.resize(instanceCount, nullptr);
+		for (uint32_t i = 0; i < instanceCount; i++) {
+			_slots[i] = EnvironmentSlot();
+		}
+
+		//The instances are created by a worker of their node, so their memory is allocated there on first touch
+		forEachInstance([this](const uint32_t index) {
+			_instances[index].reset(new Instance());
+			resetInstance(index, index);
+		});
+		drawFrames();
+
+		//Publish the magic last, controllers wait for it
+		MemoryBarrier();
+		_header->magic = ENVIRONMENT_MAGIC;
+	} else {
+		close();
+	}
+	return hr;
+}
+
+/// <summary>
+/// Answers step requests until a controller asks for shutdown
+/// </summary>
+void EnvironmentServer::run() {
+	if (!_header) return;
+
+	while (!_header->shutdown) {
+		if (WaitForSingleObject(_requestEvent, IDLE_TIMEOUT) != WAIT_OBJECT_0) continue;
+		if (_header->shutdown) break;
+
+		step();
+
+		//The event is a full barrier, the controller sees all slots once it wakes
+		_header->responseSequence = _header->requestSequence;
+		SetEvent(_responseEvent);
+	}
+
+	LOG_INFO("Environment stopped, {} jobs were stolen across nodes", JobSystem::getInstance().getStealCount());
+}
+
+/// <summary>
+/// Releases the shared memory, the events and the instances
+/// </summary>
+void EnvironmentServer::close() {
+	if (_view) {
+		UnmapViewOfFile(_view);
+	}
+	if (_mapping) {
+		CloseHandle(_mapping);
+	}
+	if (_requestEvent) {
+		CloseHandle(_requestEvent);
+	}
+	if (_responseEvent) {
+		CloseHandle(_responseEvent);
+	}
+	_mapping = nullptr;
+	_requestEvent = nullptr;
+	_responseEvent = nullptr;
+	_view = nullptr;
+	_header = nullptr;
+	_slots = nullptr;
+	_frames = nullptr;
+	_instances.clear();
+	_logics.clear();
+	_rasterizer.reset();
+}
+
+/// <summary>
+/// Starts a new game in an instance
+/// </summary>
+/// <param name="index">Index of the instance</param>
+/// <param name="seed">Seed of the course</param>
+void EnvironmentServer::resetInstance(const uint32_t index, const uint64_t seed) {
+	auto& instance = *_instances[index];
+	instance.logic.reset(new Logic(nullptr));
+	_logics[index] = instance.logic.get();
+
+	//The instance already runs as a job, its frames must not wait for the job system
+	instance.logic->setSerial(true);
+	instance.logic->setCourseSeed(seed);
+	instance.logic->addPlayer(&instance.controller);
+	instance.logic->initialize();
+	instance.controller.setJump(false);
+
+	writeSlot(index, false);
+}
+
+/// <summary>
+/// Applies the actions of all slots and advances every running instance by one step
+/// </summary>
+void EnvironmentServer::step() {
+	forEachInstance([this](const uint32_t index) {
+		auto& slot = _slots[index];
+		if (slot.reset) {
+			slot.reset = 0;
+			resetInstance(index, slot.seed);
+			return;
+		}
+		if (slot.done) return;
+
+		auto& instance = *_instances[index];
+		instance.controller.setJump(slot.action == action_jump);
+		writeSlot(index, instance.logic->onUpdate(STEP_SECONDS));
+	});
+	drawFrames();
+}
+
+/// <summary>
+/// Runs a function for every instance on the node of the instance and sleeps until all of them are done.
+/// Instance i belongs to node i modulo the number of nodes, its jobs are local to the node and never stolen
+/// </summary>
+/// <param name="fn">Function to run with the index of the instance</param>
+void EnvironmentServer::forEachInstance(const std::function<void(uint32_t)>& fn) {
+	auto& jobs = JobSystem::getInstance();
+	if (jobs.getWorkerCount() == 0) {
+		for (uint32_t i = 0; i < _instances.size(); i++) {
+			fn(i);
+		}
+		return;
+	}
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	auto remaining = _instances.size();
+
+	for (uint32_t i = 0; i < _instances.size(); i++) {
+		jobs.submitLocal([&fn, &mutex, &condition, &remaining, i]() {
+			fn(i);
+
+			//Notified under the lock, the waiting thread cannot return before the last job let go of it
+			std::lock_guard<std::mutex> lock(mutex);
+			if (--remaining == 0) {
+				condition.notify_one();
+			}
+		}, i % jobs.getNodeCount());
+	}
+
+	std::unique_lock<std::mutex> lock(mutex);
+	condition.wait(lock, [&remaining]() { return remaining == 0; });
+}
+
+/// <summary>
+/// Draws the frames of all instances into the shared buffer in one batch
+/// </summary>
+void EnvironmentServer::drawFrames() {
+	if (!_rasterizer) return;
+
+	_rasterizer->rasterizeBatch(_logics.data(), _logics.size(), _frames);
+}
+
+/// <summary>
+/// Writes the results of an instance into its slot
+/// </summary>
+/// <param name="index">Index of the instance</param>
+/// <param name="done">True if the game of the instance ended</param>
+void EnvironmentServer::writeSlot(const uint32_t index, const bool done) {
+	auto& slot = _slots[index];
+	auto& logic = *_instances[index]->logic;
+
+	slot.frame = logic.getFrameCount();
+	slot.done = done ? 1 : 0;
+	slot.score = logic.getScore();
+	logic.writeObservation(0, slot.observation);
+}
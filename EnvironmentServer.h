@@ -0,0 +1,56 @@
+#ifndef ENVIRONMENTSERVER_HPP
+#define ENVIRONMENTSERVER_HPP
+
+#include <windows.h>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "ActionController.h"
+#include "Logic.h"
+#include "ObservationRasterizer.h"
+#include "SharedEnvironment.h"
+
+/// <summary>
+/// Hosts many independent games for controllers in other processes.
+/// Actions and observations are exchanged in place in shared memory, a step costs two event signals.
+/// The instances are spread over the NUMA nodes of the job system and stepped in parallel
+/// </summary>
+class EnvironmentServer {
+	public:
+		EnvironmentServer();
+		~EnvironmentServer();
+
+		HRESULT create(const char* name, uint32_t instanceCount, uint32_t frameSize = 0);
+		void run();
+		void close();
+
+		EnvironmentServer(const EnvironmentServer&) = delete;
+		void operator = (const EnvironmentServer&) = delete;
+
+	private:
+		struct Instance {
+			std::unique_ptr<Logic> logic;
+			ActionController	   controller;
+		};
+
+		HANDLE			   _mapping;
+		HANDLE			   _requestEvent;
+		HANDLE			   _responseEvent;
+		void*			   _view;
+		EnvironmentHeader* _header;
+		EnvironmentSlot*   _slots;
+		uint8_t*		   _frames;
+
+		std::vector<std::unique_ptr<Instance>> _instances;
+		std::vector<Logic*>					   _logics;
+		std::unique_ptr<ObservationRasterizer> _rasterizer;
+
+		void resetInstance(uint32_t index, uint64_t seed);
+		void step();
+		void forEachInstance(const std::function<void(uint32_t)>& fn);
+		void writeSlot(uint32_t index, bool done);
+		void drawFrames();
+};
+
+#endif //ENVIRONMENTSERVER_HPP
@@ -0,0 +1,446 @@
+#include <algorithm>
+#include <cmath>
+
+#include "EventSimulation.h"
+#include "Cactus.h"
+#include "Player.h"
+#include "Resolution.h"
+
+/// <summary>
+/// Constructor
+/// </summary>
+PhysicsParams::PhysicsParams() :
+	cactusSpeed		(Cactus::getSpeed()),
+	jumpVelocity	(Player::JUMP_VELOCITY),
+	gravity			(GRAVITY) {}
+
+/// <summary>
+/// Constructor
+/// </summary>
+/// <param name="source">Course to play, gets consumed by a run</param>
+/// <param name="tickSeconds">Length of a tick, the same delta the fixed step simulation uses</param>
+/// <param name="physics">Rules of the movement</param>
+EventSimulation::EventSimulation(ObstacleSource& source, const double tickSeconds, const PhysicsParams& physics) :
+	_source			(source),
+	_tickSeconds	(tickSeconds),
+	_step			(toScalar(-physics.cactusSpeed) * toScalar(tickSeconds)),
+	_gravityStep	(toScalar(physics.gravity) * toScalar(tickSeconds)),
+	_jumpVelocity	(toScalar(physics.jumpVelocity)),
+	_ground			(toScalar(HEIGHT)),
+	_playerLeft		(toScalar(Player::START_X)),
+	_playerRight	(toScalar(Player::START_X) + toScalar(Player::SIZE_X)),
+	_playerHeight	(toScalar(Player::SIZE_Y)),
+	_nextJump		(0),
+	_reactionDistance	(-1.0f),
+	_arc			(0),
+	_arcStart		(0),
+	_landTick		(NO_TICK),
+	_trajectory		(0),
+	_grounded		(false),
+	_result			() {}
+
+/// <summary>
+/// Destructor
+/// </summary>
+EventSimulation::~EventSimulation() = default;
+
+/// <summary>
+/// Sets the ticks on which the player wants to jump, like a ScriptedController
+/// </summary>
+/// <param name="jumpTicks">Ticks of the jump requests</param>
+void EventSimulation::setJumps(std::vector<uint32_t> jumpTicks) {
+	_jumpTicks = std::move(jumpTicks);
+	std::sort(_jumpTicks.begin(), _jumpTicks.end());
+	_jumpTicks.erase(std::unique(_jumpTicks.begin(), _jumpTicks.end()), _jumpTicks.end());
+}
+
+/// <summary>
+/// Lets the player jump by itself whenever it stands on the ground and the front of a cactus
+/// is at most the given distance ahead at the end of the previous tick, a negative distance turns this off.
+/// Used as the reference controller when comparing rules
+/// </summary>
+/// <param name="distance">Distance between the player and the cactus in pixels</param>
+void EventSimulation::setReactionDistance(const float distance) {
+	_reactionDistance = distance;
+}
+
+/// <summary>
+/// Runs until the player dies or the tick limit is reached.
+/// Only the ticks on which something happens are visited
+/// </summary>
+/// <param name="maxTicks">Maximum number of ticks to simulate</param>
+/// <returns>Outcome of the run</returns>
+EventSimulation::Result EventSimulation::run(const uint32_t maxTicks) {
+	_result = Result();
+	_cacti.clear();
+	_freeCacti.clear();
+	_events = decltype(_events)();
+	_jumpedTicks.clear();
+	_nextJump = 0;
+	_trajectory = 0;
+
+	//The player starts in the air and falls onto the ground
+	startArc(0, toScalar(Player::START_Y), toScalar(0.0), false);
+	push(findSpawn(0), spawn);
+	scheduleJump();
+
+	while (!_events.empty() && _events.top().tick < maxTicks) {
+		const auto event = _events.top();
+		_events.pop();
+
+		switch (event.type) {
+			case spawn: {
+				spawnDue(event.tick);
+				push(findSpawn(event.tick + 1), spawn);
+				break;
+			}
+			case jump: {
+				tryJump(event.tick);
+				scheduleJump();
+				break;
+			}
+			case react: {
+				if (event.version != _trajectory) continue;
+				tryJump(event.tick);
+				break;
+			}
+			case land: {
+				if (event.version != _trajectory) continue;
+				_grounded = true;
+				scheduleReactions(event.tick + 1);
+				break;
+			}
+			case contact: {
+				const auto& cactus = _cacti[event.index];
+				if (!cactus.alive || cactus.generation != event.generation || event.version != _trajectory) continue;
+
+				_result.died = true;
+				_result.ticks = event.tick + 1;
+				break;
+			}
+			case expire: {
+				auto& cactus = _cacti[event.index];
+				if (!cactus.alive || cactus.generation != event.generation) continue;
+
+				cactus.alive = false;
+				cactus.generation++;
+				_freeCacti.push_back(event.index);
+
+				_source.retire(1);
+				_result.passed++;
+				break;
+			}
+		}
+
+		_result.events++;
+		if (_result.died) break;
+	}
+
+	if (!_result.died) {
+		_result.ticks = maxTicks;
+	}
+	_result.survivalTime = static_cast<float>(_result.ticks * _tickSeconds);
+	_result.score = static_cast<float>(_result.ticks * _tickSeconds * 4);
+	return _result;
+}
+
+/// <summary>
+/// Returns the ticks on which the player of the last run actually jumped.
+/// Replaying them with a ScriptedController lets a fixed step run follow the same path
+/// </summary>
+/// <returns></returns>
+const std::vector<uint32_t>& EventSimulation::getJumpedTicks() const {
+	return _jumpedTicks;
+}
+
+/// <summary>
+/// Starts a new arc of the player and schedules its landing
+/// </summary>
+/// <param name="tick">First tick of the arc</param>
+/// <param name="y">Bottom of the player before the tick</param>
+/// <param name="velocity">Velocity added in the first tick</param>
+/// <param name="jump">True if the arc starts with a jump, the player does not land in that tick</param>
+void EventSimulation::startArc(const uint32_t tick, const Scalar y, const Scalar velocity, const bool jump) {
+	_arcStart = tick;
+	_grounded = false;
+	_trajectory++;
+
+	_arc = 0;
+	while (_arc < _arcs.size() && !(_arcs[_arc].y == y && _arcs[_arc].velocity == velocity && _arcs[_arc].jump == jump)) {
+		_arc++;
+	}
+	if (_arc == _arcs.size()) {
+		_arcs.push_back(Arc{ y, velocity, jump, std::vector<Scalar>(), velocity, NO_TICK, true });
+	}
+
+	_landTick = findLanding();
+	push(_landTick, land);
+}
+
+/// <summary>
+/// Adds the next tick to an arc, exactly like Player::onUpdate: the velocity is added to the bottom,
+/// the player lands once it reaches the ground, otherwise the gravity is taken from the velocity
+/// </summary>
+/// <param name="arc">Arc to extend, must not have landed</param>
+void EventSimulation::stepArc(Arc& arc) const {
+	const auto first = arc.bottoms.empty();
+	const auto y = (first ? arc.y : arc.bottoms.back()) + arc.nextVelocity;
+
+	if (y >= _ground && !(first && arc.jump)) {
+		arc.landing = static_cast<uint32_t>(arc.bottoms.size());
+		arc.bottoms.push_back(_ground);
+		return;
+	}
+	arc.bottoms.push_back(y);
+	arc.nextVelocity -= _gravityStep;
+
+	//Without a pull towards the ground the player stops falling for good
+	if (arc.nextVelocity <= toScalar(0.0) && _gravityStep >= toScalar(0.0)) {
+		arc.falling = false;
+	}
+}
+
+/// <summary>
+/// Returns the bottom of the player at the end of a tick of the current arc
+/// </summary>
+/// <param name="tick">Tick to evaluate, not before the start of the arc and before the landing</param>
+/// <returns></returns>
+Scalar EventSimulation::getArcY(const uint32_t tick) const {
+	auto& arc = _arcs[_arc];
+	const auto index = tick - _arcStart;
+	while (arc.bottoms.size() <= index) {
+		stepArc(arc);
+	}
+	return arc.bottoms[index];
+}
+
+/// <summary>
+/// Returns the bottom of the player at the end of a tick, from the landing on it stands on the ground
+/// </summary>
+/// <param name="tick">Tick to evaluate, not before the start of the current arc</param>
+/// <returns></returns>
+Scalar EventSimulation::getPlayerY(const uint32_t tick) const {
+	return tick >= _landTick ? _ground : getArcY(tick);
+}
+
+/// <summary>
+/// Returns the left edge of a cactus at the end of a tick, it moves in the tick it spawns
+/// </summary>
+/// <param name="cactus">Cactus to evaluate</param>
+/// <param name="tick">Tick to evaluate, not before the spawn</param>
+/// <returns></returns>
+Scalar EventSimulation::getCactusX(const Obstacle& cactus, const uint32_t tick) const {
+	auto& path = _paths[cactus.path];
+	const auto index = tick - cactus.spawnTick;
+	while (path.x.size() <= index) {
+		path.x.push_back((path.x.empty() ? path.spawnX : path.x.back()) + _step);
+	}
+	return path.x[index];
+}
+
+/// <summary>
+/// Returns the path of the cacti that spawn at the given x, adds it if there is none yet
+/// </summary>
+/// <param name="spawnX">Left edge of the cactus when it spawns</param>
+/// <returns>Index of the path</returns>
+uint32_t EventSimulation::findPath(const Scalar spawnX) {
+	for (uint32_t i = 0; i < _paths.size(); i++) {
+		if (_paths[i].spawnX == spawnX) return i;
+	}
+	_paths.push_back(CactusPath{ spawnX, std::vector<Scalar>() });
+	return static_cast<uint32_t>(_paths.size() - 1);
+}
+
+/// <summary>
+/// Returns the tick on which the current arc reaches the ground
+/// </summary>
+/// <returns>Tick of the landing or NO_TICK</returns>
+uint32_t EventSimulation::findLanding() const {
+	auto& arc = _arcs[_arc];
+	while (arc.landing == NO_TICK && arc.falling) {
+		stepArc(arc);
+	}
+	return arc.landing != NO_TICK ? _arcStart + arc.landing : NO_TICK;
+}
+
+/// <summary>
+/// Returns the first tick on which the left edge of a cactus fulfils a condition.
+/// The cacti only move left, so the condition has to stay true once it is reached
+/// </summary>
+/// <param name="cactus">Cactus to check</param>
+/// <param name="reached">Condition on the left edge</param>
+/// <returns>Tick or NO_TICK</returns>
+uint32_t EventSimulation::firstTickWhere(const Obstacle& cactus, const std::function<bool(Scalar left)>& reached) const {
+	if (_step >= toScalar(0.0)) return NO_TICK;
+
+	auto& path = _paths[cactus.path];
+	auto tick = cactus.spawnTick + static_cast<uint32_t>(path.x.size());
+	while (path.x.empty() || !reached(path.x.back())) {
+		getCactusX(cactus, tick++);
+	}
+
+	const auto first = std::partition_point(path.x.begin(), path.x.end(), [&reached](Scalar left) { return !reached(left); });
+	return cactus.spawnTick + static_cast<uint32_t>(first - path.x.begin());
+}
+
+/// <summary>
+/// Returns the first tick from the given one on which the player touches the cactus, with the same test as
+/// Transform2D::isColliding. Only the few ticks in which the cactus passes the player horizontally are evaluated
+/// </summary>
+/// <param name="cactus">Cactus to check</param>
+/// <param name="fromTick">First tick to consider</param>
+/// <returns>Tick of the contact or NO_TICK</returns>
+uint32_t EventSimulation::findContact(const Obstacle& cactus, const uint32_t fromTick) const {
+	const auto first = firstTickWhere(cactus, [this](Scalar left) { return !(_playerRight < left); });
+	const auto end = firstTickWhere(cactus, [this, &cactus](Scalar left) { return _playerLeft > left + cactus.width; });
+
+	for (auto tick = std::max(first, fromTick); tick < end; tick++) {
+		const auto bottom = getPlayerY(tick);
+		if (!(bottom - _playerHeight > cactus.bottom) && !(bottom < cactus.top)) {
+			return tick;
+		}
+	}
+	return NO_TICK;
+}
+
+/// <summary>
+/// Returns the first tick from the given one on which the reference controller reacts to a cactus,
+/// it sees the cactus as it was at the end of the previous tick and ignores it once it passed the player
+/// </summary>
+/// <param name="cactus">Cactus to check</param>
+/// <param name="fromTick">First tick to consider</param>
+/// <returns>Tick of the reaction or NO_TICK</returns>
+uint32_t EventSimulation::findReaction(const Obstacle& cactus, const uint32_t fromTick) const {
+	if (_reactionDistance < 0 || _step >= toScalar(0.0)) return NO_TICK;
+
+	const auto reach = _playerRight + toScalar(_reactionDistance);
+	const auto first = firstTickWhere(cactus, [reach](Scalar left) { return left <= reach; }) + 1;
+	const auto end = firstTickWhere(cactus, [this, &cactus](Scalar left) { return _playerLeft > left + cactus.width; }) + 1;
+
+	const auto tick = std::max(first, fromTick);
+	return tick < end ? tick : NO_TICK;
+}
+
+/// <summary>
+/// Returns the tick on which a cactus left the screen, with the same test as Systems::expireOffscreen
+/// </summary>
+/// <param name="cactus">Cactus to check</param>
+/// <returns></returns>
+uint32_t EventSimulation::findExpiry(const Obstacle& cactus) const {
+	return firstTickWhere(cactus, [&cactus](Scalar left) { return left + cactus.width <= toScalar(0.0); });
+}
+
+/// <summary>
+/// Returns the tick on which the next obstacle of the course spawns.
+/// The course time after tick n is (n + 1) ticks
+/// </summary>
+/// <param name="fromTick">First tick to consider</param>
+/// <returns></returns>
+uint32_t EventSimulation::findSpawn(const uint32_t fromTick) const {
+	if (_source.getLookahead() == 0) return NO_TICK;
+
+	const auto time = _source.peek(0).time;
+	auto tick = static_cast<uint32_t>(std::max(0.0, std::ceil(time / _tickSeconds) - 1));
+
+	while (tick > 0 && tick * _tickSeconds >= time) tick--;
+	while ((tick + 1) * _tickSeconds < time) tick++;
+	return std::max(tick, fromTick);
+}
+
+/// <summary>
+/// Spawns all obstacles that are due on the given tick
+/// </summary>
+/// <param name="tick">Current tick</param>
+void EventSimulation::spawnDue(const uint32_t tick) {
+	while (_source.getLookahead() > 0 && _source.peek(0).time <= (tick + 1) * _tickSeconds) {
+		const auto& record = _source.peek(0);
+		const auto size = Cactus::getSize(static_cast<Cactus::CACTUS_TYPE>(record.type));
+
+		uint32_t index;
+		if (_freeCacti.empty()) {
+			index = static_cast<uint32_t>(_cacti.size());
+			_cacti.push_back(Obstacle{ 0, 0, toScalar(0.0), toScalar(0.0), toScalar(0.0), 0, false });
+		} else {
+			index = _freeCacti.back();
+			_freeCacti.pop_back();
+		}
+
+		//The same numbers CactusFactory puts into the transform
+		auto& cactus = _cacti[index];
+		cactus.spawnTick = tick;
+		cactus.path = findPath(toScalar(record.x));
+		cactus.width = toScalar(size.width);
+		cactus.top = toScalar(record.y) - toScalar(size.height);
+		cactus.bottom = toScalar(record.y);
+		cactus.alive = true;
+
+		push(findExpiry(cactus), expire, index, cactus.generation);
+		push(findContact(cactus, tick), contact, index, cactus.generation);
+		if (_grounded) {
+			push(findReaction(cactus, tick + 1), react, index, cactus.generation);
+		}
+
+		_source.advance();
+		_result.spawned++;
+	}
+}
+
+/// <summary>
+/// Queues an event, events that never happen are dropped
+/// </summary>
+/// <param name="tick">Tick of the event</param>
+/// <param name="type">Type of the event</param>
+/// <param name="index">Cactus the event belongs to</param>
+/// <param name="generation">Generation of the cactus</param>
+void EventSimulation::push(const uint32_t tick, const EVENT type, const uint32_t index, const uint32_t generation) {
+	if (tick == NO_TICK) return;
+
+	_events.push(Event{ tick, type, index, generation, _trajectory });
+}
+
+/// <summary>
+/// Recomputes the contacts of all cacti after the player changed its arc,
+/// the events of the old arc are ignored because their version no longer matches
+/// </summary>
+/// <param name="fromTick">First tick of the new arc</param>
+void EventSimulation::scheduleContacts(const uint32_t fromTick) {
+	for (uint32_t i = 0; i < _cacti.size(); i++) {
+		if (_cacti[i].alive) {
+			push(findContact(_cacti[i], fromTick), contact, i, _cacti[i].generation);
+		}
+	}
+}
+
+/// <summary>
+/// Queues the next jump request
+/// </summary>
+void EventSimulation::scheduleJump() {
+	if (_nextJump < _jumpTicks.size()) {
+		push(_jumpTicks[_nextJump++], jump);
+	}
+}
+
+/// <summary>
+/// Queues the reactions of the reference controller to all cacti, after the player landed.
+/// Jumping changes the arc, which makes the other reactions outdated
+/// </summary>
+/// <param name="fromTick">First tick the player can jump on</param>
+void EventSimulation::scheduleReactions(const uint32_t fromTick) {
+	for (uint32_t i = 0; i < _cacti.size(); i++) {
+		if (_cacti[i].alive) {
+			push(findReaction(_cacti[i], fromTick), react, i, _cacti[i].generation);
+		}
+	}
+}
+
+/// <summary>
+/// Starts a jump, only a player standing on the ground at the start of the tick can jump
+/// </summary>
+/// <param name="tick">Tick of the jump request</param>
+void EventSimulation::tryJump(const uint32_t tick) {
+	if (_grounded) {
+		_jumpedTicks.push_back(tick);
+		startArc(tick, _ground, _jumpVelocity, true);
+		scheduleContacts(tick);
+	}
+}
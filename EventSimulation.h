@@ -0,0 +1,163 @@
+#ifndef EVENTSIMULATION_HPP
+#define EVENTSIMULATION_HPP
+
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+
+#include "ObstacleSource.h"
+#include "Scalar.h"
+
+/// <summary>
+/// Rules of the movement, the defaults are the constants the game uses
+/// </summary>
+struct PhysicsParams {
+	float cactusSpeed;
+	float jumpVelocity;
+	float gravity;
+
+	PhysicsParams();
+};
+
+/// <summary>
+/// Headless simulation of a single player that jumps from event to event instead of stepping every tick.
+/// The cacti and the player move by the same per tick steps in simulation numbers as in Logic, every path
+/// is stepped once and shared by all cacti and arcs that start alike. The tick of the next spawn, landing,
+/// contact and expiry is searched on these paths, so a run ends on the same tick as a run of Logic
+/// </summary>
+class EventSimulation {
+	public:
+		static const uint32_t NO_TICK = 0xFFFFFFFF;
+
+		/// <summary>
+		/// Outcome of a run, comparable to a fixed step run of Logic
+		/// </summary>
+		struct Result {
+			uint32_t ticks;
+			float	 survivalTime;
+			float	 score;
+			uint64_t spawned;
+			uint64_t passed;
+			uint64_t events;
+			bool	 died;
+		};
+
+		EventSimulation(ObstacleSource& source, double tickSeconds, const PhysicsParams& physics = PhysicsParams());
+		~EventSimulation();
+
+		void setJumps(std::vector<uint32_t> jumpTicks);
+		void setReactionDistance(float distance);
+		Result run(uint32_t maxTicks);
+
+		const std::vector<uint32_t>& getJumpedTicks() const;
+
+	private:
+		//Events of the same tick are handled in the order of the frame phases
+		enum EVENT {
+			spawn,
+			jump,
+			react,
+			land,
+			contact,
+			expire
+		};
+
+		struct Event {
+			uint32_t tick;
+			EVENT	 type;
+			uint32_t index;
+			uint32_t generation;
+			uint32_t version;
+
+			bool operator > (const Event& other) const {
+				return tick != other.tick ? tick > other.tick : type > other.type;
+			}
+		};
+
+		struct Obstacle {
+			uint32_t spawnTick;
+			uint32_t path;
+			Scalar	 width;
+			Scalar	 top;
+			Scalar	 bottom;
+			uint32_t generation;
+			bool	 alive;
+		};
+
+		/// <summary>
+		/// Left edge of the cacti that spawn at the same x, at the end of every tick from the spawn on
+		/// </summary>
+		struct CactusPath {
+			Scalar				spawnX;
+			std::vector<Scalar> x;
+		};
+
+		/// <summary>
+		/// Bottom of the player at the end of every tick of an arc up to the landing
+		/// </summary>
+		struct Arc {
+			Scalar				y;
+			Scalar				velocity;
+			bool				jump;
+			std::vector<Scalar> bottoms;
+			Scalar				nextVelocity;
+			uint32_t			landing;
+			bool				falling;
+		};
+
+		ObstacleSource& _source;
+		double			_tickSeconds;
+		Scalar			_step;
+		Scalar			_gravityStep;
+		Scalar			_jumpVelocity;
+		Scalar			_ground;
+		Scalar			_playerLeft;
+		Scalar			_playerRight;
+		Scalar			_playerHeight;
+
+		std::vector<uint32_t> _jumpTicks;
+		std::vector<uint32_t> _jumpedTicks;
+		size_t				  _nextJump;
+		float				  _reactionDistance;
+
+		//Current arc of the player, it stands on the ground from the landing tick on
+		uint32_t _arc;
+		uint32_t _arcStart;
+		uint32_t _landTick;
+		uint32_t _trajectory;
+		bool	 _grounded;
+
+		//Stepped on demand, the searches only read them
+		mutable std::vector<CactusPath> _paths;
+		mutable std::vector<Arc>		_arcs;
+
+		std::vector<Obstacle> _cacti;
+		std::vector<uint32_t> _freeCacti;
+
+		std::priority_queue<Event, std::vector<Event>, std::greater<Event>> _events;
+		Result _result;
+
+		void startArc(uint32_t tick, Scalar y, Scalar velocity, bool jump);
+		void stepArc(Arc& arc) const;
+		Scalar getArcY(uint32_t tick) const;
+		Scalar getPlayerY(uint32_t tick) const;
+		Scalar getCactusX(const Obstacle& cactus, uint32_t tick) const;
+		uint32_t findPath(Scalar spawnX);
+
+		uint32_t findLanding() const;
+		uint32_t findContact(const Obstacle& cactus, uint32_t fromTick) const;
+		uint32_t findExpiry(const Obstacle& cactus) const;
+		uint32_t findSpawn(uint32_t fromTick) const;
+		uint32_t findReaction(const Obstacle& cactus, uint32_t fromTick) const;
+		uint32_t firstTickWhere(const Obstacle& cactus, const std::function<bool(Scalar left)>& reached) const;
+
+		void push(uint32_t tick, EVENT type, uint32_t index = 0, uint32_t generation = 0);
+		void scheduleContacts(uint32_t fromTick);
+		void scheduleJump();
+		void scheduleReactions(uint32_t fromTick);
+		void tryJump(uint32_t tick);
+		void spawnDue(uint32_t tick);
+};
+
+#endif //EVENTSIMULATION_HPP
@@ -0,0 +1,198 @@
+#include <cstring>
+
+#include "FlightRecorder.h"
+
+//Identifies flight recordings
+static const char RECORDER_MAGIC[4] = { 'D', 'F', 'L', 'R' };
+
+//Frames per second of the game, used to size the ring
+static const uint32_t FRAMES_PER_SECOND = 60;
+
+static_assert(sizeof(FlightRecorder::Frame) == 72, "Recorded frames have to stay 72 bytes");
+
+/// <summary>
+/// Constructor
+/// </summary>
+FlightRecorder::FlightRecorder() :
+	_file		(INVALID_HANDLE_VALUE),
+	_mapping	(nullptr),
+	_view		(nullptr),
+	_header		(nullptr),
+	_frames		(nullptr),
+	_jumps		(nullptr) {}
+
+/// <summary>
+/// Destructor
+/// </summary>
+FlightRecorder::~FlightRecorder() {
+	close();
+}
+
+/// <summary>
+/// Creates the recording file and maps it into memory, an existing file gets replaced
+/// </summary>
+/// <param name="path">Path of the recording</param>
+/// <param name="seconds">How many seconds of frames the ring holds</param>
+/// <param name="seed">Seed of the course</param>
+/// <param name="flags">FLAG_ values that describe the run</param>
+/// <returns>HRESULT</returns>
+HRESULT FlightRecorder::open(const char* path, const uint32_t seconds, const uint64_t seed, const uint32_t flags) {
+	close();
+
+	const auto capacity = (seconds > 0 ? seconds : 1) * FRAMES_PER_SECOND;
+	const uint64_t size = sizeof(Header) + capacity * sizeof(Frame) + JUMP_CAPACITY * sizeof(uint32_t);
+
+	_file = CreateFile(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	auto hr = _file != INVALID_HANDLE_VALUE ? S_OK : E_FAIL;
+
+	if (SUCCEEDED(hr)) {
+		_mapping = CreateFileMapping(_file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size & 0xFFFFFFFF), nullptr);
+		hr = _mapping ? S_OK : E_FAIL;
+	}
+	if (SUCCEEDED(hr)) {
+		_view = MapViewOfFile(_mapping, FILE_MAP_WRITE, 0, 0, 0);
+		hr = _view ? S_OK : E_FAIL;
+	}
+	if (SUCCEEDED(hr)) {
+		_header = static_cast<Header*>(_view);
+		_frames = reinterpret_cast<Frame*>(static_cast<char*>(_view) + sizeof(Header));
+		_jumps = reinterpret_cast<uint32_t*>(_frames + capacity);
+
+		memcpy(_header->magic, RECORDER_MAGIC, sizeof(RECORDER_MAGIC));
+		_header->version = VERSION;
+		_header->frameSize = sizeof(Frame);
+		_header->capacity = capacity;
+		_header->jumpCapacity = JUMP_CAPACITY;
+		_header->flags = flags;
+		_header->seed = seed;
+		_header->tickSeconds = 0.0;
+		_header->frameCount = 0;
+		_header->jumpCount = 0;
+	} else {
+		close();
+	}
+	return hr;
+}
+
+/// <summary>
+/// Writes the mapped pages to disk and closes the recording
+/// </summary>
+void FlightRecorder::close() {
+	if (_view) {
+		FlushViewOfFile(_view, 0);
+		UnmapViewOfFile(_view);
+	}
+	if (_mapping) {
+		CloseHandle(_mapping);
+	}
+	if (_file != INVALID_HANDLE_VALUE) {
+		CloseHandle(_file);
+	}
+	_file = INVALID_HANDLE_VALUE;
+	_mapping = nullptr;
+	_view = nullptr;
+	_header = nullptr;
+	_frames = nullptr;
+	_jumps = nullptr;
+}
+
+/// <summary>
+/// Returns true if frames get recorded
+/// </summary>
+/// <returns></returns>
+bool FlightRecorder::isOpen() const {
+	return _header != nullptr;
+}
+
+/// <summary>
+/// Stores a frame over the oldest one. The counters are raised after the data is written,
+/// so a crash in between only loses the frame that was being written
+/// </summary>
+/// <param name="frame">State at the end of the frame</param>
+/// <param name="tickSeconds">Length of the frame</param>
+void FlightRecorder::record(const Frame& frame, const double tickSeconds) {
+	if (!_header) return;
+
+	if (_header->frameCount == 0) {
+		_header->tickSeconds = tickSeconds;
+	}
+	//Jumps past the capacity are still counted, so a reader can tell the list is incomplete
+	if (frame.jumped) {
+		if (_header->jumpCount < _header->jumpCapacity) {
+			_jumps[_header->jumpCount] = frame.frame - 1;
+		}
+		_header->jumpCount = _header->jumpCount + 1;
+	}
+
+	_frames[_header->frameCount % _header->capacity] = frame;
+	_header->frameCount = _header->frameCount + 1;
+}
+
+/// <summary>
+/// Reads a recording, also one left behind by a crashed process
+/// </summary>
+/// <param name="path">Path of the recording</param>
+/// <param name="recording">Receives the content</param>
+/// <returns>HRESULT</returns>
+HRESULT FlightRecorder::read(const char* path, Recording& recording) {
+	auto file = CreateFile(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	auto hr = file != INVALID_HANDLE_VALUE ? S_OK : E_FAIL;
+
+	LARGE_INTEGER size;
+	if (SUCCEEDED(hr)) {
+		hr = GetFileSizeEx(file, &size) && size.QuadPart >= static_cast<LONGLONG>(sizeof(Header)) ? S_OK : E_INVALIDARG;
+	}
+
+	HANDLE mapping = nullptr;
+	const void* view = nullptr;
+	if (SUCCEEDED(hr)) {
+		mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		hr = mapping ? S_OK : E_FAIL;
+	}
+	if (SUCCEEDED(hr)) {
+		view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		hr = view ? S_OK : E_FAIL;
+	}
+	if (SUCCEEDED(hr)) {
+		//Only accept recordings that hold every frame and jump the header promises
+		const auto& header = *static_cast<const Header*>(view);
+		const auto expected = sizeof(Header) + static_cast<uint64_t>(header.capacity) * sizeof(Frame) + static_cast<uint64_t>(header.jumpCapacity) * sizeof(uint32_t);
+
+		if (memcmp(header.magic, RECORDER_MAGIC, sizeof(RECORDER_MAGIC)) != 0 ||
+			header.version != VERSION ||
+			header.frameSize != sizeof(Frame) ||
+			header.capacity == 0 ||
+			static_cast<uint64_t>(size.QuadPart) < expected) {
+			hr = E_INVALIDARG;
+		}
+	}
+	if (SUCCEEDED(hr)) {
+		const auto& header = *static_cast<const Header*>(view);
+		const auto* frames = reinterpret_cast<const Frame*>(static_cast<const char*>(view) + sizeof(Header));
+		const auto* jumps = reinterpret_cast<const uint32_t*>(frames + header.capacity);
+
+		recording.header = header;
+
+		//The ring starts at the oldest frame once it wrapped around
+		const auto count = header.frameCount < header.capacity ? header.frameCount : header.capacity;
+		recording.frames.clear();
+		recording.frames.reserve(static_cast<size_t>(count));
+		for (auto i = header.frameCount - count; i < header.frameCount; i++) {
+			recording.frames.push_back(frames[i % header.capacity]);
+		}
+
+		const auto jumpCount = header.jumpCount < header.jumpCapacity ? header.jumpCount : header.jumpCapacity;
+		recording.jumps.assign(jumps, jumps + jumpCount);
+	}
+
+	if (view) {
+		UnmapViewOfFile(view);
+	}
+	if (mapping) {
+		CloseHandle(mapping);
+	}
+	if (file != INVALID_HANDLE_VALUE) {
+		CloseHandle(file);
+	}
+	return hr;
+}
@@ -0,0 +1,98 @@
+#ifndef FLIGHTRECORDER_HPP
+#define FLIGHTRECORDER_HPP
+
+#include <windows.h>
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// Keeps the last seconds of the game in a ring inside a memory mapped file.
+/// A frame is a single copy into the mapping, the system writes the pages to disk on its own,
+/// also after the process crashed. Next to the ring every jump of the run is kept,
+/// so together with the seed of the course the whole run can be replayed
+/// </summary>
+class FlightRecorder {
+	public:
+		static const uint32_t VERSION = 1;
+		static const uint32_t MAX_OBSTACLES = 6;
+		static const uint32_t JUMP_CAPACITY = 64 * 1024;
+
+		//Set in the flags if the run played a course file instead of a generated course
+		static const uint32_t FLAG_COURSE_FILE = 1;
+
+		/// <summary>
+		/// Header at the start of every recording, the frames and then the jumps follow directly
+		/// </summary>
+		struct Header {
+			char			  magic[4];
+			uint32_t		  version;
+			uint32_t		  frameSize;
+			uint32_t		  capacity;
+			uint32_t		  jumpCapacity;
+			uint32_t		  flags;
+			uint64_t		  seed;
+			double			  tickSeconds;
+			volatile uint64_t frameCount;
+			volatile uint64_t jumpCount;
+		};
+
+		/// <summary>
+		/// Obstacle as seen at the end of a frame
+		/// </summary>
+		struct Obstacle {
+			float	x;
+			uint8_t type;
+			uint8_t reserved[3];
+		};
+
+		/// <summary>
+		/// State of the first player and the leftmost obstacles at the end of a frame,
+		/// frame counts the finished frames including this one
+		/// </summary>
+		struct Frame {
+			uint32_t frame;
+			uint32_t stateHash;
+			uint16_t obstacleCount;
+			uint8_t	 jumped;
+			uint8_t	 health;
+			float	 playerY;
+			float	 playerVelocity;
+			float	 score;
+			Obstacle obstacles[MAX_OBSTACLES];
+		};
+
+		/// <summary>
+		/// Content of a recording, the frames from the oldest to the newest.
+		/// The jumps hold the index of every frame a jump started in, counted from 0 like Logic::getFrameCount
+		/// </summary>
+		struct Recording {
+			Header				  header;
+			std::vector<Frame>	  frames;
+			std::vector<uint32_t> jumps;
+		};
+
+		FlightRecorder();
+		~FlightRecorder();
+
+		HRESULT open(const char* path, uint32_t seconds, uint64_t seed, uint32_t flags);
+		void close();
+
+		bool isOpen() const;
+
+		void record(const Frame& frame, double tickSeconds);
+
+		static HRESULT read(const char* path, Recording& recording);
+
+		FlightRecorder(const FlightRecorder&) = delete;
+		void operator = (const FlightRecorder&) = delete;
+
+	private:
+		HANDLE	  _file;
+		HANDLE	  _mapping;
+		void*	  _view;
+		Header*	  _header;
+		Frame*	  _frames;
+		uint32_t* _jumps;
+};
+
+#endif //FLIGHTRECORDER_HPP
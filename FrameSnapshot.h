@@ -0,0 +1,72 @@
+#ifndef FRAMESNAPSHOT_HPP
+#define FRAMESNAPSHOT_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <d2d1.h>
+
+/// <summary>
+/// Everything the renderer needs to draw one simulated frame.
+/// Written by the simulation thread and read by the render thread once published
+/// </summary>
+struct FrameSnapshot {
+	static const uint32_t NO_SPRITE = 0xFFFFFFFF;
+
+	/// <summary>
+	/// Rectangle filled with a color or a sprite of the atlas, renderers without an atlas use the color
+	/// </summary>
+	struct Rect {
+		D2D1_RECT_F	 rect;
+		D2D1_COLOR_F color;
+		uint32_t	 sprite;
+	};
+
+	/// <summary>
+	/// Particle on screen, the color is a premultiplied pixel
+	/// </summary>
+	struct Particle {
+		float	 x;
+		float	 y;
+		uint32_t color;
+	};
+
+	std::vector<Rect> rects;
+	std::vector<Particle> particles;
+	float			  score;
+	uint32_t		  frame;
+
+	//Seconds of the course played, moves the background
+	float			  time;
+
+	//Entities inside and outside the viewport
+	uint32_t		  drawn;
+	uint32_t		  culled;
+
+	FrameSnapshot() :
+		score	(0.0f),
+		frame	(0),
+		time	(0.0f),
+		drawn	(0),
+		culled	(0) {}
+
+	/// <summary>
+	/// Removes the drawables of the previous frame, keeping the memory
+	/// </summary>
+	void clear() {
+		rects.clear();
+		particles.clear();
+	}
+
+	/// <summary>
+	/// Adds a filled rectangle
+	/// </summary>
+	/// <param name="rect">Rectangle to fill</param>
+	/// <param name="color">Fill color</param>
+	/// <param name="sprite">Sprite of the atlas drawn instead of the color, NO_SPRITE to fill</param>
+	void addRect(const D2D1_RECT_F& rect, const D2D1_COLOR_F& color, const uint32_t sprite = NO_SPRITE) {
+		rects.push_back(Rect{ rect, color, sprite });
+	}
+};
+
+#endif //FRAMESNAPSHOT_HPP
@@ -0,0 +1,268 @@
+#include <emmintrin.h>
+#include <algorithm>
+#include <cmath>
+
+#include "Framebuffer.h"
+
+/// <summary>
+/// Constructor
+/// </summary>
+/// <param name="width">Width in pixels</param>
+/// <param name="height">Height in pixels</param>
+Framebuffer::Framebuffer(const uint32_t width, const uint32_t height) :
+	_width	(0),
+	_height	(0) {
+	resize(width, height);
+}
+
+/// <summary>
+/// Destructor
+/// </summary>
+Framebuffer::~Framebuffer() = default;
+
+/// <summary>
+/// Changes the size, all pixels become transparent
+/// </summary>
+/// <param name="width">Width in pixels</param>
+/// <param name="height">Height in pixels</param>
+void Framebuffer::resize(const uint32_t width, const uint32_t height) {
+	_width = width;
+	_height = height;
+	_pixels.assign(static_cast<size_t>(width) * height, 0);
+}
+
+/// <summary>
+/// Returns the width in pixels
+/// </summary>
+/// <returns></returns>
+uint32_t Framebuffer::getWidth() const {
+	return _width;
+}
+
+/// <summary>
+/// Returns the height in pixels
+/// </summary>
+/// <returns></returns>
+uint32_t Framebuffer::getHeight() const {
+	return _height;
+}
+
+/// <summary>
+/// Returns the number of bytes of a row
+/// </summary>
+/// <returns></returns>
+uint32_t Framebuffer::getPitch() const {
+	return _width * sizeof(uint32_t);
+}
+
+/// <summary>
+/// Returns the rectangle of all pixels
+/// </summary>
+/// <returns></returns>
+D2D1_RECT_U Framebuffer::getBounds() const {
+	return D2D1::RectU(0, 0, _width, _height);
+}
+
+/// <summary>
+/// Returns the first pixel of the first row
+/// </summary>
+/// <returns></returns>
+uint32_t* Framebuffer::getPixels() {
+	return _pixels.data();
+}
+
+/// <summary>
+/// Returns the first pixel of the first row
+/// </summary>
+/// <returns></returns>
+const uint32_t* Framebuffer::getPixels() const {
+	return _pixels.data();
+}
+
+/// <summary>
+/// Returns the first pixel of a row
+/// </summary>
+/// <param name="y">Index of the row</param>
+/// <returns></returns>
+uint32_t* Framebuffer::getRow(const uint32_t y) {
+	return _pixels.data() + static_cast<size_t>(y) * _width;
+}
+
+/// <summary>
+/// Returns the first pixel of a row
+/// </summary>
+/// <param name="y">Index of the row</param>
+/// <returns></returns>
+const uint32_t* Framebuffer::getRow(const uint32_t y) const {
+	return _pixels.data() + static_cast<size_t>(y) * _width;
+}
+
+/// <summary>
+/// Sets every pixel to a color
+/// </summary>
+/// <param name="color">Premultiplied pixel value</param>
+void Framebuffer::clear(const uint32_t color) {
+	std::fill(_pixels.begin(), _pixels.end(), color);
+}
+
+/// <summary>
+/// Sets the pixels of a rectangle to a color, the parts outside the buffer are ignored
+/// </summary>
+/// <param name="rect">Rectangle in pixels, right and bottom are exclusive</param>
+/// <param name="color">Premultiplied pixel value</param>
+void Framebuffer::clearRect(const D2D1_RECT_U& rect, const uint32_t color) {
+	const auto right = std::min(rect.right, _width);
+	const auto bottom = std::min(rect.bottom, _height);
+	if (rect.left >= right) return;
+
+	for (auto y = rect.top; y < bottom; y++) {
+		auto* row = getRow(y);
+		std::fill(row + rect.left, row + right, color);
+	}
+}
+
+/// <summary>
+/// Draws a rectangle, opaque colors replace the pixels and translucent ones are blended over them
+/// </summary>
+/// <param name="rect">Rectangle in the coordinates of the game</param>
+/// <param name="color">Premultiplied pixel value</param>
+/// <param name="clip">Only these pixels are drawn to, getBounds for all of them</param>
+void Framebuffer::fillRect(const D2D1_RECT_F& rect, const uint32_t color, const D2D1_RECT_U& clip) {
+	const auto pixels = intersect(toPixelRect(rect, _width, _height), clip);
+	if ((color >> 24) == 0xFF) {
+		clearRect(pixels, color);
+		return;
+	}
+
+	for (auto y = pixels.top; y < pixels.bottom; y++) {
+		auto* row = getRow(y);
+		for (auto x = pixels.left; x < pixels.right; x++) {
+			row[x] = blendPixel(color, row[x]);
+		}
+	}
+}
+
+/// <summary>
+/// Writes the pixels into an uncompressed 32 bit BMP file, the rows are stored top down as they are
+/// </summary>
+/// <param name="path">Path of the file</param>
+/// <returns>HRESULT</returns>
+HRESULT Framebuffer::saveBitmap(const char* path) const {
+	const auto pixelBytes = static_cast<DWORD>(_pixels.size() * sizeof(uint32_t));
+
+	BITMAPINFOHEADER info = {};
+	info.biSize = sizeof(info);
+	info.biWidth = static_cast<LONG>(_width);
+	info.biHeight = -static_cast<LONG>(_height);
+	info.biPlanes = 1;
+	info.biBitCount = 32;
+	info.biCompression = BI_RGB;
+	info.biSizeImage = pixelBytes;
+
+	BITMAPFILEHEADER header = {};
+	header.bfType = 0x4D42;
+	header.bfOffBits = sizeof(header) + sizeof(info);
+	header.bfSize = header.bfOffBits + pixelBytes;
+
+	auto file = CreateFile(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	auto hr = file != INVALID_HANDLE_VALUE ? S_OK : E_FAIL;
+
+	if (SUCCEEDED(hr)) {
+		DWORD written;
+		if (!WriteFile(file, &header, sizeof(header), &written, nullptr) || written != sizeof(header) ||
+			!WriteFile(file, &info, sizeof(info), &written, nullptr) || written != sizeof(info) ||
+			!WriteFile(file, _pixels.data(), pixelBytes, &written, nullptr) || written != pixelBytes) {
+			hr = E_FAIL;
+		}
+	}
+
+	if (file != INVALID_HANDLE_VALUE) {
+		CloseHandle(file);
+	}
+	return hr;
+}
+
+/// <summary>
+/// Returns the pixels whose centers are inside a rectangle, clipped to a buffer
+/// </summary>
+/// <param name="rect">Rectangle in the coordinates of the game</param>
+/// <param name="width">Width of the buffer</param>
+/// <param name="height">Height of the buffer</param>
+/// <returns>Pixel rectangle, right and bottom are exclusive, empty rectangles have left >= right or top >= bottom</returns>
+D2D1_RECT_U Framebuffer::toPixelRect(const D2D1_RECT_F& rect, const uint32_t width, const uint32_t height) {
+	const auto clip = [](const float value, const uint32_t size) {
+		return static_cast<uint32_t>(std::min(static_cast<float>(size), std::max(0.0f, std::ceil(value - 0.5f))));
+	};
+	return D2D1::RectU(clip(rect.left, width), clip(rect.top, height), clip(rect.right, width), clip(rect.bottom, height));
+}
+
+/// <summary>
+/// Returns the pixels inside both rectangles
+/// </summary>
+/// <param name="a">Pixel rectangle</param>
+/// <param name="b">Pixel rectangle</param>
+/// <returns>Pixel rectangle, empty rectangles have left >= right or top >= bottom</returns>
+D2D1_RECT_U Framebuffer::intersect(const D2D1_RECT_U& a, const D2D1_RECT_U& b) {
+	return D2D1::RectU(std::max(a.left, b.left), std::max(a.top, b.top), std::min(a.right, b.right), std::min(a.bottom, b.bottom));
+}
+
+/// <summary>
+/// Draws a row of premultiplied pixels over another one.
+/// Four pixels are blended per SSE step, steps that are fully transparent are skipped and fully opaque ones copied.
+/// Gives the same pixels as blendPixel
+/// </summary>
+/// <param name="destination">Pixels below</param>
+/// <param name="source">Pixels on top</param>
+/// <param name="count">Number of pixels</param>
+void Framebuffer::blendSpan(uint32_t* destination, const uint32_t* source, const size_t count) {
+	const auto zero = _mm_setzero_si128();
+	const auto opaque = _mm_set1_epi32(0xFF);
+	const auto one = _mm_set1_epi32(256);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const auto top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+		const auto alpha = _mm_srli_epi32(top, 24);
+		const auto transparent = _mm_cmpeq_epi32(alpha, zero);
+
+		if (_mm_movemask_epi8(transparent) == 0xFFFF) continue;
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, opaque)) == 0xFFFF) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), top);
+			continue;
+		}
+
+		//Every channel of the pixel below is multiplied by 256 - alpha of the pixel on top, in 16 bit lanes
+		const auto below = _mm_loadu_si128(reinterpret_cast<const __m128i*>(destination + i));
+		const auto inverse = _mm_sub_epi32(one, alpha);
+		const auto factors = _mm_or_si128(inverse, _mm_slli_epi32(inverse, 16));
+		const auto low = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(below, zero), _mm_unpacklo_epi32(factors, factors)), 8);
+		const auto high = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(below, zero), _mm_unpackhi_epi32(factors, factors)), 8);
+		const auto blended = _mm_add_epi32(top, _mm_packus_epi16(low, high));
+
+		//Transparent pixels keep the pixel below
+		const auto result = _mm_or_si128(_mm_and_si128(transparent, below), _mm_andnot_si128(transparent, blended));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), result);
+	}
+
+	for (; i < count; i++) {
+		const auto alpha = source[i] >> 24;
+		if (alpha == 0xFF) {
+			destination[i] = source[i];
+		} else if (alpha != 0) {
+			destination[i] = blendPixel(source[i], destination[i]);
+		}
+	}
+}
+
+/// <summary>
+/// Converts a Direct2D color into a premultiplied pixel value
+/// </summary>
+/// <param name="color">Color with straight alpha</param>
+/// <returns></returns>
+uint32_t Framebuffer::toPixel(const D2D1_COLOR_F& color) {
+	const auto toByte = [](const float value) {
+		return static_cast<uint32_t>(std::min(1.0f, std::max(0.0f, value)) * 255.0f + 0.5f);
+	};
+	const auto a = std::min(1.0f, std::max(0.0f, color.a));
+	return (toByte(a) << 24) | (toByte(color.r * a) << 16) | (toByte(color.g * a) << 8) | toByte(color.b * a);
+}
@@ -0,0 +1,71 @@
+#ifndef FRAMEBUFFER_HPP
+#define FRAMEBUFFER_HPP
+
+#include <windows.h>
+#include <cstdint>
+#include <vector>
+
+#include <d2d1.h>
+
+/// <summary>
+/// Pixels drawn on the CPU, row by row without padding.
+/// Every pixel is premultiplied BGRA in one 32 bit value, the layout of DXGI_FORMAT_B8G8R8A8_UNORM,
+/// so the rows can be copied into a Direct2D bitmap unchanged
+/// </summary>
+class Framebuffer {
+	public:
+		Framebuffer(uint32_t width = 0, uint32_t height = 0);
+		~Framebuffer();
+
+		void resize(uint32_t width, uint32_t height);
+
+		uint32_t getWidth() const;
+		uint32_t getHeight() const;
+		uint32_t getPitch() const;
+		D2D1_RECT_U getBounds() const;
+
+		uint32_t* getPixels();
+		const uint32_t* getPixels() const;
+		uint32_t* getRow(uint32_t y);
+		const uint32_t* getRow(uint32_t y) const;
+
+		void clear(uint32_t color);
+		void clearRect(const D2D1_RECT_U& rect, uint32_t color);
+		void fillRect(const D2D1_RECT_F& rect, uint32_t color, const D2D1_RECT_U& clip);
+
+		HRESULT saveBitmap(const char* path) const;
+
+		static D2D1_RECT_U toPixelRect(const D2D1_RECT_F& rect, uint32_t width, uint32_t height);
+		static D2D1_RECT_U intersect(const D2D1_RECT_U& a, const D2D1_RECT_U& b);
+		static uint32_t toPixel(const D2D1_COLOR_F& color);
+		static void blendSpan(uint32_t* destination, const uint32_t* source, size_t count);
+
+		/// <summary>
+		/// Multiplies all four channels of a pixel by a factor from 0 to 256
+		/// </summary>
+		/// <param name="pixel">Premultiplied pixel</param>
+		/// <param name="factor">Factor, 256 keeps the pixel</param>
+		/// <returns></returns>
+		static uint32_t scalePixel(const uint32_t pixel, const uint32_t factor) {
+			const auto redBlue = ((pixel & 0x00FF00FF) * factor >> 8) & 0x00FF00FF;
+			const auto alphaGreen = (((pixel >> 8) & 0x00FF00FF) * factor) & 0xFF00FF00;
+			return redBlue | alphaGreen;
+		}
+
+		/// <summary>
+		/// Draws a premultiplied pixel over another one
+		/// </summary>
+		/// <param name="source">Pixel on top</param>
+		/// <param name="destination">Pixel below</param>
+		/// <returns></returns>
+		static uint32_t blendPixel(const uint32_t source, const uint32_t destination) {
+			return source + scalePixel(destination, 256 - (source >> 24));
+		}
+
+	private:
+		uint32_t			  _width;
+		uint32_t			  _height;
+		std::vector<uint32_t> _pixels;
+};
+
+#endif //FRAMEBUFFER_HPP
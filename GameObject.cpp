@@ -20,11 +20,11 @@ GameObj::~GameObj() = default;
 /// <summary>
 /// Checks if the collision should be handled and calls the appropriate functions
 /// </summary>
-/// <param name="collided_object">Object that this object collided with</param>
-void GameObj::onCollision(Transform2D* collided_object) {
-	if (!collided_object) return;
-	if(collisionMatrix[getLayer()][collided_object->getLayer()]) {
-		handleCollision(collided_object);
+/// <param name="collided_entity">Entity that this object collided with</param>
+/// <param name="collided_layer">Layer of the entity</param>
+void GameObj::onCollision(Entity collided_entity, LAYER collided_layer) {
+	if(canCollide(getLayer(), collided_layer)) {
+		handleCollision(collided_entity, collided_layer);
 	}
 }
 
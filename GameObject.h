@@ -3,10 +3,10 @@
 
 #include <d2d1.h>
 
+#include "Ecs.h"
+#include "FrameSnapshot.h"
 #include "Transform2d.h"
 
-class QuadTree;
-
 class GameObj : public Transform2D {
 	protected:
 		ID2D1SolidColorBrush * _brush;
@@ -14,17 +14,17 @@ class GameObj : public Transform2D {
 		float				   _speed;
 		int					   _health;
 
-		virtual void handleCollision(Transform2D* collidedObject) = 0;
+		virtual void handleCollision(Entity collidedEntity, LAYER collidedLayer) = 0;
 
 	public:
 		GameObj(float x, float y, float width, float height);
 		virtual ~GameObj();
 
 		virtual void onUpdate(double deltaTime) = 0;
-		virtual void onRender(ID2D1HwndRenderTarget* renderTarget) = 0;
+		virtual void onRender(FrameSnapshot& snapshot) const = 0;
 		virtual void initialize() = 0;
 		
-		void onCollision(Transform2D* collidedObject);
+		void onCollision(Entity collidedEntity, LAYER collidedLayer);
 		void setSpeed(float speed);
 		void setColor(D2D1::ColorF color);
 
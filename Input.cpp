@@ -6,6 +6,7 @@
 Input::Input() {
 	//Set all key states to none
 	ZeroMemory(_asciiKeys, sizeof(_asciiKeys));
+	ZeroMemory(_pressedThisTick, sizeof(_pressedThisTick));
 }
 
 /// <summary>
@@ -16,65 +17,94 @@ Input::~Input() {
 }
 
 /// <summary>
-/// Returns true if a key is pressed, false if not
+/// Returns the current time in performance counter units, the time base of the key events
+/// </summary>
+/// <returns></returns>
+int64_t Input::now() {
+	LARGE_INTEGER time;
+	QueryPerformanceCounter(&time);
+	return time.QuadPart;
+}
+
+/// <summary>
+/// Returns true if a key is down or was pressed since the last tick, false if not
 /// </summary>
 /// <param name="key">Key to check</param>
 /// <returns></returns>
-bool Input::isKeyDown(KEYS key) {
-	const auto state = _asciiKeys[static_cast<int>(key)];
-	return state >= pressed;
+bool Input::isKeyDown(KEYS key) const {
+	const auto code = static_cast<int>(key);
+	return _asciiKeys[code] >= pressed || _pressedThisTick[code];
 }
 
 /// <summary>
-/// Returns true, only if a key is held down
+/// Returns true, only if a key is held down since before the current tick
 /// </summary>
 /// <param name="key">Key to check</param>
 /// <returns></returns>
-bool Input::isKeyHeld(KEYS key) {
+bool Input::isKeyHeld(KEYS key) const {
 	const auto state = _asciiKeys[static_cast<int>(key)];
 	return state == held;
 }
 
 /// <summary>
-/// Returns the instance of this class
+/// Returns true if a key went down during the current tick, even if it was released again
 /// </summary>
+/// <param name="key">Key to check</param>
 /// <returns></returns>
-Input& Input::getInstance() {
-	static Input instance;
-	return instance;
+bool Input::wasKeyPressed(KEYS key) const {
+	return _pressedThisTick[static_cast<int>(key)];
+}
+
+/// <summary>
+/// Applies all key events up to the given time, called by the simulation once per tick.
+/// Events after the time stay queued for the following ticks
+/// </summary>
+/// <param name="timestamp">End of the tick in performance counter units</param>
+void Input::sampleUntil(const int64_t timestamp) {
+	//Keys that were down during the last tick are held now
+	for (auto code = 0; code < 256; code++) {
+		if (_asciiKeys[code] == pressed) {
+			_asciiKeys[code] = held;
+		}
+		_pressedThisTick[code] = false;
+	}
+
+	const KeyEvent* keyEvent;
+	while ((keyEvent = _events.peek()) != nullptr && keyEvent->timestamp <= timestamp) {
+		KeyEvent current;
+		_events.tryPop(current);
+
+		if (current.down) {
+			//Repeated key down messages do not press the key again
+			if (_asciiKeys[current.key] == none) {
+				_asciiKeys[current.key] = pressed;
+				_pressedThisTick[current.key] = true;
+			}
+		} else {
+			_asciiKeys[current.key] = none;
+		}
+	}
 }
 
 /// <summary>
-/// Handles the given keyboard message
+/// Handles the given keyboard message by queueing a key event, called by the message pump
 /// </summary>
 /// <param name="keyboard_message"></param>
 bool Input::tryHandleKeyboardMessage(const MSG& keyboard_message) {
 	auto wasHandled = false;
 	switch(keyboard_message.message) {
 		case WM_KEYDOWN: 
-		{
-			//Key was pressed
-			const auto c            = MapVirtualKey(keyboard_message.wParam, MAPVK_VK_TO_CHAR);
-			const auto code         = static_cast<int>(c);
-			const auto currentState = static_cast<int>(_asciiKeys[code]);
-
-			_asciiKeys[code] = currentState + 1 > static_cast<int>(held) ?
-				held : static_cast<KEY_STATE>(currentState + 1);
-			wasHandled = true;
-			break;
-		}
 		case WM_KEYUP: 
 		{
-			//Key was released
-			const auto c = MapVirtualKey(keyboard_message.wParam, MAPVK_VK_TO_CHAR);
+			//Key was pressed or released
+			const auto c    = MapVirtualKey(static_cast<UINT>(keyboard_message.wParam), MAPVK_VK_TO_CHAR);
 			const auto code = static_cast<int>(c);
 
-			_asciiKeys[code] = none;
+			//A full queue drops the event, the simulation stopped consuming
+			_events.tryPush(KeyEvent{ now(), static_cast<uint8_t>(code & 0xFF), keyboard_message.message == WM_KEYDOWN });
 			wasHandled = true;
 			break;
 		}
 	}
 	return wasHandled;
 }
-
-
@@ -2,7 +2,14 @@
 #define INPUT_HPP
 
 #include <windows.h>
+#include <cstdint>
 
+#include "SpscRing.h"
+
+/// <summary>
+/// Keyboard state of one game instance.
+/// The message pump pushes timestamped key events, the simulation applies them tick by tick
+/// </summary>
 class Input {
 	private:
 		enum KEY_STATE {
@@ -11,9 +18,18 @@ class Input {
 			held = 2
 		};
 
-		Input();
+		struct KeyEvent {
+			int64_t timestamp;
+			uint8_t key;
+			bool	down;
+		};
+
+		static const size_t EVENT_CAPACITY = 256;
 
-		KEY_STATE _asciiKeys[255]{};
+		SpscRing<KeyEvent, EVENT_CAPACITY> _events;
+
+		KEY_STATE _asciiKeys[256]{};
+		bool	  _pressedThisTick[256]{};
 
 	public:
 		enum KEYS {
@@ -174,11 +190,16 @@ class Input {
 			OEMClear = 0xFE
 		};
 
-		static Input& getInstance();
+		Input();
+
+		static int64_t now();
 
 		bool tryHandleKeyboardMessage(const MSG& keyboardMessage);
-		bool isKeyDown(KEYS key);
-		bool isKeyHeld(KEYS key);
+		void sampleUntil(int64_t timestamp);
+
+		bool isKeyDown(KEYS key) const;
+		bool isKeyHeld(KEYS key) const;
+		bool wasKeyPressed(KEYS key) const;
 
 		Input(const Input&) = delete;
 		void operator = (const Input&) = delete;
@@ -0,0 +1,323 @@
+#include "JobSystem.h"
+#include "Logger.h"
+
+//Placement of the process wide job system
+static JobSystem::PLACEMENT instancePlacement = JobSystem::unpinned;
+
+//Job system and node of the calling worker, threads that are no workers belong to the first node
+static thread_local const JobSystem* currentSystem = nullptr;
+static thread_local unsigned int currentNode = 0;
+
+/// <summary>
+/// Constructor
+/// </summary>
+JobSystem::NodeQueue::NodeQueue() :
+	localPending	(0),
+	workers			(0),
+	sleeping		(0),
+	signals			(0) {}
+
+/// <summary>
+/// Constructor
+/// </summary>
+/// <param name="workerCount">Number of worker threads to start, the calling thread is not included</param>
+/// <param name="placement">How the workers are bound to the cores</param>
+JobSystem::JobSystem(const unsigned int workerCount, const PLACEMENT placement) :
+	_pending	(0),
+	_steals		(0),
+	_sleepers	(0),
+	_stopping	(false) {
+	const auto cores = findCores(placement);
+	const auto nodeCount = cores.empty() ? 1 : cores.back().node + 1;
+	for (unsigned int i = 0; i < nodeCount; i++) {
+		_queues.emplace_back(new NodeQueue());
+	}
+
+	//The first core is left to the thread that submits the work, it helps executing it
+	for (unsigned int i = 0; i < workerCount; i++) {
+		Core core = { 0, 0, 0 };
+		if (!cores.empty()) {
+			core = cores[(i + 1) % cores.size()];
+		}
+		_queues[core.node]->workers++;
+		_workers.emplace_back(&JobSystem::workerLoop, this, core, !cores.empty());
+	}
+
+	LOG_INFO("Job system started {} workers on {} nodes", getWorkerCount(), getNodeCount());
+}
+
+/// <summary>
+/// Destructor
+/// </summary>
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_stopping = true;
+	}
+	for (auto& queue : _queues) {
+		queue->condition.notify_all();
+	}
+
+	for (auto& worker : _workers) {
+		worker.join();
+	}
+
+	LOG_INFO("Job system stopped, {} jobs were stolen across nodes", getStealCount());
+}
+
+/// <summary>
+/// Sets how the workers of the process wide job system are placed, has to be called before its first use
+/// </summary>
+/// <param name="placement">Placement of the workers</param>
+void JobSystem::setPlacement(const PLACEMENT placement) {
+	instancePlacement = placement;
+}
+
+/// <summary>
+/// Returns the process wide job system, using one worker less than there are cores
+/// because the thread waiting on the work helps executing it
+/// </summary>
+/// <returns></returns>
+JobSystem& JobSystem::getInstance() {
+	static JobSystem instance(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0, instancePlacement);
+	return instance;
+}
+
+/// <summary>
+/// Queues a job on the node of the calling thread
+/// </summary>
+/// <param name="job">Job to run</param>
+void JobSystem::submit(Job job) {
+	submit(std::move(job), getCurrentNode());
+}
+
+/// <summary>
+/// Queues a job on a node, memory the job touches first is allocated on that node
+/// </summary>
+/// <param name="job">Job to run</param>
+/// <param name="node">Index of the node, wraps around the number of nodes</param>
+void JobSystem::submit(Job job, const unsigned int node) {
+	const auto index = node % getNodeCount();
+	auto& queue = *_queues[index];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(std::move(job));
+		_pending++;
+	}
+	wake(index, false);
+}
+
+/// <summary>
+/// Queues a job that only the workers of the node run, so memory it touches first always ends up on the node.
+/// On a node without workers it becomes a normal job
+/// </summary>
+/// <param name="job">Job to run</param>
+/// <param name="node">Index of the node, wraps around the number of nodes</param>
+void JobSystem::submitLocal(Job job, const unsigned int node) {
+	const auto index = node % getNodeCount();
+	auto& queue = *_queues[index];
+	if (queue.workers == 0) {
+		submit(std::move(job), index);
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.localJobs.push_back(std::move(job));
+		queue.localPending++;
+	}
+	wake(index, true);
+}
+
+/// <summary>
+/// Runs one pending job on the calling thread, jobs of other nodes are taken if its own node has none
+/// </summary>
+/// <returns>True if a job was run, false if all queues were empty</returns>
+bool JobSystem::tryRunPending() {
+	Job job;
+	if (!tryPop(getCurrentNode(), true, job)) return false;
+
+	job();
+	return true;
+}
+
+/// <summary>
+/// Runs one pending job of the node of the calling thread
+/// </summary>
+/// <returns>True if a job was run, false if the queue of the node was empty</returns>
+bool JobSystem::tryRunLocal() {
+	Job job;
+	if (!tryPop(getCurrentNode(), false, job)) return false;
+
+	job();
+	return true;
+}
+
+/// <summary>
+/// Returns the number of worker threads
+/// </summary>
+/// <returns></returns>
+unsigned int JobSystem::getWorkerCount() const {
+	return static_cast<unsigned int>(_workers.size());
+}
+
+/// <summary>
+/// Returns the number of nodes, 1 unless the workers are placed by NUMA node
+/// </summary>
+/// <returns></returns>
+unsigned int JobSystem::getNodeCount() const {
+	return static_cast<unsigned int>(_queues.size());
+}
+
+/// <summary>
+/// Returns the node of the calling thread
+/// </summary>
+/// <returns></returns>
+unsigned int JobSystem::getCurrentNode() const {
+	return currentSystem == this ? currentNode : 0;
+}
+
+/// <summary>
+/// Returns how many jobs were run by a thread of another node than they were queued on
+/// </summary>
+/// <returns></returns>
+uint64_t JobSystem::getStealCount() const {
+	return _steals.load(std::memory_order_relaxed);
+}
+
+/// <summary>
+/// Lists the cores the workers are bound to, ordered by node
+/// </summary>
+/// <param name="placement">Placement of the workers</param>
+/// <returns>Cores to bind to, empty if the workers are not bound</returns>
+std::vector<JobSystem::Core> JobSystem::findCores(const PLACEMENT placement) {
+	std::vector<Core> cores;
+
+	if (placement == numa) {
+		ULONG highestNode = 0;
+		if (!GetNumaHighestNodeNumber(&highestNode)) return cores;
+
+		//Nodes without processors are skipped, the node indices stay dense
+		unsigned int nodeCount = 0;
+		for (ULONG node = 0; node <= highestNode; node++) {
+			GROUP_AFFINITY affinity = {};
+			if (!GetNumaNodeProcessorMaskEx(static_cast<USHORT>(node), &affinity) || affinity.Mask == 0) continue;
+
+			for (unsigned int number = 0; number < sizeof(affinity.Mask) * 8; number++) {
+				if (affinity.Mask & (static_cast<ULONG_PTR>(1) << number)) {
+					cores.push_back({ affinity.Group, static_cast<BYTE>(number), nodeCount });
+				}
+			}
+			nodeCount++;
+		}
+	} else if (placement == pinned) {
+		const auto groupCount = GetActiveProcessorGroupCount();
+		for (WORD group = 0; group < groupCount; group++) {
+			const auto count = GetActiveProcessorCount(group);
+			for (DWORD number = 0; number < count; number++) {
+				cores.push_back({ group, static_cast<BYTE>(number), 0 });
+			}
+		}
+	}
+	return cores;
+}
+
+/// <summary>
+/// Takes the oldest job of a node, or of the next node that has one
+/// </summary>
+/// <param name="node">Node to take the job from first</param>
+/// <param name="steal">True to take the jobs of other nodes if the node has none</param>
+/// <param name="job">Receives the job</param>
+/// <returns>True if a job was taken</returns>
+bool JobSystem::tryPop(const unsigned int node, const bool steal, Job& job) {
+	//Local jobs go to the workers of their node only
+	auto& local = *_queues[node % getNodeCount()];
+	if (currentSystem == this && local.localPending > 0) {
+		std::lock_guard<std::mutex> lock(local.mutex);
+		if (!local.localJobs.empty()) {
+			job = std::move(local.localJobs.front());
+			local.localJobs.pop_front();
+			local.localPending--;
+			return true;
+		}
+	}
+
+	if (_pending == 0) return false;
+
+	const auto count = steal ? getNodeCount() : 1;
+	for (unsigned int i = 0; i < count; i++) {
+		auto& queue = *_queues[(node + i) % getNodeCount()];
+
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.jobs.empty()) continue;
+
+		job = std::move(queue.jobs.front());
+		queue.jobs.pop_front();
+		_pending--;
+
+		if (i > 0) {
+			_steals.fetch_add(1, std::memory_order_relaxed);
+		}
+		return true;
+	}
+	return false;
+}
+
+/// <summary>
+/// Wakes a sleeping worker for a new job, a worker of another node only if the node of the job has none
+/// </summary>
+/// <param name="node">Node the job was queued on</param>
+/// <param name="local">True if only the workers of the node may run the job</param>
+void JobSystem::wake(const unsigned int node, const bool local) {
+	//Pairs with the check of the sleeping workers, either they see the job or it sees them
+	if (_sleepers == 0) return;
+
+	std::lock_guard<std::mutex> lock(_sleepMutex);
+	const auto count = local ? 1 : getNodeCount();
+	for (unsigned int i = 0; i < count; i++) {
+		auto& queue = *_queues[(node + i) % getNodeCount()];
+		if (queue.sleeping > queue.signals) {
+			queue.signals++;
+			queue.condition.notify_one();
+			return;
+		}
+	}
+}
+
+/// <summary>
+/// Binds the worker to its core, then waits for jobs and runs them until the job system is destroyed
+/// </summary>
+/// <param name="core">Core of the worker</param>
+/// <param name="bind">True to bind the thread to the core</param>
+void JobSystem::workerLoop(const Core core, const bool bind) {
+	if (bind) {
+		GROUP_AFFINITY affinity = {};
+		affinity.Group = core.group;
+		affinity.Mask = static_cast<ULONG_PTR>(1) << core.number;
+		SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr);
+	}
+	currentSystem = this;
+	currentNode = core.node;
+
+	auto& queue = *_queues[core.node];
+	while (true) {
+		Job job;
+		if (tryPop(core.node, true, job)) {
+			job();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		queue.sleeping++;
+		_sleepers++;
+		if (_pending == 0 && queue.localPending == 0 && !_stopping) {
+			queue.condition.wait(lock, [this, &queue]() { return _stopping || queue.signals > 0; });
+		}
+		_sleepers--;
+		queue.sleeping--;
+		if (queue.signals > 0) {
+			queue.signals--;
+		}
+
+		if (_stopping && _pending == 0 && queue.localPending == 0) return;
+	}
+}
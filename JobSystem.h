@@ -0,0 +1,92 @@
+#ifndef JOBSYSTEM_HPP
+#define JOBSYSTEM_HPP
+
+#include <windows.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// Runs jobs on a fixed set of worker threads.
+/// Every NUMA node has its own queue, a job submitted from a worker stays on the node of the worker.
+/// Workers take the jobs of their own node first and only steal from the other nodes once it is empty,
+/// local jobs are never stolen
+/// </summary>
+class JobSystem {
+	public:
+		typedef std::function<void()> Job;
+
+		enum PLACEMENT {
+			unpinned,	//Threads move freely, one queue for all
+			pinned,		//Every worker is bound to its own core, one queue for all
+			numa		//Every worker is bound to a core, the cores are grouped by node and every node has a queue
+		};
+
+		JobSystem(unsigned int workerCount, PLACEMENT placement);
+		~JobSystem();
+
+		static void setPlacement(PLACEMENT placement);
+		static JobSystem& getInstance();
+
+		void submit(Job job);
+		void submit(Job job, unsigned int node);
+		void submitLocal(Job job, unsigned int node);
+		bool tryRunPending();
+		bool tryRunLocal();
+
+		unsigned int getWorkerCount() const;
+		unsigned int getNodeCount() const;
+		unsigned int getCurrentNode() const;
+		uint64_t getStealCount() const;
+
+		JobSystem(const JobSystem&) = delete;
+		void operator = (const JobSystem&) = delete;
+
+	private:
+		/// <summary>
+		/// Logical processor a worker is bound to
+		/// </summary>
+		struct Core {
+			WORD		 group;
+			BYTE		 number;
+			unsigned int node;
+		};
+
+		/// <summary>
+		/// Jobs of one node and the workers of the node that sleep
+		/// </summary>
+		struct NodeQueue {
+			std::mutex				mutex;
+			std::deque<Job>			jobs;
+			std::deque<Job>			localJobs;
+			std::atomic<size_t>		localPending;
+			std::condition_variable condition;
+			unsigned int			workers;
+			unsigned int			sleeping;
+			unsigned int			signals;
+
+			NodeQueue();
+		};
+
+		std::vector<std::thread>				_workers;
+		std::vector<std::unique_ptr<NodeQueue>> _queues;
+		std::atomic<size_t>						_pending;
+		std::atomic<uint64_t>					_steals;
+		std::atomic<unsigned int>				_sleepers;
+		std::mutex								_sleepMutex;
+		bool									_stopping;
+
+		static std::vector<Core> findCores(PLACEMENT placement);
+
+		bool tryPop(unsigned int node, bool steal, Job& job);
+		void wake(unsigned int node, bool local);
+		void workerLoop(Core core, bool bind);
+};
+
+#endif //JOBSYSTEM_HPP
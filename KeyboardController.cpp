@@ -0,0 +1,24 @@
+#include "KeyboardController.h"
+
+/// <summary>
+/// Constructor
+/// </summary>
+/// <param name="input">Keyboard state of the game instance</param>
+/// <param name="jumpKey">Key that makes the player jump</param>
+KeyboardController::KeyboardController(const Input& input, const Input::KEYS jumpKey) :
+	_input		(input),
+	_jumpKey	(jumpKey) {}
+
+/// <summary>
+/// Destructor
+/// </summary>
+KeyboardController::~KeyboardController() = default;
+
+/// <summary>
+/// Returns true while the jump key is down, including presses shorter than a tick
+/// </summary>
+/// <param name="player">Player asking for its next action</param>
+/// <returns></returns>
+bool KeyboardController::isJumpRequested(const Player& player) {
+	return _input.isKeyDown(_jumpKey);
+}
@@ -0,0 +1,19 @@
+#ifndef KEYBOARDCONTROLLER_HPP
+#define KEYBOARDCONTROLLER_HPP
+
+#include "Controller.h"
+#include "Input.h"
+
+class KeyboardController : public Controller {
+	public:
+		explicit KeyboardController(const Input& input, Input::KEYS jumpKey = Input::Space);
+		~KeyboardController();
+
+		bool isJumpRequested(const Player& player) override;
+
+	private:
+		const Input& _input;
+		Input::KEYS	 _jumpKey;
+};
+
+#endif //KEYBOARDCONTROLLER_HPP
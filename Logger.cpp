@@ -0,0 +1,356 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <malloc.h>
+#include <new>
+
+#include "Logger.h"
+
+//How long the writer sleeps when no thread logged anything
+static const auto WRITER_INTERVAL = std::chrono::milliseconds(10);
+
+static const char* LEVEL_NAMES[] = { "debug", "info", "warning", "error" };
+
+/// <summary>
+/// Constructor
+/// </summary>
+Logger::Logger() :
+	_file		(INVALID_HANDLE_VALUE),
+	_running	(false),
+	_dropped	(0),
+	_startTime	(0),
+	_frequency	(1) {}
+
+/// <summary>
+/// Destructor
+/// </summary>
+Logger::~Logger() {
+	stop();
+}
+
+/// <summary>
+/// Returns the process wide logger
+/// </summary>
+/// <returns></returns>
+Logger& Logger::getInstance() {
+	static Logger instance;
+	return instance;
+}
+
+/// <summary>
+/// Starts the background thread, records written before are ignored
+/// </summary>
+/// <param name="path">Path of the log file, nullptr to send the lines to the debugger</param>
+/// <returns>HRESULT</returns>
+HRESULT Logger::start(const char* path) {
+	stop();
+
+	if (path) {
+		_file = CreateFile(path, GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (_file == INVALID_HANDLE_VALUE) return E_FAIL;
+	}
+
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	_frequency = frequency.QuadPart;
+	_startTime = getTime();
+	_dropped = 0;
+
+	_running = true;
+	_writer = std::thread(&Logger::writerLoop, this);
+	return S_OK;
+}
+
+/// <summary>
+/// Writes all pending records and stops the background thread
+/// </summary>
+void Logger::stop() {
+	if (_writer.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(_wakeMutex);
+			_running = false;
+		}
+		_wake.notify_one();
+		_writer.join();
+	}
+	if (_file != INVALID_HANDLE_VALUE) {
+		CloseHandle(_file);
+	}
+	_file = INVALID_HANDLE_VALUE;
+}
+
+/// <summary>
+/// Returns the number of records that were dropped because a ring was full
+/// </summary>
+/// <returns></returns>
+uint64_t Logger::getDroppedCount() const {
+	return _dropped;
+}
+
+/// <summary>
+/// Wraps an HRESULT, so it gets written as a hexadecimal code
+/// </summary>
+/// <param name="hr">Result to write</param>
+/// <returns></returns>
+Logger::Argument Logger::hresult(const HRESULT hr) {
+	Argument argument;
+	argument.type = hresult_value;
+	argument.unsignedValue = static_cast<uint32_t>(hr);
+	return argument;
+}
+
+/// <summary>
+/// Returns the time stamp of a record
+/// </summary>
+/// <returns>Performance counter ticks</returns>
+int64_t Logger::getTime() {
+	LARGE_INTEGER time;
+	QueryPerformanceCounter(&time);
+	return time.QuadPart;
+}
+
+/// <summary>
+/// Converts a signed integer
+/// </summary>
+/// <param name="value">Value to store</param>
+/// <returns></returns>
+Logger::Argument Logger::toArgument(const int value) {
+	return toArgument(static_cast<long long>(value));
+}
+
+/// <summary>
+/// Converts a signed integer
+/// </summary>
+/// <param name="value">Value to store</param>
+/// <returns></returns>
+Logger::Argument Logger::toArgument(const long value) {
+	return toArgument(static_cast<long long>(value));
+}
+
+/// <summary>
+/// Converts a signed integer
+/// </summary>
+/// <param name="value">Value to store</param>
+/// <returns></returns>
+Logger::Argument Logger::toArgument(const long long value) {
+	Argument argument;
+	argument.type = signed_value;
+	argument.signedValue = value;
+	return argument;
+}
+
+/// <summary>
+/// Converts an unsigned integer
+/// </summary>
+/// <param name="value">Value to store</param>
+/// <returns></returns>
+Logger::Argument Logger::toArgument(const unsigned value) {
+	return toArgument(static_cast<unsigned long long>(value));
+}
+
+/// <summary>
+/// Converts an unsigned integer
+/// </summary>
+/// <param name="value">Value to store</param>
+/// <returns></returns>
+Logger::Argument Logger::toArgument(const unsigned long value) {
+	return toArgument(static_cast<unsigned long long>(value));
+}
+
+/// <summary>
+/// Converts an unsigned integer
+/// </summary>
+/// <param name="value">Value to store</param>
+/// <returns></returns>
+Logger::Argument Logger::toArgument(const unsigned long long value) {
+	Argument argument;
+	argument.type = unsigned_value;
+	argument.unsignedValue = value;
+	return argument;
+}
+
+/// <summary>
+/// Converts a floating point number
+/// </summary>
+/// <param name="value">Value to store</param>
+/// <returns></returns>
+Logger::Argument Logger::toArgument(const double value) {
+	Argument argument;
+	argument.type = float_value;
+	argument.floatValue = value;
+	return argument;
+}
+
+/// <summary>
+/// Converts a string, only the pointer is stored
+/// </summary>
+/// <param name="value">String that outlives the logger</param>
+/// <returns></returns>
+Logger::Argument Logger::toArgument(const char* value) {
+	Argument argument;
+	argument.type = string_value;
+	argument.stringValue = value;
+	return argument;
+}
+
+/// <summary>
+/// Passes on an argument that has already been converted
+/// </summary>
+/// <param name="value">Argument to store</param>
+/// <returns></returns>
+Logger::Argument Logger::toArgument(const Argument& value) {
+	return value;
+}
+
+/// <summary>
+/// Appends a record to the ring of the calling thread, the ring is created on the first record of a thread
+/// </summary>
+/// <param name="record">Record to append</param>
+void Logger::push(const Record& record) {
+	thread_local Logger* owner = nullptr;
+	thread_local Ring* ring = nullptr;
+
+	if (owner != this) {
+		auto* memory = _aligned_malloc(sizeof(Ring), alignof(Ring));
+		if (!memory) return;
+
+		std::lock_guard<std::mutex> lock(_ringMutex);
+		_rings.emplace_back(new (memory) Ring());
+		ring = _rings.back().get();
+		owner = this;
+	}
+
+	if (!ring->tryPush(record)) {
+		_dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+/// <summary>
+/// Destroys a ring and frees its aligned memory
+/// </summary>
+/// <param name="ring">Ring to free</param>
+void Logger::RingDeleter::operator () (Ring* ring) const {
+	ring->~Ring();
+	_aligned_free(ring);
+}
+
+/// <summary>
+/// Formats and writes the records of all threads until the logger stops
+/// </summary>
+void Logger::writerLoop() {
+	std::vector<Record> records;
+	std::string text;
+	uint64_t reportedDrops = 0;
+
+	auto running = true;
+	while (running) {
+		{
+			std::unique_lock<std::mutex> lock(_wakeMutex);
+			_wake.wait_for(lock, WRITER_INTERVAL, [this]() { return !_running; });
+			running = _running;
+		}
+
+		//Records of different threads are only ordered by their time stamps
+		records.clear();
+		drain(records);
+		std::stable_sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+			return a.time < b.time;
+		});
+
+		text.clear();
+		for (const auto& record : records) {
+			format(record, text);
+		}
+
+		const uint64_t dropped = _dropped;
+		if (dropped != reportedDrops) {
+			char line[64];
+			snprintf(line, sizeof(line), "%llu log records dropped\n", static_cast<unsigned long long>(dropped - reportedDrops));
+			text += line;
+			reportedDrops = dropped;
+		}
+
+		if (!text.empty()) {
+			output(text);
+		}
+	}
+}
+
+/// <summary>
+/// Takes all pending records out of the rings
+/// </summary>
+/// <param name="records">Receives the records</param>
+/// <returns>Number of records taken</returns>
+size_t Logger::drain(std::vector<Record>& records) {
+	std::lock_guard<std::mutex> lock(_ringMutex);
+
+	const auto count = records.size();
+	for (auto& ring : _rings) {
+		Record record;
+		while (ring->tryPop(record)) {
+			records.push_back(record);
+		}
+	}
+	return records.size() - count;
+}
+
+/// <summary>
+/// Formats a record as one line, every {} of the format is replaced with the next argument
+/// </summary>
+/// <param name="record">Record to format</param>
+/// <param name="line">Text to append the line to</param>
+void Logger::format(const Record& record, std::string& line) const {
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), "%10.4f %-7s %5u ",
+		static_cast<double>(record.time - _startTime) / _frequency, LEVEL_NAMES[record.level], record.threadId);
+	line += buffer;
+
+	uint32_t next = 0;
+	for (auto* c = record.format; *c; c++) {
+		if (c[0] != '{' || c[1] != '}' || next >= record.argumentCount) {
+			line += *c;
+			continue;
+		}
+
+		const auto& argument = record.arguments[next++];
+		switch (argument.type) {
+			case signed_value: {
+				snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(argument.signedValue));
+				break;
+			}
+			case unsigned_value: {
+				snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(argument.unsignedValue));
+				break;
+			}
+			case float_value: {
+				snprintf(buffer, sizeof(buffer), "%g", argument.floatValue);
+				break;
+			}
+			case string_value: {
+				buffer[0] = '\0';
+				line += argument.stringValue ? argument.stringValue : "(null)";
+				break;
+			}
+			case hresult_value: {
+				snprintf(buffer, sizeof(buffer), "0x%08llX", static_cast<unsigned long long>(argument.unsignedValue));
+				break;
+			}
+		}
+		line += buffer;
+		c++;
+	}
+	line += '\n';
+}
+
+/// <summary>
+/// Writes formatted lines to the log file or the debugger
+/// </summary>
+/// <param name="text">Lines to write</param>
+void Logger::output(const std::string& text) {
+	if (_file != INVALID_HANDLE_VALUE) {
+		DWORD written;
+		WriteFile(_file, text.data(), static_cast<DWORD>(text.size()), &written, nullptr);
+	} else {
+		OutputDebugStringA(text.c_str());
+	}
+}
@@ -0,0 +1,179 @@
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include <windows.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SpscRing.h"
+
+//Records below this level are removed at compile time: 0 debug, 1 info, 2 warning, 3 error
+#ifndef DINO_LOG_LEVEL
+#define DINO_LOG_LEVEL 1
+#endif
+
+/// <summary>
+/// Structured logger that keeps formatting and I/O away from the logging threads.
+/// A call only copies the format string pointer and the typed arguments into a ring of the calling thread,
+/// a background thread merges the rings by time, replaces every {} of the format with the next argument
+/// and writes the lines. Format strings and string arguments are stored as pointers, so they have to outlive
+/// the logger, like literals and command line arguments do. Records are dropped if a ring is full
+/// </summary>
+class Logger {
+	public:
+		enum LEVEL {
+			debug,
+			info,
+			warning,
+			error
+		};
+
+		enum ARGUMENT_TYPE {
+			signed_value,
+			unsigned_value,
+			float_value,
+			string_value,
+			hresult_value
+		};
+
+		/// <summary>
+		/// Typed argument of a record
+		/// </summary>
+		struct Argument {
+			ARGUMENT_TYPE type;
+			union {
+				int64_t		signedValue;
+				uint64_t	unsignedValue;
+				double		floatValue;
+				const char* stringValue;
+			};
+		};
+
+		static const size_t MAX_ARGUMENTS = 4;
+		static const size_t RING_CAPACITY = 1024;
+
+		/// <summary>
+		/// Everything a call stores, formatted later by the background thread
+		/// </summary>
+		struct Record {
+			int64_t		time;
+			const char* format;
+			uint32_t	threadId;
+			LEVEL		level;
+			uint32_t	argumentCount;
+			Argument	arguments[MAX_ARGUMENTS];
+		};
+
+		Logger();
+		~Logger();
+
+		static Logger& getInstance();
+
+		HRESULT start(const char* path);
+		void stop();
+
+		uint64_t getDroppedCount() const;
+
+		template<class... T>
+		void write(const LEVEL level, const char* format, const T&... arguments) {
+			static_assert(sizeof...(T) <= MAX_ARGUMENTS, "Too many arguments for a log record");
+			if (!_running.load(std::memory_order_relaxed)) return;
+
+			Record record;
+			record.time = getTime();
+			record.format = format;
+			record.threadId = GetCurrentThreadId();
+			record.level = level;
+			record.argumentCount = sizeof...(T);
+
+			fill(record.arguments, arguments...);
+			push(record);
+		}
+
+		static Argument hresult(HRESULT hr);
+
+		Logger(const Logger&) = delete;
+		void operator = (const Logger&) = delete;
+
+	private:
+		typedef SpscRing<Record, RING_CAPACITY> Ring;
+
+		//The rings are aligned to cache lines, which new does not guarantee before C++17
+		struct RingDeleter {
+			void operator () (Ring* ring) const;
+		};
+
+		std::vector<std::unique_ptr<Ring, RingDeleter>> _rings;
+		std::mutex										_ringMutex;
+
+		HANDLE					_file;
+		std::thread				_writer;
+		std::atomic<bool>		_running;
+		std::atomic<uint64_t>	_dropped;
+		int64_t					_startTime;
+		int64_t					_frequency;
+
+		std::mutex				_wakeMutex;
+		std::condition_variable _wake;
+
+		static int64_t getTime();
+
+		static Argument toArgument(int value);
+		static Argument toArgument(long value);
+		static Argument toArgument(long long value);
+		static Argument toArgument(unsigned value);
+		static Argument toArgument(unsigned long value);
+		static Argument toArgument(unsigned long long value);
+		static Argument toArgument(double value);
+		static Argument toArgument(const char* value);
+		static Argument toArgument(const Argument& value);
+
+		static void fill(Argument*) {}
+
+		template<class T, class... Rest>
+		static void fill(Argument* arguments, const T& value, const Rest&... rest) {
+			*arguments = toArgument(value);
+			fill(arguments + 1, rest...);
+		}
+
+		void push(const Record& record);
+		void writerLoop();
+		size_t drain(std::vector<Record>& records);
+		void format(const Record& record, std::string& line) const;
+		void output(const std::string& text);
+};
+
+#if DINO_LOG_LEVEL <= 0
+#define LOG_DEBUG(...) Logger::getInstance().write(Logger::debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#if DINO_LOG_LEVEL <= 1
+#define LOG_INFO(...) Logger::getInstance().write(Logger::info, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if DINO_LOG_LEVEL <= 2
+#define LOG_WARNING(...) Logger::getInstance().write(Logger::warning, __VA_ARGS__)
+#else
+#define LOG_WARNING(...) ((void)0)
+#endif
+
+#if DINO_LOG_LEVEL <= 3
+#define LOG_ERROR(...) Logger::getInstance().write(Logger::error, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
+
+//Logs a failed HRESULT together with what failed
+#define LOG_IF_FAILED(hr, what) do { if (FAILED(hr)) { LOG_ERROR("{} failed with {}", what, Logger::hresult(hr)); } } while (0)
+
+#endif //LOGGER_HPP
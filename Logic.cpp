@@ -1,84 +1,207 @@
 #include <algorithm>
-#include <sstream>
-#include <iomanip>
+#include <cstdlib>
 
 #include "Logic.h"
 #include "ChromeDino.h"
+#include "Components.h"
 #include "Resolution.h"
-#include "Utils.h"
+#include "Systems.h"
 
+//Number of players updated by a single job
+static const size_t PLAYER_GRAIN_SIZE = 64;
+//Number of obstacle chunks updated by a single job
+static const size_t OBSTACLE_GRAIN_SIZE = 1;
+//Number of players tested for contacts by a single job
+static const size_t COLLIDER_GRAIN_SIZE = 32;
+//Number of particles updated by a single job
+static const size_t PARTICLE_GRAIN_SIZE = 16384;
 
 /// <summary>
 /// Constructor
 /// </summary>
 Logic::Logic(ChromeDino* game):
-	_player			    (this),
 	_quadTree		    (0.0f, 0.0f, WIDTH, HEIGHT, 0, 2, nullptr), 
 	_cactusFactory      (this),
 	_game			    (game),
-	_timeSinceSpawn		(0.0f),
-	_minSpawnSpeed		(1.0f),
-	_maxSpawnSpeed		(2.0f),
-	_points			    (0) { }
+	_courseSeed			(static_cast<uint64_t>(rand())),
+	_course				(_courseSeed, CourseParams()),
+	_source				(&_course),
+	_courseTime			(0.0),
+	_courseStart		(0.0),
+	_courseTick			(0.0),
+	_courseTicks		(0),
+	_points			    (0),
+	_frameDelta			(0.0),
+	_frameCount			(0),
+	_serial				(false),
+	_tracer				(nullptr),
+	_recorder			(nullptr) {
+	buildFrameGraph();
+}
 
 /// <summary>
 /// Destructor
 /// </summary>
-Logic::~Logic() = default;
+Logic::~Logic() {
+	cleanup(true);
+	for (auto* player : _players) {
+		delete player;
+	}
+}
 
 /// <summary>
 /// Initializes the game
 /// </summary>
 void Logic::initialize() {
-	_player.initialize();
-	_player.setPos(40, HEIGHT - 200);
+	_cactusFactory.initialize();
+}
 
-	_quadTree.addObject(&_player);
+/// <summary>
+/// Adds a new player to the world, all players face the same obstacles
+/// </summary>
+/// <param name="controller">Decides when the player jumps</param>
+/// <returns>The new player</returns>
+Player* Logic::addPlayer(Controller* controller) {
+	auto* player = new Player(this, controller, static_cast<uint32_t>(_players.size()));
+	player->initialize();
+	player->setPos(Player::START_X, Player::START_Y);
+
+	_players.push_back(player);
+	return player;
+}
 
-	_cactusFactory.initialize();
+/// <summary>
+/// Returns the player at the given index
+/// </summary>
+/// <param name="index">Index of the player</param>
+/// <returns>Player pointer or nullptr if the index is out of range</returns>
+Player* Logic::getPlayer(const size_t index) const {
+	return index < _players.size() ? _players[index] : nullptr;
 }
 
 /// <summary>
-/// Renders all the game's visuals
+/// Returns the number of players, including dead ones
 /// </summary>
-/// <param name="render_target">Target to render to</param>
-/// <param name="text_format">Format for writing texts</param>
-void Logic::onRender(ID2D1HwndRenderTarget* render_target, IDWriteTextFormat* text_format) {
-	//Render the player
-	_player.onRender(render_target);
+/// <returns></returns>
+size_t Logic::getPlayerCount() const {
+	return _players.size();
+}
 
-	//Render objects
-	for (auto& obj : _objects) {
-		obj->onRender(render_target); 
+/// <summary>
+/// Returns the number of players that are still alive
+/// </summary>
+/// <returns></returns>
+size_t Logic::getAlivePlayerCount() const {
+	size_t alive = 0;
+	for (auto* player : _players) {
+		if (!player->isDead()) {
+			alive++;
+		}
 	}
+	return alive;
+}
 
-	//Create brush
-	ID2D1SolidColorBrush* brush;
-	render_target->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::Black), &brush);
-	
+/// <summary>
+/// Writes all the game's visuals into a frame snapshot for the renderer
+/// </summary>
+/// <param name="snapshot">Snapshot to fill, its previous contents are replaced</param>
+void Logic::writeSnapshot(FrameSnapshot& snapshot) {
+	snapshot.clear();
+
+	//Render the players that are still in the game
+	for (auto* player : _players) {
+		if (!player->isDead()) {
+			player->onRender(snapshot);
+		}
+	}
 
-	//Create string to display
-	std::stringstream ss;
-	ss << "Score: ";
-	ss << std::setw(4) << std::setfill('0') << static_cast<int>(_points);
+	//Render the entities on screen
+	Systems::render(_world, _quadTree, D2D1::RectF(0.0f, 0.0f, WIDTH, HEIGHT), _visible, snapshot);
 
-	wstring widestr;
-	for (auto i = 0; static_cast<int>(i) < static_cast<int>(ss.str().length()); ++i) {
-		widestr += wchar_t(ss.str()[i]);
+	if (_particles) {
+		_particles->writeSprites(snapshot);
 	}
 
-	const auto str = widestr.c_str();
+	snapshot.score = _points;
+	snapshot.frame = _frameCount;
+	snapshot.time = static_cast<float>(_courseTime);
+}
 
-	//Render kills
-	render_target->DrawText(
-		str,
-		ss.str().length(),
-		text_format,
-		D2D1::RectF(0, 0, 150, 50),
-		brush
-	);
+/// <summary>
+/// Writes what a player sees: its own height and velocity and the nearest obstacles in front of it
+/// </summary>
+/// <param name="playerIndex">Index of the player</param>
+/// <param name="observation">Observation to fill</param>
+void Logic::writeObservation(const size_t playerIndex, Observation& observation) {
+	observation = Observation();
+
+	const auto* player = getPlayer(playerIndex);
+	if (!player) return;
+
+	observation.playerY = player->getY();
+	observation.playerVelocity = player->getYVelocity();
+
+	//Keep the nearest obstacles sorted by inserting each one at its place
+	const auto playerX = player->getX();
+	auto& count = observation.obstacleCount;
+	_world.forEach<TransformComponent, CactusComponent>([&observation, &count, playerX](Entity, TransformComponent& transform, CactusComponent&) {
+		const auto distance = toFloat(transform.x) - playerX;
+		if (distance + toFloat(transform.w) < 0) return;
+
+		auto index = count < Observation::MAX_OBSTACLES ? count : Observation::MAX_OBSTACLES;
+		while (index > 0 && observation.obstacles[index - 1].distance > distance) {
+			if (index < Observation::MAX_OBSTACLES) {
+				observation.obstacles[index] = observation.obstacles[index - 1];
+			}
+			index--;
+		}
+		if (index < Observation::MAX_OBSTACLES) {
+			observation.obstacles[index] = Observation::Obstacle{ distance, toFloat(transform.w), toFloat(transform.h), 0.0f };
+			if (count < Observation::MAX_OBSTACLES) {
+				count++;
+			}
+		}
+	});
+}
+
+/// <summary>
+/// Writes the state of the first player and the leftmost obstacles for the flight recorder,
+/// called after a frame, so the frame number is the number of finished frames
+/// </summary>
+/// <param name="frame">Receives the state of the current frame</param>
+void Logic::writeFrameRecord(FlightRecorder::Frame& frame) {
+	frame = FlightRecorder::Frame();
+	frame.frame = _frameCount;
+	frame.stateHash = static_cast<uint32_t>(getStateHash());
+	frame.score = _points;
+
+	if (const auto* player = getPlayer(0)) {
+		frame.jumped = player->hasJumped() ? 1 : 0;
+		frame.health = static_cast<uint8_t>(std::max(0, std::min(player->getHealth(), 255)));
+		frame.playerY = player->getY();
+		frame.playerVelocity = player->getYVelocity();
+	}
 
-	Utils::safeRelease(&brush);
+	//Keep the leftmost obstacles sorted by inserting each one at its place
+	uint32_t kept = 0;
+	_world.forEach<TransformComponent, CactusComponent>([&frame, &kept](Entity, TransformComponent& transform, CactusComponent& cactus) {
+		frame.obstacleCount++;
+
+		const auto x = toFloat(transform.x);
+		auto index = kept < FlightRecorder::MAX_OBSTACLES ? kept : FlightRecorder::MAX_OBSTACLES;
+		while (index > 0 && frame.obstacles[index - 1].x > x) {
+			if (index < FlightRecorder::MAX_OBSTACLES) {
+				frame.obstacles[index] = frame.obstacles[index - 1];
+			}
+			index--;
+		}
+		if (index < FlightRecorder::MAX_OBSTACLES) {
+			frame.obstacles[index] = FlightRecorder::Obstacle{ x, static_cast<uint8_t>(cactus.type), { 0, 0, 0 } };
+			if (kept < FlightRecorder::MAX_OBSTACLES) {
+				kept++;
+			}
+		}
+	});
 }
 
 /// <summary>
@@ -87,68 +210,183 @@ void Logic::onRender(ID2D1HwndRenderTarget* render_target, IDWriteTextFormat* te
 /// <param name="delta">Time since last frame in seconds</param>
 /// <returns>True if game has ended</returns>
 bool Logic::onUpdate(const double delta) {
-	onUpdateSpawn(delta);
-
-	_quadTree.update(_objects);
-	_quadTree.addObject(&_player);
+	_frameDelta = delta;
+	if (_serial) {
+		_frameGraph.executeSerial();
+	} else {
+		_frameGraph.execute(JobSystem::getInstance());
+	}
+	if (_tracer) {
+		traceFrame();
+	}
+	_frameCount++;
+	if (_recorder) {
+		FlightRecorder::Frame frame;
+		writeFrameRecord(frame);
+		_recorder->record(frame, _frameDelta);
+	}
 
-	_player.onUpdate(delta);
+	//Game ended if every player died
+	return !_players.empty() && getAlivePlayerCount() == 0;
+}
 
-	_points += delta * 4;
+/// <summary>
+/// Builds the task graph that runs the phases of a frame.
+/// Spawning and rebuilding the quadtree run alone and are shared by all players,
+/// the players and the obstacles are updated in parallel chunks, contacts are searched
+/// per player in parallel and then handled in player order so the outcome does not depend on the threads
+/// </summary>
+void Logic::buildFrameGraph() {
+	const auto spawn = _frameGraph.addTask([this]() {
+		onUpdateSpawn(_frameDelta);
+		_points += _frameDelta * 4;
+	});
+
+	const auto index = _frameGraph.addTask([this]() {
+		_quadTree.update(_world);
+		_world.collectChunks<TransformComponent, VelocityComponent, HealthComponent>(_obstacleChunks);
+		collectColliders();
+	});
+
+	const auto updatePlayers = _frameGraph.addParallelTask(
+		[this]() { return _players.size(); },
+		PLAYER_GRAIN_SIZE,
+		[this](size_t begin, size_t end) {
+			for (auto i = begin; i < end; i++) {
+				_players[i]->onUpdate(_frameDelta);
+			}
+		});
+
+	const auto updateObstacles = _frameGraph.addParallelTask(
+		[this]() { return _obstacleChunks.size(); },
+		OBSTACLE_GRAIN_SIZE,
+		[this](size_t begin, size_t end) {
+			for (auto i = begin; i < end; i++) {
+				Systems::move(_obstacleChunks[i], toScalar(_frameDelta));
+				Systems::expireOffscreen(_obstacleChunks[i]);
+			}
+		});
+
+	const auto collide = _frameGraph.addParallelTask(
+		[this]() { return _colliders.size(); },
+		COLLIDER_GRAIN_SIZE,
+		[this](size_t begin, size_t end) {
+			findContacts(begin, end);
+		});
+
+	const auto resolve = _frameGraph.addTask([this]() {
+		resolveContacts();
+	});
+
+	const auto clean = _frameGraph.addTask([this]() {
+		cleanup();
+	});
+
+	//Players emit particles while they update and collide, so the particles move after that
+	const auto updateParticles = _frameGraph.addParallelTask(
+		[this]() { return _particles ? _particles->getCount() : 0; },
+		PARTICLE_GRAIN_SIZE,
+		[this](size_t begin, size_t end) {
+			_particles->update(begin, end, static_cast<float>(_frameDelta));
+		});
+
+	const auto expireParticles = _frameGraph.addTask([this]() {
+		if (_particles) {
+			_particles->removeExpired();
+		}
+	});
+
+	_frameGraph.addDependency(spawn, index);
+	_frameGraph.addDependency(index, updatePlayers);
+	_frameGraph.addDependency(index, updateObstacles);
+	_frameGraph.addDependency(updatePlayers, collide);
+	_frameGraph.addDependency(updateObstacles, collide);
+	_frameGraph.addDependency(collide, resolve);
+	_frameGraph.addDependency(resolve, clean);
+	_frameGraph.addDependency(resolve, updateParticles);
+	_frameGraph.addDependency(updateParticles, expireParticles);
+}
 
-	//Update enemies
-	for (size_t i = 0; i < _objects.size(); i++) {
-		_objects[i]->onUpdate(delta);
+/// <summary>
+/// Collects the living players that take part in collisions.
+/// Players never collide with each other, so only they query the quadtree of obstacles
+/// </summary>
+void Logic::collectColliders() {
+	_colliders.clear();
+	for (auto* player : _players) {
+		if (!player->isDead() && player->getLayer() != Transform2D::no_collisions) {
+			_colliders.push_back(player);
+		}
 	}
 
-	checkCollisions();
-
-	if(_player.isDead()) {
-		//Player is dead, game ended
-		return true;
+	if (_contacts.size() < _colliders.size()) {
+		_contacts.resize(_colliders.size());
 	}
-
-	cleanup();
-	return false;
 }
 
+/// <summary>
+/// Searches the contacts of a range of players, each player only writes its own slot
+/// </summary>
+/// <param name="begin">First player</param>
+/// <param name="end">Player after the last one</param>
+void Logic::findContacts(const size_t begin, const size_t end) {
+	for (auto i = begin; i < end; i++) {
+		auto* collider = _colliders[i];
+		auto& contacts = _contacts[i];
+		contacts.clear();
+
+		//Only objects on layers the collider collides with are returned
+		const auto layers = Transform2D::getCollisionMask(collider->getLayer());
+		_quadTree.getObjectsAt(collider->getX(), collider->getY() - 1, layers, contacts);
+
+		//Test against the moved transform, the tree holds the bounds from before the update
+		contacts.erase(std::remove_if(contacts.begin(), contacts.end(), [this, collider](const QuadTree::Entry& near_object) {
+			const auto* transform = _world.get<TransformComponent>(near_object.entity);
+			return !transform || !collider->isColliding(getBounds(*transform));
+		}), contacts.end());
+	}
+}
 
 /// <summary>
-/// Checks for collisions and handles them
+/// Lets the players handle their contacts, obstacles ignore collisions
 /// </summary>
-void Logic::checkCollisions() {
-	//Check if the object can collide at all
-	if (_player.getLayer() != 0) {
-		auto near_objects = _quadTree.getObjectsAt(_player.getX(), _player.getY() - 1);
-		for (auto& near_object : near_objects) {
-			if (near_object != &_player && near_object->isColliding(&_player)) {
-				//Objects are colliding, so let them handle it
-				_player.onCollision(near_object);
-			}
+void Logic::resolveContacts() {
+	for (size_t i = 0; i < _colliders.size(); i++) {
+		for (auto& contact : _contacts[i]) {
+			//Objects are colliding, so let them handle it
+			_colliders[i]->onCollision(contact.entity, contact.layer);
 		}
 	}
 }
 
 /// <summary>
-/// Cleans up dead objects
+/// Cleans up dead entities
 /// </summary>
 /// <param name="end">True if game ended, false if not</param>
 void Logic::cleanup(bool end) {
 	if(end) {
-		for (auto& _object : _objects) {
-			delete _object;
-		}
+		_world.clear();
 		return;
 	}
-	//Delete dead objects
-	_objects.erase(std::remove_if(_objects.begin(), _objects.end(), [this](GameObj* obj) {
-		if(obj->isDead()) {
-			delete obj;
-			obj = nullptr;
-			return true;
-		};
-		return false;
-	}), _objects.end());
+	//Queue first, destroying moves entities inside the chunks
+	size_t leftCacti = 0;
+	_world.forEach<HealthComponent>([this, &leftCacti](Entity entity, HealthComponent& health) {
+		if (health.value <= 0) {
+			//Cacti only die when they left the screen
+			if (_world.get<CactusComponent>(entity)) {
+				leftCacti++;
+			}
+			_world.destroyLater(entity);
+		}
+	});
+
+	//Handles of the dead entities stop being alive here, at the end of the frame
+	_world.flushDestroyed();
+
+	//Their records are no longer needed by the course
+	if (leftCacti > 0) {
+		_source->retire(leftCacti);
+	}
 }
 
 /// <summary>
@@ -159,38 +397,192 @@ void Logic::cleanup(bool end) {
 /// <param name="y">y Position</param>
 /// <returns></returns>
 void Logic::createCactus(Cactus::CACTUS_TYPE type, float x, float y) {
-	const auto enemy = _cactusFactory.make_cactus(type, x, y);
-	_objects.push_back(enemy);
+	_cactusFactory.make_cactus(_world, type, x, y);
 }
 
 /// <summary>
-/// Updates the spawning process
+/// Updates the spawning process, spawns every obstacle of the course whose time has come.
+/// The course time counts ticks of one length instead of summing the deltas, so it does not drift
+/// and matches the spawn ticks of EventSimulation. A delta of another length starts a new count at the current time
 /// </summary>
 /// <param name="delta">Time since last frame</param>
-void Logic::onUpdateSpawn(const float delta) {
-	//Try to spawn new enemies
-	if (_timeSinceSpawn > 0.0f) {
-		_timeSinceSpawn -= delta;
+void Logic::onUpdateSpawn(const double delta) {
+	if (delta != _courseTick) {
+		_courseStart = _courseTime;
+		_courseTick = delta;
+		_courseTicks = 0;
 	}
+	_courseTicks++;
+	_courseTime = _courseStart + _courseTicks * _courseTick;
 
 	//Spawn enemies
-	if (_timeSinceSpawn <= 0.0f) {
-		_timeSinceSpawn =  _minSpawnSpeed + static_cast <float> (rand()) / (static_cast <float> (RAND_MAX / (_maxSpawnSpeed - _minSpawnSpeed)));
-
-		//Cacti spawn with different probabilities
-		//60% Normal
-		//20% wide
-		//20% High
-		Cactus::CACTUS_TYPE type = Cactus::CACTUS_TYPE::normal;
-		const int percent = (rand() % 99) + 1;
-		if (percent > 60 && percent <= 80) {
-			type = Cactus::CACTUS_TYPE::wide;
-		} else if(percent > 80) {
-			type = Cactus::CACTUS_TYPE::high;
+	while (_source->getLookahead() > 0 && _source->peek(0).time <= _courseTime) {
+		const auto& obstacle = _source->peek(0);
+		createCactus(static_cast<Cactus::CACTUS_TYPE>(obstacle.type), obstacle.x, obstacle.y);
+		_source->advance();
+	}
+}
+
+/// <summary>
+/// Restarts the course with the given seed, equal seeds give equal courses
+/// </summary>
+/// <param name="seed">Seed of the course</param>
+void Logic::setCourseSeed(const uint64_t seed) {
+	_courseSeed = seed;
+	_course.reset(seed);
+	_source = &_course;
+	_courseTime = 0.0;
+	_courseStart = 0.0;
+	_courseTick = 0.0;
+	_courseTicks = 0;
+}
+
+/// <summary>
+/// Returns the seed of the generated course
+/// </summary>
+/// <returns></returns>
+uint64_t Logic::getCourseSeed() const {
+	return _courseSeed;
+}
+
+/// <summary>
+/// Plays a fixed course instead of the generated one, the source has to outlive the logic
+/// </summary>
+/// <param name="source">Source of the obstacles, nullptr returns to the generated course</param>
+void Logic::setObstacleSource(ObstacleSource* source) {
+	_source = source ? source : &_course;
+	_courseTime = 0.0;
+	_courseStart = 0.0;
+	_courseTick = 0.0;
+	_courseTicks = 0;
+}
+
+/// <summary>
+/// Records the state of every frame into the tracer, the tracer has to outlive the logic
+/// </summary>
+/// <param name="tracer">Open tracer, nullptr stops recording</param>
+void Logic::setTracer(StateTracer* tracer) {
+	_tracer = tracer;
+}
+
+/// <summary>
+/// Records the end of every frame into the flight recorder, the recorder has to outlive the logic
+/// </summary>
+/// <param name="recorder">Open recorder, nullptr stops recording</param>
+void Logic::setRecorder(FlightRecorder* recorder) {
+	_recorder = recorder;
+}
+
+/// <summary>
+/// Runs the phases of a frame on the calling thread instead of the job system,
+/// for games that are stepped by jobs themselves
+/// </summary>
+/// <param name="serial">True to run the frames serially</param>
+void Logic::setSerial(const bool serial) {
+	_serial = serial;
+}
+
+/// <summary>
+/// Lets the players emit particles, only worth it when the game is drawn
+/// </summary>
+/// <param name="capacity">Maximum number of living particles</param>
+void Logic::enableParticles(const size_t capacity) {
+	_particles.reset(new ParticleSystem(capacity));
+}
+
+/// <summary>
+/// Returns the particles of the game
+/// </summary>
+/// <returns>Particle system or nullptr if particles are disabled</returns>
+ParticleSystem* Logic::getParticles() const {
+	return _particles.get();
+}
+
+/// <summary>
+/// Hands the state of the players and obstacles at the end of the frame to the tracer
+/// </summary>
+void Logic::traceFrame() {
+	_world.collectChunks<TransformComponent, CactusComponent>(_traceChunks);
+
+	size_t obstacleCount = 0;
+	for (const auto& chunk : _traceChunks) {
+		obstacleCount += chunk.size();
+	}
+
+	_tracer->beginFrame(_frameCount, static_cast<uint32_t>(_players.size()), static_cast<uint32_t>(obstacleCount));
+	for (const auto* player : _players) {
+		_tracer->addPlayer(player->getY(), player->getYVelocity(), player->getHealth());
+	}
+	for (const auto& chunk : _traceChunks) {
+		const auto* transforms = chunk.get<TransformComponent>();
+		const auto* cacti = chunk.get<CactusComponent>();
+		const auto* entities = chunk.entities();
+		for (size_t i = 0; i < chunk.size(); i++) {
+			_tracer->addObstacle(entities[i], toFloat(transforms[i].x), static_cast<uint32_t>(cacti[i].type));
 		}
+	}
+	_tracer->endFrame();
+}
 
-		createCactus(type, WIDTH, HEIGHT - 1);
+/// <summary>
+/// Returns the course, its lookahead holds the obstacles that will spawn next
+/// </summary>
+/// <returns></returns>
+const ObstacleSource& Logic::getCourse() const {
+	return *_source;
+}
+
+/// <summary>
+/// Returns the number of frames simulated so far
+/// </summary>
+/// <returns></returns>
+uint32_t Logic::getFrameCount() const {
+	return _frameCount;
+}
+
+/// <summary>
+/// Adds a value to a FNV-1a hash
+/// </summary>
+/// <param name="hash">Hash to update</param>
+/// <param name="value">Value to add</param>
+static void hashValue(uint64_t& hash, const uint32_t value) {
+	for (int i = 0; i < 4; i++) {
+		hash ^= (value >> (i * 8)) & 0xFF;
+		hash *= 1099511628211ull;
+	}
+}
+
+/// <summary>
+/// Returns a hash of the simulation state: frame, players and obstacles.
+/// With DINO_FIXED_POINT equal hashes on different machines mean bit identical runs
+/// </summary>
+/// <returns></returns>
+uint64_t Logic::getStateHash() {
+	uint64_t hash = 14695981039346656037ull;
+	hashValue(hash, _frameCount);
+
+	for (const auto* player : _players) {
+		const auto bounds = player->getBounds();
+		hashValue(hash, scalarBits(bounds.left));
+		hashValue(hash, scalarBits(bounds.bottom));
+		hashValue(hash, scalarBits(player->getYVelocityScalar()));
+		hashValue(hash, static_cast<uint32_t>(player->getHealth()));
 	}
+
+	_world.forEach<TransformComponent, CactusComponent>([&hash](Entity, TransformComponent& transform, CactusComponent& cactus) {
+		hashValue(hash, scalarBits(transform.x));
+		hashValue(hash, scalarBits(transform.y));
+		hashValue(hash, static_cast<uint32_t>(cactus.type));
+	});
+	return hash;
+}
+
+/// <summary>
+/// Returns the points collected so far
+/// </summary>
+/// <returns></returns>
+float Logic::getScore() const {
+	return _points;
 }
 
 /// <summary>
@@ -6,6 +6,15 @@
 #include "Player.h"
 #include "Quadtree.h"
 #include "CactusFactory.h"
+#include "CourseGenerator.h"
+#include "ObstacleSource.h"
+#include "Ecs.h"
+#include "FlightRecorder.h"
+#include "FrameSnapshot.h"
+#include "Observation.h"
+#include "ParticleSystem.h"
+#include "StateTracer.h"
+#include "TaskGraph.h"
 
 class ChromeDino;
 
@@ -15,28 +24,74 @@ class Logic {
 		~Logic();
 
 		void initialize();
-		void onRender(ID2D1HwndRenderTarget* renderTarget, IDWriteTextFormat* textFormat);
+		void writeSnapshot(FrameSnapshot& snapshot);
+		void writeObservation(size_t playerIndex, Observation& observation);
+		void writeFrameRecord(FlightRecorder::Frame& frame);
 
 		bool onUpdate(double delta);
 
+		Player* addPlayer(Controller* controller);
+		Player* getPlayer(size_t index) const;
+
+		size_t getPlayerCount() const;
+		size_t getAlivePlayerCount() const;
+		uint32_t getFrameCount() const;
+		float getScore() const;
+		uint64_t getStateHash();
+
+		void setCourseSeed(uint64_t seed);
+		uint64_t getCourseSeed() const;
+		void setObstacleSource(ObstacleSource* source);
+		void setTracer(StateTracer* tracer);
+		void setRecorder(FlightRecorder* recorder);
+		void setSerial(bool serial);
+		void enableParticles(size_t capacity);
+		ParticleSystem* getParticles() const;
+		const ObstacleSource& getCourse() const;
+
 		ChromeDino* getDino() const;
 
 	private:
-		Player				    _player;
+		std::vector<Player*>	_players;
 		QuadTree			    _quadTree;
-		std::vector<GameObj*>	_objects;
+		World					_world;
 		CactusFactory		    _cactusFactory;
 		ChromeDino*				_game;
 
-		float					_timeSinceSpawn;
-		float					_minSpawnSpeed;
-		float					_maxSpawnSpeed;
+		uint64_t				_courseSeed;
+		CourseGenerator			_course;
+		ObstacleSource*			_source;
+		double					_courseTime;
+		double					_courseStart;
+		double					_courseTick;
+		uint64_t				_courseTicks;
 		float				    _points;
+		double					_frameDelta;
+		uint32_t				_frameCount;
+
+		TaskGraph				_frameGraph;
+		bool					_serial;
+		std::vector<ChunkView>	_obstacleChunks;
+		std::vector<Player*>	_colliders;
+		std::vector<std::vector<QuadTree::Entry>> _contacts;
+
+		std::vector<QuadTree::Entry> _visible;
+
+		StateTracer*			_tracer;
+		std::vector<ChunkView>	_traceChunks;
+
+		FlightRecorder*			_recorder;
+
+		std::unique_ptr<ParticleSystem> _particles;
 
-		void checkCollisions();
+		void buildFrameGraph();
+		void collectColliders();
+		void findContacts(size_t begin, size_t end);
+		void resolveContacts();
 		void cleanup(bool end = false);
 		void createCactus(Cactus::CACTUS_TYPE type, float x, float y);
-		void onUpdateSpawn(const float delta);
+		void onUpdateSpawn(const double delta);
+		void traceFrame();
 };
 
 #endif //LOGIC_HPP
\ No newline at end of file
@@ -1,7 +1,399 @@
 #include <windows.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <vector>
 
 #include "ChromeDino.h"
+#include "CourseFile.h"
+#include "CourseGenerator.h"
+#include "EnvironmentServer.h"
+#include "EventSimulation.h"
+#include "FlightRecorder.h"
+#include "JobSystem.h"
+#include "Logic.h"
+#include "Logger.h"
+#include "NeuroevolutionTrainer.h"
+#include "ParameterSweep.h"
+#include "ScriptedController.h"
+#include "SoftwareRenderer.h"
+#include "SpriteAtlas.h"
+#include "StateTracer.h"
+
+//Tick of the headless simulations, the same as the fixed step of the game
+static const double HEADLESS_TICK = 1.0 / 60.0;
+
+//Reaction distances of the reference controller in --simulate --check, the range mixes early deaths with long runs
+static const float CHECK_MIN_REACTION = 40.0f;
+static const uint32_t CHECK_REACTION_STEPS = 30;
+
+//Particles of a captured run, the same as in the game
+static const size_t CAPTURE_PARTICLES = 128 * 1024;
+
+/// <summary>
+/// Sends the standard output to the console the program was started from
+/// </summary>
+static void attachConsole() {
+	if (AttachConsole(ATTACH_PARENT_PROCESS) || AllocConsole()) {
+		FILE* stream;
+		freopen_s(&stream, "CONOUT$", "w", stdout);
+	}
+}
+
+/// <summary>
+/// Parses a comma separated list of ticks
+/// </summary>
+/// <param name="list">List to parse</param>
+/// <returns></returns>
+static std::vector<uint32_t> parseTicks(const char* list) {
+	std::vector<uint32_t> ticks;
+	while (*list) {
+		char* end;
+		ticks.push_back(static_cast<uint32_t>(strtoul(list, &end, 10)));
+		if (end == list) break;
+		list = *end == ',' ? end + 1 : end;
+	}
+	return ticks;
+}
+
+/// <summary>
+/// Parses a range of the form min:max:steps or a single value
+/// </summary>
+/// <param name="text">Text to parse</param>
+/// <returns></returns>
+static SweepRange parseRange(const char* text) {
+	char* end;
+	SweepRange range(strtof(text, &end));
+	if (*end == ':') {
+		range.max = strtof(end + 1, &end);
+		range.steps = 2;
+		if (*end == ':') {
+			range.steps = std::max(1ul, strtoul(end + 1, nullptr, 10));
+		}
+	}
+	return range;
+}
+
+/// <summary>
+/// Runs a single player headless, either stepping every tick with Logic or jumping from event to event.
+/// Both modes print the same numbers for the same seed and jumps
+/// </summary>
+/// <param name="seed">Seed of the course</param>
+/// <param name="maxTicks">Maximum number of ticks</param>
+/// <param name="events">True for the event driven mode</param>
+/// <param name="jumps">Ticks on which the player wants to jump</param>
+/// <returns>Exit code</returns>
+static int runHeadless(const uint64_t seed, const uint32_t maxTicks, const bool events, const std::vector<uint32_t>& jumps) {
+	attachConsole();
+
+	uint32_t ticks = 0;
+	float survivalTime = 0.0f;
+	float score = 0.0f;
+	uint64_t hash = 0;
+
+	if (events) {
+		CourseGenerator course(seed, CourseParams());
+		EventSimulation simulation(course, HEADLESS_TICK);
+		simulation.setJumps(jumps);
+
+		const auto result = simulation.run(maxTicks);
+		ticks = result.ticks;
+		survivalTime = result.survivalTime;
+		score = result.score;
+		printf("events: %llu\n", static_cast<unsigned long long>(result.events));
+	} else {
+		Logic logic(nullptr);
+		ScriptedController controller(logic, jumps);
+		logic.setCourseSeed(seed);
+		logic.addPlayer(&controller);
+		logic.initialize();
+
+		while (logic.getFrameCount() < maxTicks && !logic.onUpdate(HEADLESS_TICK)) {}
+
+		ticks = logic.getFrameCount();
+		survivalTime = logic.getPlayer(0)->getSurvivalTime();
+		score = logic.getScore();
+		hash = logic.getStateHash();
+	}
+
+	printf("ticks: %u\nsurvival: %.3f\nscore: %.1f\n", ticks, survivalTime, score);
+	if (hash != 0) {
+		printf("state hash: %016llx\n", static_cast<unsigned long long>(hash));
+	}
+	return 0;
+}
+
+/// <summary>
+/// Checks that both headless modes agree: every seed is played by the event driven mode with the reference
+/// controller, then its jumps are replayed by Logic, which has to end on the same tick with the same outcome
+/// </summary>
+/// <param name="seed">Seed of the first course</param>
+/// <param name="maxTicks">Maximum number of ticks per run</param>
+/// <param name="runs">Number of consecutive seeds to check</param>
+/// <returns>Exit code, 1 if a run differs</returns>
+static int checkHeadless(const uint64_t seed, const uint32_t maxTicks, const uint32_t runs) {
+	attachConsole();
+
+	uint32_t mismatches = 0;
+	for (uint32_t run = 0; run < runs; run++) {
+		const auto runSeed = seed + run;
+
+		CourseGenerator course(runSeed, CourseParams());
+		EventSimulation simulation(course, HEADLESS_TICK);
+		simulation.setReactionDistance(CHECK_MIN_REACTION + static_cast<float>(runSeed % CHECK_REACTION_STEPS));
+		const auto result = simulation.run(maxTicks);
+
+		Logic logic(nullptr);
+		ScriptedController controller(logic, simulation.getJumpedTicks());
+		logic.setCourseSeed(runSeed);
+		logic.addPlayer(&controller);
+		logic.initialize();
+
+		while (logic.getFrameCount() < maxTicks && !logic.onUpdate(HEADLESS_TICK)) {}
+
+		const auto died = logic.getPlayer(0)->isDead();
+		if (logic.getFrameCount() != result.ticks || died != result.died) {
+			printf("seed %llu: events %u ticks%s, logic %u ticks%s\n", static_cast<unsigned long long>(runSeed),
+				result.ticks, result.died ? " (died)" : "", logic.getFrameCount(), died ? " (died)" : "");
+			mismatches++;
+		}
+	}
+
+	printf("%u of %u runs differ\n", mismatches, runs);
+	return mismatches == 0 ? 0 : 1;
+}
+
+/// <summary>
+/// Trains networks by evolution and stores the best one after every generation
+/// </summary>
+/// <param name="generations">Number of generations</param>
+/// <param name="params">Parameters of the training</param>
+/// <param name="path">Path of the genome file</param>
+/// <returns>Exit code</returns>
+static int runTraining(const uint32_t generations, const TrainerParams& params, const char* path) {
+	attachConsole();
+
+	NeuroevolutionTrainer trainer(params);
+	for (uint32_t i = 0; i < generations; i++) {
+		const auto result = trainer.runGeneration();
+		printf("generation %u: best %.3f mean %.3f\n", result.generation, result.bestFitness, result.meanFitness);
+
+		const auto hr = NeuralPopulation::saveGenome(path, trainer.getBest());
+		if (FAILED(hr)) {
+			LOG_ERROR("Saving the genome {} failed with {}", path, Logger::hresult(hr));
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/// <summary>
+/// Plays the games of every cell of a sweep and prints a line per cell as soon as it is done
+/// </summary>
+/// <param name="params">Parameters of the sweep</param>
+/// <returns>Exit code</returns>
+static int runSweep(const SweepParams& params) {
+	attachConsole();
+
+	ParameterSweep sweep(params);
+	printf("min_spawn,max_spawn,wide,high,cactus_speed,jump_velocity,gravity,games,deaths,mean,p10,p50,p90,p99,max\n");
+
+	for (uint64_t i = 0; i < sweep.getCellCount(); i++) {
+		const auto cell = sweep.getCell(i);
+		const auto result = sweep.runCell(i);
+		const auto& survival = result.survival;
+
+		printf("%g,%g,%g,%g,%g,%g,%g,%llu,%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+			cell.course.minSpawnSpeed, cell.course.maxSpawnSpeed, cell.course.wideChance, cell.course.highChance,
+			cell.physics.cactusSpeed, cell.physics.jumpVelocity, cell.physics.gravity,
+			static_cast<unsigned long long>(result.games), static_cast<unsigned long long>(result.deaths),
+			survival.getMean(), survival.getQuantile(0.1), survival.getQuantile(0.5),
+			survival.getQuantile(0.9), survival.getQuantile(0.99), survival.getMax());
+		fflush(stdout);
+	}
+	return 0;
+}
+
+/// <summary>
+/// Prints a flight recording and optionally replays the run to check that it ends in the recorded frames
+/// </summary>
+/// <param name="path">Path of the recording</param>
+/// <param name="replay">True to replay the run</param>
+/// <returns>Exit code</returns>
+static int decodeRecording(const char* path, const bool replay) {
+	attachConsole();
+
+	FlightRecorder::Recording recording;
+	const auto hr = FlightRecorder::read(path, recording);
+	if (FAILED(hr)) {
+		LOG_ERROR("Reading the recording {} failed with {}", path, Logger::hresult(hr));
+		return 1;
+	}
+
+	const auto& header = recording.header;
+	const auto completeJumps = header.jumpCount <= header.jumpCapacity;
+	printf("seed: %llu\ntick: %.9f\nframes: %llu\njumps: %llu\n",
+		static_cast<unsigned long long>(header.seed), header.tickSeconds,
+		static_cast<unsigned long long>(header.frameCount), static_cast<unsigned long long>(header.jumpCount));
+
+	//The jumps are the whole input of the run, the same list --simulate takes
+	printf("jump frames: ");
+	for (size_t i = 0; i < recording.jumps.size(); i++) {
+		printf(i > 0 ? ",%u" : "%u", recording.jumps[i]);
+	}
+	printf("\nframe,hash,jumped,health,player_y,player_velocity,score,obstacles,nearest\n");
+
+	for (const auto& frame : recording.frames) {
+		printf("%u,%08x,%u,%u,%.3f,%.3f,%.1f,%u,", frame.frame, frame.stateHash, frame.jumped, frame.health,
+			frame.playerY, frame.playerVelocity, frame.score, frame.obstacleCount);
+
+		const auto kept = std::min<uint32_t>(frame.obstacleCount, FlightRecorder::MAX_OBSTACLES);
+		for (uint32_t i = 0; i < kept; i++) {
+			printf(i > 0 ? " %.1f:%u" : "%.1f:%u", frame.obstacles[i].x, frame.obstacles[i].type);
+		}
+		printf("\n");
+	}
+
+	if (!replay || recording.frames.empty()) return 0;
+	if ((header.flags & FlightRecorder::FLAG_COURSE_FILE) != 0 || !completeJumps) {
+		printf("replay: not possible, the run used a course file or more jumps than were kept\n");
+		return 1;
+	}
+
+	//Play the run again with the recorded input and compare the frames that were kept
+	Logic logic(nullptr);
+	ScriptedController controller(logic, recording.jumps);
+	logic.setCourseSeed(header.seed);
+	logic.addPlayer(&controller);
+	logic.initialize();
+
+	FlightRecorder::Frame frame;
+	size_t next = 0;
+	while (next < recording.frames.size()) {
+		logic.onUpdate(header.tickSeconds);
+		if (logic.getFrameCount() < recording.frames[next].frame) continue;
+
+		logic.writeFrameRecord(frame);
+		if (frame.stateHash != recording.frames[next].stateHash) {
+			printf("replay: differs from the recording in frame %u\n", frame.frame);
+			return 1;
+		}
+		next++;
+	}
+	printf("replay: matches all %llu kept frames\n", static_cast<unsigned long long>(recording.frames.size()));
+	return 0;
+}
+
+/// <summary>
+/// Prints a state trace, one line per frame with the first player and the obstacles
+/// </summary>
+/// <param name="path">Path of the trace</param>
+/// <returns>Exit code</returns>
+static int decodeTrace(const char* path) {
+	attachConsole();
+
+	std::vector<StateTracer::Frame> frames;
+	const auto hr = StateTracer::read(path, frames);
+	if (FAILED(hr)) {
+		LOG_ERROR("Reading the trace {} failed with {}", path, Logger::hresult(hr));
+		return 1;
+	}
+
+	printf("frames: %llu\nframe,players,health,player_y,player_velocity,obstacles\n", static_cast<unsigned long long>(frames.size()));
+	for (const auto& frame : frames) {
+		printf("%u,%u,", frame.frame, static_cast<uint32_t>(frame.players.size()));
+		if (!frame.players.empty()) {
+			const auto& player = frame.players.front();
+			printf("%d,%.3f,%.3f,", player.health, player.y, player.velocity);
+		} else {
+			printf(",,,");
+		}
+		for (size_t i = 0; i < frame.obstacles.size(); i++) {
+			printf(i > 0 ? " %.1f:%u" : "%.1f:%u", frame.obstacles[i].x, frame.obstacles[i].type);
+		}
+		printf("\n");
+	}
+	return 0;
+}
+
+/// <summary>
+/// Replays a flight recording and draws its frames on the CPU into BMP files, at any resolution.
+/// The renderer keeps its picture between frames, so only the damaged pixels are drawn
+/// </summary>
+/// <param name="path">Path of the recording</param>
+/// <param name="width">Width of the pictures</param>
+/// <param name="height">Height of the pictures</param>
+/// <param name="directory">Directory the pictures are written to</param>
+/// <param name="every">Only every n-th frame is drawn</param>
+/// <returns>Exit code</returns>
+static int captureRecording(const char* path, const uint32_t width, const uint32_t height, const char* directory, const uint32_t every) {
+	attachConsole();
+
+	FlightRecorder::Recording recording;
+	auto hr = FlightRecorder::read(path, recording);
+	if (FAILED(hr)) {
+		LOG_ERROR("Reading the recording {} failed with {}", path, Logger::hresult(hr));
+		return 1;
+	}
+
+	const auto& header = recording.header;
+	if ((header.flags & FlightRecorder::FLAG_COURSE_FILE) != 0 || header.jumpCount > header.jumpCapacity) {
+		printf("capture: not possible, the run used a course file or more jumps than were kept\n");
+		return 1;
+	}
+	if (width == 0 || height == 0 || every == 0) {
+		printf("capture: the size and the frame interval have to be positive\n");
+		return 1;
+	}
+	CreateDirectory(directory, nullptr);
+
+	Logic logic(nullptr);
+	ScriptedController controller(logic, recording.jumps);
+	logic.enableParticles(CAPTURE_PARTICLES);
+	logic.setCourseSeed(header.seed);
+	logic.addPlayer(&controller);
+	logic.initialize();
+
+	SpriteAtlas atlas;
+	if (FAILED(atlas.open("ChromeDino.atlas"))) {
+		atlas.createDefault();
+	}
+	SoftwareRenderer renderer(width, height);
+	renderer.setAtlas(&atlas);
+	renderer.setIncremental(true);
+
+	FrameSnapshot snapshot;
+	uint32_t captured = 0;
+	double renderSeconds = 0.0;
+	char file[MAX_PATH];
+
+	auto over = false;
+	while (!over && logic.getFrameCount() < header.frameCount) {
+		over = logic.onUpdate(header.tickSeconds);
+		if (logic.getFrameCount() % every != 0) continue;
+
+		logic.writeSnapshot(snapshot);
+		const auto start = std::chrono::steady_clock::now();
+		renderer.render(snapshot);
+		renderSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		snprintf(file, sizeof(file), "%s\\frame_%06u.bmp", directory, logic.getFrameCount());
+		hr = renderer.getFrame().saveBitmap(file);
+		if (FAILED(hr)) {
+			printf("capture: writing %s failed with 0x%08lX\n", file, static_cast<unsigned long>(hr));
+			return 1;
+		}
+		captured++;
+	}
+
+	printf("captured: %u frames of %ux%u in %zu tiles\nrender: %.3f ms per frame\nredrawn: %.1f%% of the pixels per frame\n",
+		captured, width, height, renderer.getTileCount(), captured > 0 ? renderSeconds * 1000.0 / captured : 0.0,
+		renderer.getDamage().getAverageFraction() * 100.0);
+	return 0;
+}
 
 /// <summary>
 /// Main entry point of the program.
@@ -26,11 +418,187 @@ int WINAPI WinMain(
 	//Seed the random
 	srand(time(nullptr));
 
+	//--log <file> writes the diagnostics of every mode into a file instead of the debugger output
+	const char* logPath = nullptr;
+	for (int i = 1; i + 1 < __argc; i++) {
+		if (strcmp(__argv[i], "--log") == 0) {
+			logPath = __argv[i + 1];
+		}
+	}
+	if (FAILED(Logger::getInstance().start(logPath))) {
+		Logger::getInstance().start(nullptr);
+		LOG_WARNING("Opening the log file {} failed", logPath);
+	}
+
+	//--placement <none|cores|numa> binds the workers of the batch modes to cores, numa keeps their work on their node
+	for (int i = 1; i + 1 < __argc; i++) {
+		if (strcmp(__argv[i], "--placement") != 0) continue;
+
+		const auto* placement = __argv[i + 1];
+		if (strcmp(placement, "cores") == 0) {
+			JobSystem::setPlacement(JobSystem::pinned);
+		} else if (strcmp(placement, "numa") == 0) {
+			JobSystem::setPlacement(JobSystem::numa);
+		} else if (strcmp(placement, "none") != 0) {
+			LOG_WARNING("Unknown placement {}", placement);
+		}
+	}
+
+	//--export-course <file> <count> <seed> writes a generated course without starting the game
+	if (__argc >= 5 && strcmp(__argv[1], "--export-course") == 0) {
+		const auto count = _strtoui64(__argv[3], nullptr, 10);
+		const auto seed = _strtoui64(__argv[4], nullptr, 10);
+
+		CourseGenerator course(seed, CourseParams());
+		const auto hr = CourseFile::write(__argv[2], course, count, seed);
+		LOG_IF_FAILED(hr, "Exporting the course");
+		return SUCCEEDED(hr) ? 0 : 1;
+	}
+
+	//--serve <name> <instances> [<frame size>] hosts games for controllers in other processes
+	if (__argc >= 4 && strcmp(__argv[1], "--serve") == 0) {
+		const auto frameSize = __argc >= 5 ? strtoul(__argv[4], nullptr, 10) : 0;
+
+		EnvironmentServer server;
+		const auto hr = server.create(__argv[2], strtoul(__argv[3], nullptr, 10), frameSize);
+		if (FAILED(hr)) {
+			LOG_ERROR("Creating the environment {} failed with {}", __argv[2], Logger::hresult(hr));
+			return 1;
+		}
+
+		server.run();
+		return 0;
+	}
+
+	//--simulate <seed> <ticks> [--events] [--jumps <tick,tick,...>] runs without a window,
+	//--simulate <seed> <ticks> --check [<runs>] compares both modes on consecutive seeds
+	if (__argc >= 4 && strcmp(__argv[1], "--simulate") == 0) {
+		auto events = false;
+		std::vector<uint32_t> jumps;
+		for (int i = 4; i < __argc; i++) {
+			if (strcmp(__argv[i], "--events") == 0) {
+				events = true;
+			} else if (strcmp(__argv[i], "--jumps") == 0 && i + 1 < __argc) {
+				jumps = parseTicks(__argv[++i]);
+			} else if (strcmp(__argv[i], "--check") == 0) {
+				const auto runs = i + 1 < __argc ? strtoul(__argv[i + 1], nullptr, 10) : 100;
+				return checkHeadless(_strtoui64(__argv[2], nullptr, 10), strtoul(__argv[3], nullptr, 10), runs);
+			}
+		}
+		return runHeadless(_strtoui64(__argv[2], nullptr, 10), strtoul(__argv[3], nullptr, 10), events, jumps);
+	}
+
+	//--train <generations> <population> <genome file> [<seed>] trains a controller for the demo mode
+	if (__argc >= 5 && strcmp(__argv[1], "--train") == 0) {
+		TrainerParams params;
+		params.populationSize = strtoul(__argv[3], nullptr, 10);
+		if (__argc >= 6) {
+			params.seed = _strtoui64(__argv[5], nullptr, 10);
+		}
+		return runTraining(strtoul(__argv[2], nullptr, 10), params, __argv[4]);
+	}
+
+	//--decode-recording <file> [--replay] prints a flight recording and checks it against a replay of the run
+	if (__argc >= 3 && strcmp(__argv[1], "--decode-recording") == 0) {
+		return decodeRecording(__argv[2], __argc >= 4 && strcmp(__argv[3], "--replay") == 0);
+	}
+
+	//--decode-trace <file> prints a trace written with --trace
+	if (__argc >= 3 && strcmp(__argv[1], "--decode-trace") == 0) {
+		return decodeTrace(__argv[2]);
+	}
+
+	//--capture <recording> <width> <height> <directory> [<every>] replays a flight recording into pictures,
+	//every n-th frame is drawn on the CPU at any resolution, for example 3840 2160
+	if (__argc >= 6 && strcmp(__argv[1], "--capture") == 0) {
+		const auto every = __argc >= 7 ? strtoul(__argv[6], nullptr, 10) : 1;
+		return captureRecording(__argv[2], strtoul(__argv[3], nullptr, 10), strtoul(__argv[4], nullptr, 10), __argv[5], every);
+	}
+
+	//--bake-atlas <file> writes the painted sprites into an atlas file that --atlas maps at startup
+	if (__argc >= 3 && strcmp(__argv[1], "--bake-atlas") == 0) {
+		SpriteAtlas atlas;
+		atlas.createDefault();
+
+		const auto hr = atlas.save(__argv[2]);
+		LOG_IF_FAILED(hr, "Baking the atlas");
+		return SUCCEEDED(hr) ? 0 : 1;
+	}
+
+	//--sweep <games per cell> [--<parameter> <min>:<max>:<steps>] [--reaction <pixels>] [--ticks <ticks>]
+	//compares the difficulty of rules, parameters are min-spawn, max-spawn, wide, high, cactus-speed, jump and gravity
+	if (__argc >= 3 && strcmp(__argv[1], "--sweep") == 0) {
+		SweepParams params;
+		params.gamesPerCell = _strtoui64(__argv[2], nullptr, 10);
+
+		for (int i = 3; i + 1 < __argc; i++) {
+			const auto* name = __argv[i];
+			const auto* value = __argv[++i];
+
+			if (strcmp(name, "--min-spawn") == 0) {
+				params.minSpawnSpeed = parseRange(value);
+			} else if (strcmp(name, "--max-spawn") == 0) {
+				params.maxSpawnSpeed = parseRange(value);
+			} else if (strcmp(name, "--wide") == 0) {
+				params.wideChance = parseRange(value);
+			} else if (strcmp(name, "--high") == 0) {
+				params.highChance = parseRange(value);
+			} else if (strcmp(name, "--cactus-speed") == 0) {
+				params.cactusSpeed = parseRange(value);
+			} else if (strcmp(name, "--jump") == 0) {
+				params.jumpVelocity = parseRange(value);
+			} else if (strcmp(name, "--gravity") == 0) {
+				params.gravity = parseRange(value);
+			} else if (strcmp(name, "--reaction") == 0) {
+				params.reactionDistance = strtof(value, nullptr);
+			} else if (strcmp(name, "--ticks") == 0) {
+				params.maxTicks = strtoul(value, nullptr, 10);
+			}
+		}
+		return runSweep(params);
+	}
+
 	if (SUCCEEDED(CoInitialize(NULL))) {
 		{
 			ChromeDino chromeDino;
+			auto hr = S_OK;
 
-			if (SUCCEEDED(chromeDino.initialize())) {
+			//--course <file> plays a fixed course, --trace <file> records every frame,
+			//--genome <file> lets a trained network play, --record <file> moves the flight recording
+			const char* recordingPath = "ChromeDino.rec";
+			const char* atlasPath = "ChromeDino.atlas";
+			for (int i = 1; i + 1 < __argc && SUCCEEDED(hr); i++) {
+				if (strcmp(__argv[i], "--course") == 0) {
+					hr = chromeDino.loadCourse(__argv[++i]);
+				} else if (strcmp(__argv[i], "--trace") == 0) {
+					hr = chromeDino.startTrace(__argv[++i]);
+				} else if (strcmp(__argv[i], "--genome") == 0) {
+					hr = chromeDino.loadGenome(__argv[++i]);
+				} else if (strcmp(__argv[i], "--record") == 0) {
+					recordingPath = __argv[++i];
+				} else if (strcmp(__argv[i], "--atlas") == 0) {
+					atlasPath = __argv[++i];
+				}
+			}
+
+			//The sprites are painted without an atlas file
+			chromeDino.loadAtlas(atlasPath);
+
+			//--software draws the frames on the CPU instead of with Direct2D,
+			//--incremental only draws the pixels that changed since the last frame
+			for (int i = 1; i < __argc; i++) {
+				if (strcmp(__argv[i], "--software") == 0) {
+					chromeDino.useSoftwareRenderer();
+				} else if (strcmp(__argv[i], "--incremental") == 0) {
+					chromeDino.useIncrementalRendering();
+				}
+			}
+			if (SUCCEEDED(hr)) {
+				hr = chromeDino.initialize();
+			}
+			if (SUCCEEDED(hr)) {
+				//The game also runs without a recording
+				chromeDino.startRecording(recordingPath);
 				chromeDino.runGameLoop();
 			}
 		}
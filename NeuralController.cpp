@@ -0,0 +1,25 @@
+#include "NeuralController.h"
+#include "NeuralPopulation.h"
+
+/// <summary>
+/// Constructor
+/// </summary>
+/// <param name="population">Population that holds the network</param>
+/// <param name="agent">Index of the network that controls the player</param>
+NeuralController::NeuralController(const NeuralPopulation& population, const size_t agent) :
+	_population	(population),
+	_agent		(agent) {}
+
+/// <summary>
+/// Destructor
+/// </summary>
+NeuralController::~NeuralController() = default;
+
+/// <summary>
+/// Returns the decision of the network for this step
+/// </summary>
+/// <param name="player">Player asking for its next action</param>
+/// <returns></returns>
+bool NeuralController::isJumpRequested(const Player& player) {
+	return _population.getDecision(_agent);
+}
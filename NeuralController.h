@@ -0,0 +1,25 @@
+#ifndef NEURALCONTROLLER_HPP
+#define NEURALCONTROLLER_HPP
+
+#include <cstddef>
+
+#include "Controller.h"
+
+class NeuralPopulation;
+
+/// <summary>
+/// Jumps when a network of a population decided so, the population decides before every update
+/// </summary>
+class NeuralController : public Controller {
+	public:
+		NeuralController(const NeuralPopulation& population, size_t agent);
+		~NeuralController();
+
+		bool isJumpRequested(const Player& player) override;
+
+	private:
+		const NeuralPopulation& _population;
+		size_t					_agent;
+};
+
+#endif //NEURALCONTROLLER_HPP
@@ -0,0 +1,250 @@
+#include <xmmintrin.h>
+#include <cstring>
+
+#include "NeuralPopulation.h"
+#include "JobSystem.h"
+#include "Logic.h"
+#include "Player.h"
+#include "Resolution.h"
+
+//Identifies genome files
+static const char GENOME_MAGIC[4] = { 'D', 'N', 'N', 'G' };
+
+//Number of blocks of four networks evaluated by a single job
+static const size_t BLOCK_GRAIN_SIZE = 8;
+
+//Offsets of the weights inside a genome
+static const size_t HIDDEN_STRIDE = NeuralPopulation::FEATURE_COUNT + 1;
+static const size_t OUTPUT_OFFSET = NeuralPopulation::HIDDEN_COUNT * HIDDEN_STRIDE;
+static const size_t OUTPUT_BIAS = OUTPUT_OFFSET + NeuralPopulation::HIDDEN_COUNT;
+
+static_assert(OUTPUT_BIAS + 1 == NeuralPopulation::GENOME_SIZE, "Genome layout does not match its size");
+
+/// <summary>
+/// Constructor
+/// </summary>
+/// <param name="size">Number of networks, one per player</param>
+NeuralPopulation::NeuralPopulation(const size_t size) :
+	_genomes	(size, Genome(GENOME_SIZE, 0.0f)),
+	_blockCount	((size + LANES - 1) / LANES),
+	_weights	(_blockCount * GENOME_SIZE * LANES, 0.0f),
+	_features	(_blockCount * FEATURE_COUNT * LANES, 0.0f),
+	_decisions	(_blockCount * LANES, 0),
+	_logic		(nullptr) {
+	_graph.addParallelTask([this]() { return _blockCount; }, BLOCK_GRAIN_SIZE, [this](size_t begin, size_t end) {
+		for (auto block = begin; block < end; block++) {
+			gatherBlock(block);
+			evaluateBlock(block);
+		}
+	});
+}
+
+/// <summary>
+/// Destructor
+/// </summary>
+NeuralPopulation::~NeuralPopulation() = default;
+
+/// <summary>
+/// Returns the number of networks
+/// </summary>
+/// <returns></returns>
+size_t NeuralPopulation::getSize() const {
+	return _genomes.size();
+}
+
+/// <summary>
+/// Returns the weights of a network, call pack after changing them
+/// </summary>
+/// <param name="agent">Index of the network</param>
+/// <returns></returns>
+NeuralPopulation::Genome& NeuralPopulation::getGenome(const size_t agent) {
+	return _genomes[agent];
+}
+
+/// <summary>
+/// Returns the weights of a network
+/// </summary>
+/// <param name="agent">Index of the network</param>
+/// <returns></returns>
+const NeuralPopulation::Genome& NeuralPopulation::getGenome(const size_t agent) const {
+	return _genomes[agent];
+}
+
+/// <summary>
+/// Interleaves the weights of every four networks, so the same weight of all four lies side by side.
+/// Lanes without a network keep zero weights and never jump
+/// </summary>
+void NeuralPopulation::pack() {
+	for (size_t agent = 0; agent < _genomes.size(); agent++) {
+		auto* weights = &_weights[(agent / LANES) * GENOME_SIZE * LANES];
+		const auto lane = agent % LANES;
+
+		for (size_t i = 0; i < GENOME_SIZE; i++) {
+			weights[i * LANES + lane] = _genomes[agent][i];
+		}
+	}
+}
+
+/// <summary>
+/// Decides the next action of every player of a game.
+/// Network i controls player i, has to be called before the update and not during it
+/// </summary>
+/// <param name="logic">Game the players belong to</param>
+void NeuralPopulation::decide(Logic& logic) {
+	_logic = &logic;
+	_graph.execute(JobSystem::getInstance());
+	_logic = nullptr;
+}
+
+/// <summary>
+/// Returns the last decision of a network
+/// </summary>
+/// <param name="agent">Index of the network</param>
+/// <returns>True if the player should jump</returns>
+bool NeuralPopulation::getDecision(const size_t agent) const {
+	return agent < _genomes.size() && _decisions[agent] != 0;
+}
+
+/// <summary>
+/// Collects the observations of the players of a block as inputs of the networks
+/// </summary>
+/// <param name="block">Index of the block</param>
+void NeuralPopulation::gatherBlock(const size_t block) {
+	auto* features = &_features[block * FEATURE_COUNT * LANES];
+	Observation observation;
+
+	for (size_t lane = 0; lane < LANES; lane++) {
+		const auto agent = block * LANES + lane;
+		if (agent < _genomes.size()) {
+			_logic->writeObservation(agent, observation);
+		} else {
+			observation = Observation();
+		}
+		writeFeatures(observation, features, lane);
+	}
+}
+
+/// <summary>
+/// Evaluates four networks at once, every lane of the registers belongs to another network
+/// </summary>
+/// <param name="block">Index of the block</param>
+void NeuralPopulation::evaluateBlock(const size_t block) {
+	const auto* weights = &_weights[block * GENOME_SIZE * LANES];
+	const auto* features = &_features[block * FEATURE_COUNT * LANES];
+	const auto zero = _mm_setzero_ps();
+
+	auto output = _mm_loadu_ps(weights + OUTPUT_BIAS * LANES);
+	for (size_t h = 0; h < HIDDEN_COUNT; h++) {
+		const auto* row = weights + h * HIDDEN_STRIDE * LANES;
+
+		auto sum = _mm_loadu_ps(row + FEATURE_COUNT * LANES);
+		for (size_t i = 0; i < FEATURE_COUNT; i++) {
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(row + i * LANES), _mm_loadu_ps(features + i * LANES)));
+		}
+		sum = _mm_max_ps(sum, zero);
+
+		output = _mm_add_ps(output, _mm_mul_ps(_mm_loadu_ps(weights + (OUTPUT_OFFSET + h) * LANES), sum));
+	}
+
+	const auto jumps = _mm_movemask_ps(_mm_cmpgt_ps(output, zero));
+	for (size_t lane = 0; lane < LANES; lane++) {
+		_decisions[block * LANES + lane] = static_cast<uint8_t>((jumps >> lane) & 1);
+	}
+}
+
+/// <summary>
+/// Scales an observation to inputs of about -1 to 1 and stores them in one lane.
+/// Missing obstacles look like obstacles far away
+/// </summary>
+/// <param name="observation">Observation of the player</param>
+/// <param name="features">Inputs of a block, feature by feature</param>
+/// <param name="lane">Lane of the network</param>
+void NeuralPopulation::writeFeatures(const Observation& observation, float* features, const size_t lane) {
+	features[0 * LANES + lane] = observation.playerY / HEIGHT;
+	features[1 * LANES + lane] = observation.playerVelocity / -Player::JUMP_VELOCITY;
+
+	for (uint32_t i = 0; i < Observation::MAX_OBSTACLES; i++) {
+		auto* obstacle = features + (2 + i * 3) * LANES + lane;
+		if (i < observation.obstacleCount) {
+			obstacle[0 * LANES] = observation.obstacles[i].distance / WIDTH;
+			obstacle[1 * LANES] = observation.obstacles[i].width / Player::SIZE_X;
+			obstacle[2 * LANES] = observation.obstacles[i].height / Player::SIZE_Y;
+		} else {
+			obstacle[0 * LANES] = 1.0f;
+			obstacle[1 * LANES] = 0.0f;
+			obstacle[2 * LANES] = 0.0f;
+		}
+	}
+}
+
+/// <summary>
+/// Writes the weights of a network into a genome file
+/// </summary>
+/// <param name="path">Path of the genome file</param>
+/// <param name="genome">Weights to write</param>
+/// <returns>HRESULT</returns>
+HRESULT NeuralPopulation::saveGenome(const char* path, const Genome& genome) {
+	if (genome.size() != GENOME_SIZE) return E_INVALIDARG;
+
+	auto file = CreateFile(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	auto hr = file != INVALID_HANDLE_VALUE ? S_OK : E_FAIL;
+
+	if (SUCCEEDED(hr)) {
+		FileHeader header;
+		memcpy(header.magic, GENOME_MAGIC, sizeof(GENOME_MAGIC));
+		header.version = FILE_VERSION;
+		header.featureCount = FEATURE_COUNT;
+		header.hiddenCount = HIDDEN_COUNT;
+
+		DWORD written;
+		const auto weightBytes = static_cast<DWORD>(GENOME_SIZE * sizeof(float));
+		if (!WriteFile(file, &header, sizeof(header), &written, nullptr) || written != sizeof(header) ||
+			!WriteFile(file, genome.data(), weightBytes, &written, nullptr) || written != weightBytes) {
+			hr = E_FAIL;
+		}
+	}
+
+	if (file != INVALID_HANDLE_VALUE) {
+		CloseHandle(file);
+	}
+	return hr;
+}
+
+/// <summary>
+/// Reads the weights of a network from a genome file, the network has to have the same shape
+/// </summary>
+/// <param name="path">Path of the genome file</param>
+/// <param name="genome">Receives the weights</param>
+/// <returns>HRESULT</returns>
+HRESULT NeuralPopulation::loadGenome(const char* path, Genome& genome) {
+	auto file = CreateFile(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	auto hr = file != INVALID_HANDLE_VALUE ? S_OK : E_FAIL;
+
+	FileHeader header;
+	DWORD read;
+	if (SUCCEEDED(hr)) {
+		hr = ReadFile(file, &header, sizeof(header), &read, nullptr) && read == sizeof(header) ? S_OK : E_FAIL;
+	}
+	if (SUCCEEDED(hr)) {
+		if (memcmp(header.magic, GENOME_MAGIC, sizeof(GENOME_MAGIC)) != 0 ||
+			header.version != FILE_VERSION ||
+			header.featureCount != FEATURE_COUNT ||
+			header.hiddenCount != HIDDEN_COUNT) {
+			hr = E_INVALIDARG;
+		}
+	}
+	if (SUCCEEDED(hr)) {
+		Genome weights(GENOME_SIZE);
+		const auto weightBytes = static_cast<DWORD>(GENOME_SIZE * sizeof(float));
+		hr = ReadFile(file, weights.data(), weightBytes, &read, nullptr) && read == weightBytes ? S_OK : E_INVALIDARG;
+
+		if (SUCCEEDED(hr)) {
+			genome.swap(weights);
+		}
+	}
+
+	if (file != INVALID_HANDLE_VALUE) {
+		CloseHandle(file);
+	}
+	return hr;
+}
@@ -0,0 +1,74 @@
+#ifndef NEURALPOPULATION_HPP
+#define NEURALPOPULATION_HPP
+
+#include <windows.h>
+#include <cstdint>
+#include <vector>
+
+#include "Observation.h"
+#include "TaskGraph.h"
+
+class Logic;
+
+/// <summary>
+/// Small networks that decide when the players of a game jump, one network per player.
+/// Every network has one hidden layer of rectified units and a single output, the player jumps if it is positive.
+/// The weights are interleaved four networks at a time, so one SSE lane computes one network
+/// and a whole population is evaluated as a batch of matrix products
+/// </summary>
+class NeuralPopulation {
+	public:
+		static const size_t FEATURE_COUNT = 2 + Observation::MAX_OBSTACLES * 3;
+		static const size_t HIDDEN_COUNT = 16;
+		static const size_t GENOME_SIZE = HIDDEN_COUNT * (FEATURE_COUNT + 1) + HIDDEN_COUNT + 1;
+
+		typedef std::vector<float> Genome;
+
+		/// <summary>
+		/// Header at the start of every genome file, the weights follow directly
+		/// </summary>
+		struct FileHeader {
+			char	 magic[4];
+			uint32_t version;
+			uint32_t featureCount;
+			uint32_t hiddenCount;
+		};
+
+		static const uint32_t FILE_VERSION = 1;
+
+		explicit NeuralPopulation(size_t size);
+		~NeuralPopulation();
+
+		size_t getSize() const;
+		Genome& getGenome(size_t agent);
+		const Genome& getGenome(size_t agent) const;
+
+		void pack();
+		void decide(Logic& logic);
+		bool getDecision(size_t agent) const;
+
+		static HRESULT saveGenome(const char* path, const Genome& genome);
+		static HRESULT loadGenome(const char* path, Genome& genome);
+
+		NeuralPopulation(const NeuralPopulation&) = delete;
+		void operator = (const NeuralPopulation&) = delete;
+
+	private:
+		static const size_t LANES = 4;
+
+		std::vector<Genome>	 _genomes;
+		size_t				 _blockCount;
+		std::vector<float>	 _weights;
+		std::vector<float>	 _features;
+		std::vector<uint8_t> _decisions;
+
+		TaskGraph _graph;
+		Logic*	  _logic;
+
+		void gatherBlock(size_t block);
+		void evaluateBlock(size_t block);
+
+		static void writeFeatures(const Observation& observation, float* features, size_t lane);
+};
+
+#endif //NEURALPOPULATION_HPP
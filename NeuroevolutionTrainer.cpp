@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <memory>
+#include <numeric>
+
+#include "NeuroevolutionTrainer.h"
+#include "Logic.h"
+#include "NeuralController.h"
+
+//Length of a simulation step in seconds, the same as the fixed step of the game
+static const double STEP_SECONDS = 1.0 / 60.0;
+
+//Spread of the random starting weights
+static const float INITIAL_SCALE = 0.5f;
+
+/// <summary>
+/// Constructor, starts with random networks
+/// </summary>
+/// <param name="params">Parameters of the training</param>
+NeuroevolutionTrainer::NeuroevolutionTrainer(const TrainerParams& params) :
+	_params		(params),
+	_population	(params.populationSize > 0 ? params.populationSize : 1),
+	_fitness	(_population.getSize(), 0.0f),
+	_ranking	(_population.getSize(), 0),
+	_generation	(0),
+	_random		(params.seed) {
+	_params.eliteCount = std::max<size_t>(1, std::min(_params.eliteCount, _population.getSize()));
+
+	std::normal_distribution<float> weight(0.0f, INITIAL_SCALE);
+	for (size_t agent = 0; agent < _population.getSize(); agent++) {
+		for (auto& value : _population.getGenome(agent)) {
+			value = weight(_random);
+		}
+	}
+	_population.pack();
+}
+
+/// <summary>
+/// Destructor
+/// </summary>
+NeuroevolutionTrainer::~NeuroevolutionTrainer() = default;
+
+/// <summary>
+/// Scores the current networks on a new course and breeds the next generation from the best ones
+/// </summary>
+/// <returns>Fitness of the scored generation</returns>
+GenerationResult NeuroevolutionTrainer::runGeneration() {
+	evaluate(_params.seed + _generation);
+
+	std::iota(_ranking.begin(), _ranking.end(), 0);
+	std::stable_sort(_ranking.begin(), _ranking.end(), [this](size_t a, size_t b) {
+		return _fitness[a] > _fitness[b];
+	});
+
+	GenerationResult result;
+	result.generation = _generation;
+	result.bestFitness = _fitness[_ranking[0]];
+	result.meanFitness = std::accumulate(_fitness.begin(), _fitness.end(), 0.0f) / _fitness.size();
+
+	breed();
+	_generation++;
+	return result;
+}
+
+/// <summary>
+/// Returns the best network of the last scored generation
+/// </summary>
+/// <returns></returns>
+const NeuralPopulation::Genome& NeuroevolutionTrainer::getBest() const {
+	//Breeding keeps the elites in ranking order at the front
+	return _population.getGenome(0);
+}
+
+/// <summary>
+/// Plays one game with a player per network until every player died or the tick limit is reached
+/// </summary>
+/// <param name="courseSeed">Seed of the course all players run on</param>
+void NeuroevolutionTrainer::evaluate(const uint64_t courseSeed) {
+	std::vector<std::unique_ptr<NeuralController>> controllers;
+	controllers.reserve(_population.getSize());
+
+	Logic logic(nullptr);
+	logic.setCourseSeed(courseSeed);
+	for (size_t agent = 0; agent < _population.getSize(); agent++) {
+		controllers.emplace_back(new NeuralController(_population, agent));
+		logic.addPlayer(controllers.back().get());
+	}
+	logic.initialize();
+
+	while (logic.getFrameCount() < _params.maxTicks) {
+		_population.decide(logic);
+		if (logic.onUpdate(STEP_SECONDS)) break;
+	}
+
+	for (size_t agent = 0; agent < _population.getSize(); agent++) {
+		_fitness[agent] = logic.getPlayer(agent)->getSurvivalTime();
+	}
+}
+
+/// <summary>
+/// Replaces the population with the elites and mutated copies of them
+/// </summary>
+void NeuroevolutionTrainer::breed() {
+	std::vector<NeuralPopulation::Genome> elites;
+	elites.reserve(_params.eliteCount);
+	for (size_t i = 0; i < _params.eliteCount; i++) {
+		elites.push_back(_population.getGenome(_ranking[i]));
+	}
+
+	std::uniform_int_distribution<size_t> parent(0, elites.size() - 1);
+	std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+	std::normal_distribution<float> mutation(0.0f, _params.mutationScale);
+
+	for (size_t agent = 0; agent < _population.getSize(); agent++) {
+		auto& genome = _population.getGenome(agent);
+		if (agent < elites.size()) {
+			genome = elites[agent];
+			continue;
+		}
+
+		genome = elites[parent(_random)];
+		for (auto& value : genome) {
+			if (chance(_random) < _params.mutationChance) {
+				value += mutation(_random);
+			}
+		}
+	}
+	_population.pack();
+}
@@ -0,0 +1,65 @@
+#ifndef NEUROEVOLUTIONTRAINER_HPP
+#define NEUROEVOLUTIONTRAINER_HPP
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "NeuralPopulation.h"
+
+/// <summary>
+/// Parameters of the training
+/// </summary>
+struct TrainerParams {
+	size_t	 populationSize;
+	size_t	 eliteCount;
+	float	 mutationChance;
+	float	 mutationScale;
+	uint32_t maxTicks;
+	uint64_t seed;
+
+	TrainerParams() :
+		populationSize	(256),
+		eliteCount		(16),
+		mutationChance	(0.1f),
+		mutationScale	(0.3f),
+		maxTicks		(60 * 120),
+		seed			(1) {}
+};
+
+/// <summary>
+/// Outcome of one generation
+/// </summary>
+struct GenerationResult {
+	uint32_t generation;
+	float	 bestFitness;
+	float	 meanFitness;
+};
+
+/// <summary>
+/// Trains the networks of a population by evolution.
+/// Every generation plays one game in which every network controls a player on the same course,
+/// the fitness is the survival time. The best networks are kept as they are and the rest is replaced
+/// by mutated copies of them. Players and networks are updated in parallel, so a generation uses all cores
+/// </summary>
+class NeuroevolutionTrainer {
+	public:
+		explicit NeuroevolutionTrainer(const TrainerParams& params);
+		~NeuroevolutionTrainer();
+
+		GenerationResult runGeneration();
+		const NeuralPopulation::Genome& getBest() const;
+
+	private:
+		TrainerParams		_params;
+		NeuralPopulation	_population;
+		std::vector<float>	_fitness;
+		std::vector<size_t>	_ranking;
+		uint32_t			_generation;
+		std::mt19937_64		_random;
+
+		void evaluate(uint64_t courseSeed);
+		void breed();
+};
+
+#endif //NEUROEVOLUTIONTRAINER_HPP
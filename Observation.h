@@ -0,0 +1,30 @@
+#ifndef OBSERVATION_HPP
+#define OBSERVATION_HPP
+
+#include <cstdint>
+
+/// <summary>
+/// What a controller gets to see of a player and the obstacles in front of it.
+/// Plain data, so it can be shared with other processes as it is
+/// </summary>
+struct Observation {
+	static const int MAX_OBSTACLES = 4;
+
+	/// <summary>
+	/// Obstacle ahead of the player, the nearest one comes first
+	/// </summary>
+	struct Obstacle {
+		float distance;
+		float width;
+		float height;
+		float reserved;
+	};
+
+	float	 playerY;
+	float	 playerVelocity;
+	uint32_t obstacleCount;
+	uint32_t reserved;
+	Obstacle obstacles[MAX_OBSTACLES];
+};
+
+#endif //OBSERVATION_HPP
@@ -0,0 +1,132 @@
+#include <emmintrin.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "ObservationRasterizer.h"
+#include "JobSystem.h"
+#include "Logic.h"
+#include "Resolution.h"
+#include "TaskGraph.h"
+
+//Number of frames rasterized by a single job
+static const size_t BATCH_GRAIN_SIZE = 4;
+
+/// <summary>
+/// Constructor
+/// </summary>
+/// <param name="width">Width of the frames in pixels</param>
+/// <param name="height">Height of the frames in pixels</param>
+ObservationRasterizer::ObservationRasterizer(const uint32_t width, const uint32_t height) :
+	_width		(width),
+	_height		(height),
+	_scaleX		(static_cast<float>(width) / WIDTH),
+	_scaleY		(static_cast<float>(height) / HEIGHT) {}
+
+/// <summary>
+/// Destructor
+/// </summary>
+ObservationRasterizer::~ObservationRasterizer() = default;
+
+/// <summary>
+/// Returns the width of the frames
+/// </summary>
+/// <returns></returns>
+uint32_t ObservationRasterizer::getWidth() const {
+	return _width;
+}
+
+/// <summary>
+/// Returns the height of the frames
+/// </summary>
+/// <returns></returns>
+uint32_t ObservationRasterizer::getHeight() const {
+	return _height;
+}
+
+/// <summary>
+/// Returns the number of bytes of a frame
+/// </summary>
+/// <returns></returns>
+size_t ObservationRasterizer::getFrameSize() const {
+	return static_cast<size_t>(_width) * _height;
+}
+
+/// <summary>
+/// Draws the rectangles of a snapshot into a frame, the frame is cleared first
+/// </summary>
+/// <param name="snapshot">Snapshot to draw</param>
+/// <param name="frame">Frame of width * height bytes, row by row</param>
+void ObservationRasterizer::rasterize(const FrameSnapshot& snapshot, uint8_t* frame) const {
+	memset(frame, 0, getFrameSize());
+	for (auto& rect : snapshot.rects) {
+		fillRect(rect, frame);
+	}
+}
+
+/// <summary>
+/// Draws the current state of a game into a frame
+/// </summary>
+/// <param name="logic">Game to draw</param>
+/// <param name="frame">Frame of width * height bytes, row by row</param>
+void ObservationRasterizer::rasterize(Logic& logic, uint8_t* frame) {
+	if (_snapshots.empty()) {
+		_snapshots.resize(1);
+	}
+	logic.writeSnapshot(_snapshots[0]);
+	rasterize(_snapshots[0], frame);
+}
+
+/// <summary>
+/// Draws many games in parallel into one contiguous buffer shaped [count][height][width]
+/// </summary>
+/// <param name="instances">Games to draw</param>
+/// <param name="count">Number of games</param>
+/// <param name="frames">Buffer of count * width * height bytes</param>
+void ObservationRasterizer::rasterizeBatch(Logic* const* instances, const size_t count, uint8_t* frames) {
+	//Every game gets its own snapshot, so the jobs share nothing
+	if (_snapshots.size() < count) {
+		_snapshots.resize(count);
+	}
+
+	TaskGraph graph;
+	graph.addParallelTask([count]() { return count; }, BATCH_GRAIN_SIZE, [this, instances, frames](size_t begin, size_t end) {
+		for (auto i = begin; i < end; i++) {
+			instances[i]->writeSnapshot(_snapshots[i]);
+			rasterize(_snapshots[i], frames + i * getFrameSize());
+		}
+	});
+	graph.execute(JobSystem::getInstance());
+}
+
+/// <summary>
+/// Fills the pixels whose centers are inside the rectangle with its luminance
+/// </summary>
+/// <param name="rect">Rectangle to fill</param>
+/// <param name="frame">Frame to draw into</param>
+void ObservationRasterizer::fillRect(const FrameSnapshot::Rect& rect, uint8_t* frame) const {
+	//Pixel i covers the center (i + 0.5) / scale
+	const auto left = std::max(0, static_cast<int>(std::ceil(rect.rect.left * _scaleX - 0.5f)));
+	const auto right = std::min(static_cast<int>(_width), static_cast<int>(std::ceil(rect.rect.right * _scaleX - 0.5f)));
+	const auto top = std::max(0, static_cast<int>(std::ceil(rect.rect.top * _scaleY - 0.5f)));
+	const auto bottom = std::min(static_cast<int>(_height), static_cast<int>(std::ceil(rect.rect.bottom * _scaleY - 0.5f)));
+	if (left >= right || top >= bottom) return;
+
+	const auto luminance = 0.299f * rect.color.r + 0.587f * rect.color.g + 0.114f * rect.color.b;
+	const auto gray = static_cast<uint8_t>(std::min(255.0f, std::max(1.0f, luminance * 255.0f + 0.5f)));
+	const auto value = _mm_set1_epi8(static_cast<char>(gray));
+
+	for (auto y = top; y < bottom; y++) {
+		auto* row = frame + static_cast<size_t>(y) * _width;
+		auto x = left;
+
+		//Sixteen pixels per step, keeping the brighter value where shapes overlap
+		for (; x + 16 <= right; x += 16) {
+			auto* pixels = reinterpret_cast<__m128i*>(row + x);
+			_mm_storeu_si128(pixels, _mm_max_epu8(_mm_loadu_si128(pixels), value));
+		}
+		for (; x < right; x++) {
+			row[x] = std::max(row[x], gray);
+		}
+	}
+}
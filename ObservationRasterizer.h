@@ -0,0 +1,40 @@
+#ifndef OBSERVATIONRASTERIZER_HPP
+#define OBSERVATIONRASTERIZER_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "FrameSnapshot.h"
+
+class Logic;
+
+/// <summary>
+/// Draws small grayscale frames for pixel based controllers straight from the simulation,
+/// without Direct2D and without rendering the full resolution first.
+/// A pixel is covered by a rectangle if its center is inside, overlapping rectangles keep the brighter value
+/// </summary>
+class ObservationRasterizer {
+	public:
+		ObservationRasterizer(uint32_t width = 84, uint32_t height = 84);
+		~ObservationRasterizer();
+
+		uint32_t getWidth() const;
+		uint32_t getHeight() const;
+		size_t getFrameSize() const;
+
+		void rasterize(const FrameSnapshot& snapshot, uint8_t* frame) const;
+		void rasterize(Logic& logic, uint8_t* frame);
+		void rasterizeBatch(Logic* const* instances, size_t count, uint8_t* frames);
+
+	private:
+		uint32_t _width;
+		uint32_t _height;
+		float	 _scaleX;
+		float	 _scaleY;
+
+		std::vector<FrameSnapshot> _snapshots;
+
+		void fillRect(const FrameSnapshot::Rect& rect, uint8_t* frame) const;
+};
+
+#endif //OBSERVATIONRASTERIZER_HPP
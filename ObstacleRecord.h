@@ -0,0 +1,20 @@
+#ifndef OBSTACLERECORD_HPP
+#define OBSTACLERECORD_HPP
+
+#include <cstdint>
+
+/// <summary>
+/// One obstacle of a course, fixed 24 byte layout.
+/// The spawn time is a double, a float could no longer tell ticks apart on long courses
+/// </summary>
+struct ObstacleRecord {
+	double	 time;
+	float	 x;
+	float	 y;
+	uint32_t type;
+	uint32_t reserved;
+};
+
+static_assert(sizeof(ObstacleRecord) == 24, "ObstacleRecord has to stay 24 bytes");
+
+#endif //OBSTACLERECORD_HPP
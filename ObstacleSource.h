@@ -0,0 +1,40 @@
+#ifndef OBSTACLESOURCE_HPP
+#define OBSTACLESOURCE_HPP
+
+#include <cstddef>
+
+#include "ObstacleRecord.h"
+
+/// <summary>
+/// Sequence of upcoming obstacles the spawn logic consumes
+/// </summary>
+class ObstacleSource {
+	public:
+		virtual ~ObstacleSource() = default;
+
+		/// <summary>
+		/// Returns the number of upcoming obstacles that can be peeked at
+		/// </summary>
+		/// <returns></returns>
+		virtual size_t getLookahead() const = 0;
+
+		/// <summary>
+		/// Returns an upcoming obstacle
+		/// </summary>
+		/// <param name="index">0 for the next obstacle to spawn, has to be less than getLookahead()</param>
+		/// <returns></returns>
+		virtual const ObstacleRecord& peek(size_t index) const = 0;
+
+		/// <summary>
+		/// Marks the next obstacle as spawned
+		/// </summary>
+		virtual void advance() = 0;
+
+		/// <summary>
+		/// Tells the source that the oldest spawned obstacles left the screen
+		/// </summary>
+		/// <param name="count">Number of obstacles that left the screen</param>
+		virtual void retire(size_t count) = 0;
+};
+
+#endif //OBSTACLESOURCE_HPP
@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <cmath>
+
+#include "ParallaxBackground.h"
+#include "Cactus.h"
+#include "Utils.h"
+
+static const float TWO_PI = 6.2831853f;
+
+//Placement of the layers in the coordinates of the game, from back to front
+static const float CLOUDS_TOP = 30.0f;
+static const float CLOUDS_HEIGHT = 110.0f;
+static const float CLOUDS_SPEED = 15.0f;
+static const float HILLS_HEIGHT = 140.0f;
+static const float HILLS_SPEED = 40.0f;
+static const float GROUND_HEIGHT = 12.0f;
+
+static const uint32_t CLOUD_COUNT = 6;
+
+/// <summary>
+/// Returns a repeatable random number from 0 to 1
+/// </summary>
+/// <param name="index">Index of the number</param>
+/// <returns></returns>
+static float hashUnit(uint32_t index) {
+	index ^= index >> 16;
+	index *= 0x7FEB352Du;
+	index ^= index >> 15;
+	index *= 0x846CA68Bu;
+	index ^= index >> 16;
+	return static_cast<float>(index & 0xFFFFFF) / 16777216.0f;
+}
+
+/// <summary>
+/// Constructor, paints all the layers
+/// </summary>
+/// <param name="width">Width of the picture the background is drawn into</param>
+/// <param name="height">Height of the picture, the layers are scaled by it</param>
+ParallaxBackground::ParallaxBackground(const uint32_t width, const uint32_t height) :
+	_width	(width),
+	_height	(height),
+	_scale	(static_cast<float>(height) / HEIGHT) {
+	addLayer(CLOUDS_TOP, CLOUDS_HEIGHT, CLOUDS_SPEED, paintClouds);
+	addLayer(HEIGHT - HILLS_HEIGHT, HILLS_HEIGHT, HILLS_SPEED, paintHills);
+	//The ground moves with the obstacles on it
+	addLayer(HEIGHT - GROUND_HEIGHT, GROUND_HEIGHT, Cactus::getSpeed(), paintGround);
+}
+
+/// <summary>
+/// Destructor
+/// </summary>
+ParallaxBackground::~ParallaxBackground() {
+	discardBitmaps();
+}
+
+/// <summary>
+/// Uploads the strips into bitmaps of a render target, once per device
+/// </summary>
+/// <param name="renderTarget">Render target the layers are drawn to</param>
+/// <returns>HRESULT</returns>
+HRESULT ParallaxBackground::createBitmaps(ID2D1RenderTarget* renderTarget) {
+	discardBitmaps();
+
+	auto hr = S_OK;
+	for (auto& layer : _layers) {
+		hr = renderTarget->CreateBitmap(
+			D2D1::SizeU(layer.strip.getWidth(), layer.strip.getHeight()),
+			layer.strip.getPixels(),
+			layer.strip.getPitch(),
+			D2D1::BitmapProperties(D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED)),
+			&layer.bitmap
+		);
+		if (FAILED(hr)) break;
+	}
+	if (FAILED(hr)) {
+		discardBitmaps();
+	}
+	return hr;
+}
+
+/// <summary>
+/// Releases the bitmaps, the strips stay in memory
+/// </summary>
+void ParallaxBackground::discardBitmaps() {
+	for (auto& layer : _layers) {
+		Utils::safeRelease(&layer.bitmap);
+	}
+}
+
+/// <summary>
+/// Draws the layers with a render target, every layer takes at most two bitmap draws
+/// </summary>
+/// <param name="renderTarget">Render target the bitmaps were created for</param>
+/// <param name="time">Seconds the game has been running, moves the layers</param>
+void ParallaxBackground::draw(ID2D1RenderTarget* renderTarget, const float time) const {
+	for (const auto& layer : _layers) {
+		if (!layer.bitmap) continue;
+
+		const auto stripWidth = static_cast<int>(layer.strip.getWidth());
+		const auto top = layer.top / _scale;
+		const auto bottom = (layer.top + layer.strip.getHeight()) / _scale;
+
+		for (auto x = -static_cast<int>(getOffset(layer, time)); x < static_cast<int>(_width); x += stripWidth) {
+			renderTarget->DrawBitmap(layer.bitmap, D2D1::RectF(x / _scale, top, (x + stripWidth) / _scale, bottom),
+				1.0f, D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR);
+		}
+	}
+}
+
+/// <summary>
+/// Blends the layers into a framebuffer of the size the background was painted for
+/// </summary>
+/// <param name="target">Framebuffer to draw into</param>
+/// <param name="time">Seconds the game has been running, moves the layers</param>
+/// <param name="clip">Only these pixels are drawn to</param>
+void ParallaxBackground::draw(Framebuffer& target, const float time, const D2D1_RECT_U& clip) const {
+	const auto area = Framebuffer::intersect(clip, D2D1::RectU(0, 0, std::min(_width, target.getWidth()), target.getHeight()));
+	if (area.left >= area.right) return;
+
+	for (const auto& layer : _layers) {
+		const auto stripWidth = layer.strip.getWidth();
+		const auto offset = getOffset(layer, time);
+		const auto top = std::max(layer.top, area.top);
+		const auto bottom = std::min(layer.top + layer.strip.getHeight(), area.bottom);
+
+		for (auto y = top; y < bottom; y++) {
+			const auto* source = layer.strip.getRow(y - layer.top);
+			auto* destination = target.getRow(y);
+
+			//The visible part starts anywhere in the strip and wraps around its end
+			auto x = area.left;
+			auto from = (offset + area.left) % stripWidth;
+			while (x < area.right) {
+				const auto count = std::min(area.right - x, stripWidth - from);
+				Framebuffer::blendSpan(destination + x, source + from, count);
+				x += count;
+				from = 0;
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Returns the number of layers
+/// </summary>
+/// <returns></returns>
+size_t ParallaxBackground::getLayerCount() const {
+	return _layers.size();
+}
+
+/// <summary>
+/// Returns the pixels a layer covers, all of its rows over the whole width
+/// </summary>
+/// <param name="layer">Index of the layer, back to front</param>
+/// <returns>Pixel rectangle, right and bottom are exclusive</returns>
+D2D1_RECT_U ParallaxBackground::getLayerBounds(const size_t layer) const {
+	const auto& strip = _layers[layer].strip;
+	return D2D1::RectU(0, _layers[layer].top, _width, std::min(_layers[layer].top + strip.getHeight(), _height));
+}
+
+/// <summary>
+/// Returns the column of the strip at the left edge, the layer looks the same as long as it stays
+/// </summary>
+/// <param name="layer">Index of the layer, back to front</param>
+/// <param name="time">Seconds the game has been running</param>
+/// <returns></returns>
+uint32_t ParallaxBackground::getLayerOffset(const size_t layer, const float time) const {
+	return getOffset(_layers[layer], time);
+}
+
+/// <summary>
+/// Creates a layer and paints its strip
+/// </summary>
+/// <param name="top">Top of the layer in the coordinates of the game</param>
+/// <param name="height">Height of the layer in the coordinates of the game</param>
+/// <param name="speed">Pixels of the game per second the layer moves to the left</param>
+/// <param name="paint">Paints the strip</param>
+void ParallaxBackground::addLayer(const float top, const float height, const float speed, void (*paint)(Framebuffer& strip, float scale)) {
+	Layer layer;
+	layer.top = static_cast<uint32_t>(std::lround(top * _scale));
+	layer.speed = speed;
+	layer.bitmap = nullptr;
+	layer.strip.resize(
+		std::max(1u, static_cast<uint32_t>(std::lround(STRIP_WIDTH * _scale))),
+		std::max(1u, static_cast<uint32_t>(std::lround(height * _scale))));
+
+	paint(layer.strip, _scale);
+	_layers.push_back(std::move(layer));
+}
+
+/// <summary>
+/// Returns the column of the strip that is at the left edge of the picture
+/// </summary>
+/// <param name="layer">Layer to move</param>
+/// <param name="time">Seconds the game has been running</param>
+/// <returns></returns>
+uint32_t ParallaxBackground::getOffset(const Layer& layer, const float time) const {
+	const auto stripWidth = layer.strip.getWidth();
+	const auto offset = static_cast<uint32_t>(std::fmod(static_cast<double>(time) * layer.speed * _scale, stripWidth));
+	return std::min(offset, stripWidth - 1);
+}
+
+/// <summary>
+/// Paints soft white clouds, each made of a few overlapping ellipses
+/// </summary>
+/// <param name="strip">Strip to paint</param>
+/// <param name="scale">Pixels per unit of the game</param>
+void ParallaxBackground::paintClouds(Framebuffer& strip, const float scale) {
+	const auto width = static_cast<float>(strip.getWidth());
+	const auto height = static_cast<float>(strip.getHeight());
+
+	for (uint32_t cloud = 0; cloud < CLOUD_COUNT; cloud++) {
+		const auto centerX = (cloud + 0.3f + 0.4f * hashUnit(cloud * 4)) * width / CLOUD_COUNT;
+		const auto centerY = height * (0.3f + 0.4f * hashUnit(cloud * 4 + 1));
+		const auto radius = (18.0f + 14.0f * hashUnit(cloud * 4 + 2)) * scale;
+
+		for (int puff = -1; puff <= 1; puff++) {
+			const auto puffX = centerX + puff * radius * 0.9f;
+			const auto puffY = centerY + (puff == 0 ? -radius * 0.35f : 0.0f);
+			const auto radiusX = radius * (puff == 0 ? 1.2f : 0.9f);
+			const auto radiusY = radiusX * 0.6f;
+
+			const auto top = std::max(0, static_cast<int>(puffY - radiusY) - 1);
+			const auto bottom = std::min(static_cast<int>(height), static_cast<int>(puffY + radiusY) + 2);
+			for (auto y = top; y < bottom; y++) {
+				auto* row = strip.getRow(y);
+				for (uint32_t x = 0; x < strip.getWidth(); x++) {
+					//Distance along the strip, measured around its end so the clouds wrap
+					auto dx = x + 0.5f - puffX;
+					dx -= width * std::round(dx / width);
+					const auto dy = y + 0.5f - puffY;
+
+					const auto distance = std::sqrt((dx * dx) / (radiusX * radiusX) + (dy * dy) / (radiusY * radiusY));
+					const auto coverage = std::min(1.0f, std::max(0.0f, (1.0f - distance) * radiusY));
+					if (coverage <= 0.0f) continue;
+
+					//Premultiplied white, overlapping puffs keep the more opaque value
+					const auto alpha = static_cast<uint32_t>(coverage * 0.9f * 255.0f + 0.5f);
+					if (alpha > (row[x] >> 24)) {
+						row[x] = alpha * 0x01010101u;
+					}
+				}
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Paints rolling hills, the outline is a sum of waves that repeat over the strip
+/// </summary>
+/// <param name="strip">Strip to paint</param>
+/// <param name="scale">Pixels per unit of the game</param>
+void ParallaxBackground::paintHills(Framebuffer& strip, const float scale) {
+	const auto color = Framebuffer::toPixel(D2D1::ColorF(0.55f, 0.73f, 0.55f));
+	const auto height = static_cast<float>(strip.getHeight());
+
+	for (uint32_t x = 0; x < strip.getWidth(); x++) {
+		const auto phase = TWO_PI * (x + 0.5f) / strip.getWidth();
+		const auto hill = (70.0f + 28.0f * std::sin(2.0f * phase + 0.7f) + 18.0f * std::sin(5.0f * phase + 2.1f) + 6.0f * std::sin(11.0f * phase)) * scale;
+		const auto edge = height - hill;
+
+		for (uint32_t y = 0; y < strip.getHeight(); y++) {
+			//Part of the pixel below the outline
+			const auto coverage = std::min(1.0f, std::max(0.0f, y + 1.0f - edge));
+			strip.getRow(y)[x] = Framebuffer::scalePixel(color, static_cast<uint32_t>(coverage * 256.0f));
+		}
+	}
+}
+
+/// <summary>
+/// Paints the ground: a dark line on top of sand with pebbles
+/// </summary>
+/// <param name="strip">Strip to paint</param>
+/// <param name="scale">Pixels per unit of the game</param>
+void ParallaxBackground::paintGround(Framebuffer& strip, const float scale) {
+	const auto line = Framebuffer::toPixel(D2D1::ColorF(0.33f, 0.33f, 0.33f));
+	const auto sand = Framebuffer::toPixel(D2D1::ColorF(0.87f, 0.8f, 0.62f));
+	const auto pebble = Framebuffer::toPixel(D2D1::ColorF(0.6f, 0.55f, 0.45f));
+	const auto lineHeight = std::max(1u, static_cast<uint32_t>(std::lround(2.0f * scale)));
+
+	for (uint32_t y = 0; y < strip.getHeight(); y++) {
+		auto* row = strip.getRow(y);
+		for (uint32_t x = 0; x < strip.getWidth(); x++) {
+			if (y < lineHeight) {
+				row[x] = line;
+			} else {
+				row[x] = hashUnit(y * strip.getWidth() + x) < 0.04f ? pebble : sand;
+			}
+		}
+	}
+}
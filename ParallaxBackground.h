@@ -0,0 +1,64 @@
+#ifndef PARALLAXBACKGROUND_HPP
+#define PARALLAXBACKGROUND_HPP
+
+#include <windows.h>
+#include <cstdint>
+#include <vector>
+
+#include <d2d1.h>
+
+#include "Framebuffer.h"
+#include "Resolution.h"
+
+/// <summary>
+/// Scrolling scenery behind the game: clouds, hills and the ground, each moving at its own speed.
+/// Every layer is painted once into a strip that wraps around seamlessly,
+/// a frame only copies the strips at their current offsets, no matter how detailed they are.
+/// The strips are drawn either as Direct2D bitmaps or blended into a framebuffer,
+/// they are painted at the resolution they are drawn at, which is the size of the game scaled by the height
+/// </summary>
+class ParallaxBackground {
+	public:
+		static const uint32_t STRIP_WIDTH = 1024;
+
+		ParallaxBackground(uint32_t width = WIDTH, uint32_t height = HEIGHT);
+		~ParallaxBackground();
+
+		HRESULT createBitmaps(ID2D1RenderTarget* renderTarget);
+		void discardBitmaps();
+
+		void draw(ID2D1RenderTarget* renderTarget, float time) const;
+		void draw(Framebuffer& target, float time, const D2D1_RECT_U& clip) const;
+
+		size_t getLayerCount() const;
+		D2D1_RECT_U getLayerBounds(size_t layer) const;
+		uint32_t getLayerOffset(size_t layer, float time) const;
+
+		ParallaxBackground(const ParallaxBackground&) = delete;
+		void operator = (const ParallaxBackground&) = delete;
+
+	private:
+		/// <summary>
+		/// One strip and where and how fast it moves
+		/// </summary>
+		struct Layer {
+			Framebuffer	 strip;
+			uint32_t	 top;
+			float		 speed;
+			ID2D1Bitmap* bitmap;
+		};
+
+		uint32_t		   _width;
+		uint32_t		   _height;
+		float			   _scale;
+		std::vector<Layer> _layers;
+
+		void addLayer(float top, float height, float speed, void (*paint)(Framebuffer& strip, float scale));
+		uint32_t getOffset(const Layer& layer, float time) const;
+
+		static void paintClouds(Framebuffer& strip, float scale);
+		static void paintHills(Framebuffer& strip, float scale);
+		static void paintGround(Framebuffer& strip, float scale);
+};
+
+#endif //PARALLAXBACKGROUND_HPP
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <initializer_list>
+
+#include "ParameterSweep.h"
+#include "JobSystem.h"
+
+//Length of a simulation step in seconds, the same as the fixed step of the game
+static const double STEP_SECONDS = 1.0 / 60.0;
+
+/// <summary>
+/// Returns the value of a step of the range
+/// </summary>
+/// <param name="step">Index of the step</param>
+/// <returns></returns>
+float SweepRange::getValue(const uint32_t step) const {
+	if (steps <= 1) return min;
+
+	return min + (max - min) * step / (steps - 1);
+}
+
+/// <summary>
+/// Constructor, every range holds only the value the game uses
+/// </summary>
+SweepParams::SweepParams() :
+	gamesPerCell		(10000),
+	firstSeed			(1),
+	maxTicks			(60 * 120),
+	reactionDistance	(60.0f) {
+	const CourseParams course;
+	const PhysicsParams physics;
+
+	minSpawnSpeed = course.minSpawnSpeed;
+	maxSpawnSpeed = course.maxSpawnSpeed;
+	wideChance = course.wideChance;
+	highChance = course.highChance;
+	cactusSpeed = physics.cactusSpeed;
+	jumpVelocity = physics.jumpVelocity;
+	gravity = physics.gravity;
+}
+
+/// <summary>
+/// Constructor
+/// </summary>
+/// <param name="params">Parameters of the sweep</param>
+ParameterSweep::ParameterSweep(const SweepParams& params) :
+	_params			(params),
+	_blockSurvival	((params.gamesPerCell + BLOCK_GAMES - 1) / BLOCK_GAMES),
+	_blockDeaths	(_blockSurvival.size(), 0) {
+	_graph.addParallelTask([this]() { return _blockSurvival.size(); }, 1, [this](size_t begin, size_t end) {
+		for (auto block = begin; block < end; block++) {
+			runBlock(block);
+		}
+	});
+}
+
+/// <summary>
+/// Destructor
+/// </summary>
+ParameterSweep::~ParameterSweep() = default;
+
+/// <summary>
+/// Returns the number of combinations of the ranges
+/// </summary>
+/// <returns></returns>
+uint64_t ParameterSweep::getCellCount() const {
+	uint64_t count = 1;
+	for (const auto* range : { &_params.minSpawnSpeed, &_params.maxSpawnSpeed, &_params.wideChance, &_params.highChance,
+							   &_params.cactusSpeed, &_params.jumpVelocity, &_params.gravity }) {
+		count *= range->steps > 0 ? range->steps : 1;
+	}
+	return count;
+}
+
+/// <summary>
+/// Returns the rules of a cell, the last range changes fastest
+/// </summary>
+/// <param name="index">Index of the cell</param>
+/// <returns></returns>
+SweepCell ParameterSweep::getCell(uint64_t index) const {
+	const auto value = [&index](const SweepRange& range) {
+		const auto steps = range.steps > 0 ? range.steps : 1;
+		const auto step = static_cast<uint32_t>(index % steps);
+		index /= steps;
+		return range.getValue(step);
+	};
+
+	SweepCell cell;
+	cell.physics.gravity = value(_params.gravity);
+	cell.physics.jumpVelocity = value(_params.jumpVelocity);
+	cell.physics.cactusSpeed = value(_params.cactusSpeed);
+	cell.course.highChance = value(_params.highChance);
+	cell.course.wideChance = value(_params.wideChance);
+	cell.course.maxSpawnSpeed = value(_params.maxSpawnSpeed);
+	cell.course.minSpawnSpeed = value(_params.minSpawnSpeed);
+	return cell;
+}
+
+/// <summary>
+/// Plays all games of a cell on all cores and merges their outcome
+/// </summary>
+/// <param name="index">Index of the cell</param>
+/// <returns></returns>
+SweepResult ParameterSweep::runCell(const uint64_t index) {
+	_cell = getCell(index);
+	_graph.execute(JobSystem::getInstance());
+
+	//Merge in block order, so the result does not depend on the threads
+	SweepResult result;
+	result.games = _params.gamesPerCell;
+	result.deaths = 0;
+	for (size_t block = 0; block < _blockSurvival.size(); block++) {
+		result.survival.merge(_blockSurvival[block]);
+		result.deaths += _blockDeaths[block];
+	}
+	return result;
+}
+
+/// <summary>
+/// Plays the games of one block of the current cell
+/// </summary>
+/// <param name="block">Index of the block</param>
+void ParameterSweep::runBlock(const size_t block) {
+	auto& survival = _blockSurvival[block];
+	auto& deaths = _blockDeaths[block];
+	survival.clear();
+	deaths = 0;
+
+	const auto begin = block * BLOCK_GAMES;
+	const auto end = std::min<uint64_t>(begin + BLOCK_GAMES, _params.gamesPerCell);
+
+	CourseGenerator course(_params.firstSeed + begin, _cell.course);
+	EventSimulation simulation(course, STEP_SECONDS, _cell.physics);
+	simulation.setReactionDistance(_params.reactionDistance);
+
+	for (auto game = begin; game < end; game++) {
+		course.reset(_params.firstSeed + game);
+
+		const auto outcome = simulation.run(_params.maxTicks);
+		survival.add(outcome.survivalTime);
+		if (outcome.died) {
+			deaths++;
+		}
+	}
+}
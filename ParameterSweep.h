@@ -0,0 +1,93 @@
+#ifndef PARAMETERSWEEP_HPP
+#define PARAMETERSWEEP_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "CourseGenerator.h"
+#include "EventSimulation.h"
+#include "QuantileSketch.h"
+#include "TaskGraph.h"
+
+/// <summary>
+/// Evenly spaced values of one parameter, both ends included
+/// </summary>
+struct SweepRange {
+	float	 min;
+	float	 max;
+	uint32_t steps;
+
+	SweepRange(float value = 0.0f) :
+		min		(value),
+		max		(value),
+		steps	(1) {}
+
+	float getValue(uint32_t step) const;
+};
+
+/// <summary>
+/// Parameters of the sweep, every combination of the ranges is a cell
+/// </summary>
+struct SweepParams {
+	SweepRange minSpawnSpeed;
+	SweepRange maxSpawnSpeed;
+	SweepRange wideChance;
+	SweepRange highChance;
+	SweepRange cactusSpeed;
+	SweepRange jumpVelocity;
+	SweepRange gravity;
+
+	uint64_t gamesPerCell;
+	uint64_t firstSeed;
+	uint32_t maxTicks;
+	float	 reactionDistance;
+
+	SweepParams();
+};
+
+/// <summary>
+/// Rules of a single cell
+/// </summary>
+struct SweepCell {
+	CourseParams  course;
+	PhysicsParams physics;
+};
+
+/// <summary>
+/// Outcome of all games of a cell
+/// </summary>
+struct SweepResult {
+	uint64_t	   games;
+	uint64_t	   deaths;
+	QuantileSketch survival;
+};
+
+/// <summary>
+/// Plays many games for every combination of course and movement rules to compare their difficulty.
+/// The games run in the event driven simulation with a reference controller that jumps at a fixed distance,
+/// game i of every cell uses the same seed, so the cells only differ in their rules.
+/// The games of a cell are split into blocks that run on all cores and are summarized in sketches
+/// </summary>
+class ParameterSweep {
+	public:
+		static const uint64_t BLOCK_GAMES = 1024;
+
+		explicit ParameterSweep(const SweepParams& params);
+		~ParameterSweep();
+
+		uint64_t getCellCount() const;
+		SweepCell getCell(uint64_t index) const;
+		SweepResult runCell(uint64_t index);
+
+	private:
+		SweepParams _params;
+		SweepCell	_cell;
+		TaskGraph	_graph;
+
+		std::vector<QuantileSketch> _blockSurvival;
+		std::vector<uint64_t>		_blockDeaths;
+
+		void runBlock(size_t block);
+};
+
+#endif //PARAMETERSWEEP_HPP
@@ -0,0 +1,284 @@
+#include <xmmintrin.h>
+#include <algorithm>
+#include <cmath>
+
+#include "ParticleSystem.h"
+#include "Framebuffer.h"
+#include "Resolution.h"
+
+//Pulls the particles down, in pixels per second squared
+static const float PARTICLE_GRAVITY = 600.0f;
+
+//Width and height of a particle in pixels
+static const int PARTICLE_SIZE = 2;
+
+/// <summary>
+/// Mixes a seed into well distributed random bits
+/// </summary>
+/// <param name="seed">Value to mix</param>
+/// <returns></returns>
+static uint64_t mixBits(uint64_t seed) {
+	seed += 0x9E3779B97F4A7C15ull;
+	seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ull;
+	seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBull;
+	return seed ^ (seed >> 31);
+}
+
+/// <summary>
+/// Turns the low 24 bits into a number from 0 to 1
+/// </summary>
+/// <param name="bits">Random bits</param>
+/// <returns></returns>
+static float toUnit(const uint64_t bits) {
+	return static_cast<float>(bits & 0xFFFFFF) / 16777216.0f;
+}
+
+/// <summary>
+/// Constructor
+/// </summary>
+/// <param name="capacity">Maximum number of living particles, bursts beyond it are cut off</param>
+ParticleSystem::ParticleSystem(const size_t capacity) :
+	_capacity	(capacity),
+	_count		(0),
+	_dropped	(0),
+	_x			(capacity),
+	_y			(capacity),
+	_velocityX	(capacity),
+	_velocityY	(capacity),
+	_life		(capacity),
+	_lifetime	(capacity),
+	_color		(capacity) {}
+
+/// <summary>
+/// Destructor
+/// </summary>
+ParticleSystem::~ParticleSystem() = default;
+
+/// <summary>
+/// Adds the particles of a burst, may be called from several jobs at once but not during an update
+/// </summary>
+/// <param name="burst">Description of the particles</param>
+/// <param name="x">Horizontal position of the burst</param>
+/// <param name="y">Vertical position of the burst</param>
+/// <param name="seed">Seed of the random directions, speeds and lifetimes</param>
+/// <returns>Number of particles added</returns>
+size_t ParticleSystem::emit(const Burst& burst, const float x, const float y, const uint64_t seed) {
+	//Reserve a range at the end, as much of the burst as still fits
+	auto first = _count.load(std::memory_order_relaxed);
+	size_t reserved;
+	do {
+		reserved = std::min<size_t>(burst.count, _capacity - first);
+		if (reserved == 0) break;
+	} while (!_count.compare_exchange_weak(first, first + reserved, std::memory_order_relaxed));
+
+	if (reserved < burst.count) {
+		_dropped.fetch_add(burst.count - reserved, std::memory_order_relaxed);
+	}
+
+	const auto color = Framebuffer::toPixel(burst.color);
+	for (size_t i = 0; i < reserved; i++) {
+		const auto bits = mixBits(seed + i);
+		const auto angle = burst.angle + burst.spread * (toUnit(bits) - 0.5f);
+		const auto speed = burst.minSpeed + (burst.maxSpeed - burst.minSpeed) * toUnit(bits >> 24);
+		const auto lifetime = burst.lifetime * (0.5f + 0.5f * toUnit(bits >> 40));
+
+		const auto slot = first + i;
+		_x[slot] = x;
+		_y[slot] = y;
+		_velocityX[slot] = std::cos(angle) * speed;
+		_velocityY[slot] = -std::sin(angle) * speed;
+		_life[slot] = lifetime;
+		_lifetime[slot] = lifetime;
+		_color[slot] = color;
+	}
+	return reserved;
+}
+
+/// <summary>
+/// Moves a range of particles and ages them, ranges of different jobs must not overlap
+/// </summary>
+/// <param name="begin">First particle</param>
+/// <param name="end">Particle after the last one</param>
+/// <param name="delta">Time since last frame in seconds</param>
+void ParticleSystem::update(const size_t begin, size_t end, const float delta) {
+	end = std::min(end, getCount());
+
+	const auto time = _mm_set1_ps(delta);
+	const auto fall = _mm_set1_ps(PARTICLE_GRAVITY * delta);
+
+	auto i = begin;
+	for (; i + 4 <= end; i += 4) {
+		const auto velocityX = _mm_loadu_ps(&_velocityX[i]);
+		const auto velocityY = _mm_add_ps(_mm_loadu_ps(&_velocityY[i]), fall);
+
+		_mm_storeu_ps(&_x[i], _mm_add_ps(_mm_loadu_ps(&_x[i]), _mm_mul_ps(velocityX, time)));
+		_mm_storeu_ps(&_y[i], _mm_add_ps(_mm_loadu_ps(&_y[i]), _mm_mul_ps(velocityY, time)));
+		_mm_storeu_ps(&_velocityY[i], velocityY);
+		_mm_storeu_ps(&_life[i], _mm_sub_ps(_mm_loadu_ps(&_life[i]), time));
+	}
+	for (; i < end; i++) {
+		_velocityY[i] += PARTICLE_GRAVITY * delta;
+		_x[i] += _velocityX[i] * delta;
+		_y[i] += _velocityY[i] * delta;
+		_life[i] -= delta;
+	}
+}
+
+/// <summary>
+/// Removes the particles whose life ended by moving the last particle into their place
+/// </summary>
+void ParticleSystem::removeExpired() {
+	auto count = getCount();
+	const auto zero = _mm_setzero_ps();
+
+	size_t i = 0;
+	while (i < count) {
+		//Skip four living particles at once, expired ones are rare
+		if (i + 4 <= count && _mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(&_life[i]), zero)) == 0) {
+			i += 4;
+			continue;
+		}
+		if (_life[i] > 0.0f) {
+			i++;
+			continue;
+		}
+
+		//Check the moved particle again in the next iteration
+		count--;
+		move(count, i);
+	}
+	_count = count;
+}
+
+/// <summary>
+/// Removes all particles
+/// </summary>
+void ParticleSystem::clear() {
+	_count = 0;
+}
+
+/// <summary>
+/// Returns the number of living particles
+/// </summary>
+/// <returns></returns>
+size_t ParticleSystem::getCount() const {
+	return _count.load(std::memory_order_relaxed);
+}
+
+/// <summary>
+/// Returns the maximum number of particles
+/// </summary>
+/// <returns></returns>
+size_t ParticleSystem::getCapacity() const {
+	return _capacity;
+}
+
+/// <summary>
+/// Returns how many particles did not fit anymore
+/// </summary>
+/// <returns></returns>
+uint64_t ParticleSystem::getDroppedCount() const {
+	return _dropped.load(std::memory_order_relaxed);
+}
+
+/// <summary>
+/// Adds the particles on screen to a snapshot, they fade out over their life
+/// </summary>
+/// <param name="snapshot">Snapshot to add the particles to</param>
+void ParticleSystem::writeSprites(FrameSnapshot& snapshot) const {
+	const auto count = getCount();
+	snapshot.particles.reserve(count);
+
+	for (size_t i = 0; i < count; i++) {
+		if (_x[i] < 0.0f || _y[i] < 0.0f || _x[i] >= WIDTH || _y[i] >= HEIGHT) continue;
+
+		const auto fade = static_cast<uint32_t>(std::max(0.0f, std::min(1.0f, _life[i] / _lifetime[i])) * 256.0f);
+		snapshot.particles.push_back(FrameSnapshot::Particle{ _x[i], _y[i], Framebuffer::scalePixel(_color[i], fade) });
+	}
+}
+
+/// <summary>
+/// Draws the particles of a snapshot over the pixels of a framebuffer, every particle covers a small square
+/// </summary>
+/// <param name="snapshot">Snapshot with the particles</param>
+/// <param name="target">Framebuffer to draw into</param>
+/// <param name="scale">Pixels of the framebuffer per unit of the game</param>
+/// <param name="bounds">Receives the pixels that were drawn to</param>
+/// <returns>True if any particle was drawn</returns>
+bool ParticleSystem::splat(const FrameSnapshot& snapshot, Framebuffer& target, const float scale, D2D1_RECT_U& bounds) {
+	return splat(snapshot.particles, target, scale, target.getBounds(), bounds);
+}
+
+/// <summary>
+/// Draws particles over the pixels of a framebuffer inside a clip rectangle,
+/// particles that are only partly inside the framebuffer are left out
+/// </summary>
+/// <param name="particles">Particles to draw</param>
+/// <param name="target">Framebuffer to draw into</param>
+/// <param name="scale">Pixels of the framebuffer per unit of the game</param>
+/// <param name="clip">Only these pixels are drawn to</param>
+/// <param name="bounds">Receives the pixels that were drawn to</param>
+/// <returns>True if any particle was drawn</returns>
+bool ParticleSystem::splat(const std::vector<FrameSnapshot::Particle>& particles, Framebuffer& target, const float scale,
+	const D2D1_RECT_U& clip, D2D1_RECT_U& bounds) {
+	auto drawn = D2D1::RectU(clip.right, clip.bottom, clip.left, clip.top);
+
+	D2D1_RECT_U square;
+	for (const auto& particle : particles) {
+		if (!getSplatRect(particle, target.getWidth(), target.getHeight(), scale, square)) continue;
+
+		square = Framebuffer::intersect(square, clip);
+		if (square.left >= square.right || square.top >= square.bottom) continue;
+
+		for (auto row = square.top; row < square.bottom; row++) {
+			auto* pixels = target.getRow(row);
+			for (auto column = square.left; column < square.right; column++) {
+				pixels[column] = Framebuffer::blendPixel(particle.color, pixels[column]);
+			}
+		}
+
+		drawn.left = std::min(drawn.left, square.left);
+		drawn.top = std::min(drawn.top, square.top);
+		drawn.right = std::max(drawn.right, square.right);
+		drawn.bottom = std::max(drawn.bottom, square.bottom);
+	}
+
+	if (drawn.left >= drawn.right) return false;
+
+	bounds = drawn;
+	return true;
+}
+
+/// <summary>
+/// Returns the square of pixels a particle covers
+/// </summary>
+/// <param name="particle">Particle to draw</param>
+/// <param name="width">Width of the framebuffer</param>
+/// <param name="height">Height of the framebuffer</param>
+/// <param name="scale">Pixels of the framebuffer per unit of the game</param>
+/// <param name="rect">Receives the pixels, right and bottom are exclusive</param>
+/// <returns>False if the square is not completely inside the framebuffer</returns>
+bool ParticleSystem::getSplatRect(const FrameSnapshot::Particle& particle, const uint32_t width, const uint32_t height, const float scale, D2D1_RECT_U& rect) {
+	const auto size = std::max(1, static_cast<int>(PARTICLE_SIZE * scale + 0.5f));
+	const auto x = static_cast<int>(particle.x * scale);
+	const auto y = static_cast<int>(particle.y * scale);
+	if (x < 0 || y < 0 || x > static_cast<int>(width) - size || y > static_cast<int>(height) - size) return false;
+
+	rect = D2D1::RectU(x, y, x + size, y + size);
+	return true;
+}
+
+/// <summary>
+/// Copies a particle into another slot
+/// </summary>
+/// <param name="from">Slot to copy</param>
+/// <param name="to">Slot to overwrite</param>
+void ParticleSystem::move(const size_t from, const size_t to) {
+	_x[to] = _x[from];
+	_y[to] = _y[from];
+	_velocityX[to] = _velocityX[from];
+	_velocityY[to] = _velocityY[from];
+	_life[to] = _life[from];
+	_lifetime[to] = _lifetime[from];
+	_color[to] = _color[from];
+}
@@ -0,0 +1,73 @@
+#ifndef PARTICLESYSTEM_HPP
+#define PARTICLESYSTEM_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <d2d1.h>
+
+#include "FrameSnapshot.h"
+
+class Framebuffer;
+
+/// <summary>
+/// Short lived visual particles, like the dust of a landing.
+/// Every attribute has its own array of fixed capacity, so the update runs four particles per SSE instruction.
+/// Bursts can be emitted from parallel jobs, they reserve their range with one atomic operation.
+/// Expired particles are replaced by the last one, the living particles stay packed at the front.
+/// Particles are only visual, they never change the simulation
+/// </summary>
+class ParticleSystem {
+	public:
+		/// <summary>
+		/// Describes the particles of a burst, angles are in radians, 0 points right and positive angles point up
+		/// </summary>
+		struct Burst {
+			uint32_t	 count;
+			float		 angle;
+			float		 spread;
+			float		 minSpeed;
+			float		 maxSpeed;
+			float		 lifetime;
+			D2D1_COLOR_F color;
+		};
+
+		explicit ParticleSystem(size_t capacity);
+		~ParticleSystem();
+
+		size_t emit(const Burst& burst, float x, float y, uint64_t seed);
+		void update(size_t begin, size_t end, float delta);
+		void removeExpired();
+		void clear();
+
+		size_t getCount() const;
+		size_t getCapacity() const;
+		uint64_t getDroppedCount() const;
+
+		void writeSprites(FrameSnapshot& snapshot) const;
+		static bool splat(const FrameSnapshot& snapshot, Framebuffer& target, float scale, D2D1_RECT_U& bounds);
+		static bool splat(const std::vector<FrameSnapshot::Particle>& particles, Framebuffer& target, float scale,
+			const D2D1_RECT_U& clip, D2D1_RECT_U& bounds);
+		static bool getSplatRect(const FrameSnapshot::Particle& particle, uint32_t width, uint32_t height, float scale, D2D1_RECT_U& rect);
+
+		ParticleSystem(const ParticleSystem&) = delete;
+		void operator = (const ParticleSystem&) = delete;
+
+	private:
+		size_t				  _capacity;
+		std::atomic<size_t>	  _count;
+		std::atomic<uint64_t> _dropped;
+
+		std::vector<float>	  _x;
+		std::vector<float>	  _y;
+		std::vector<float>	  _velocityX;
+		std::vector<float>	  _velocityY;
+		std::vector<float>	  _life;
+		std::vector<float>	  _lifetime;
+		std::vector<uint32_t> _color;
+
+		void move(size_t from, size_t to);
+};
+
+#endif //PARTICLESYSTEM_HPP
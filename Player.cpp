@@ -1,16 +1,44 @@
 #include "Player.h"
-#include "Input.h"
+#include "Controller.h"
 #include "Logic.h"
 #include "Utils.h"
 #include "Resolution.h"
+#include "SpriteAtlas.h"
+
+const float Player::SIZE_X = 30.0f;
+const float Player::SIZE_Y = 50.0f;
+const float Player::START_X = 40.0f;
+const float Player::START_Y = HEIGHT - 200.0f;
+const float Player::JUMP_VELOCITY = -5.0f;
+
+//Dust thrown up when the player lands
+static const ParticleSystem::Burst LANDING_DUST = {
+	24, 1.5708f, 2.6f, 30.0f, 120.0f, 0.6f, D2D1::ColorF(0.76f, 0.69f, 0.5f, 0.8f)
+};
+
+//Debris flying in all directions when the player hits an obstacle
+static const ParticleSystem::Burst COLLISION_DEBRIS = {
+	96, 0.0f, 6.2832f, 80.0f, 320.0f, 0.9f, D2D1::ColorF(0.95f, 0.45f, 0.2f, 1.0f)
+};
+
+//Speed of the running animation
+static const float RUN_FRAMES_PER_SECOND = 10.0f;
 
 /// <summary>
 /// Constructor
 /// </summary>
-Player::Player(Logic* logic) : 
-	GameObj			(0, 0, 30.0f, 50.0f),
+/// <param name="logic">The game logic instance</param>
+/// <param name="controller">Decides when the player jumps</param>
+/// <param name="index">Index of the player in the logic</param>
+Player::Player(Logic* logic, Controller* controller, const uint32_t index) : 
+	GameObj			(0, 0, SIZE_X, SIZE_Y),
 	_logic				(logic),
-	_yVelocity			(0) {}
+	_controller			(controller),
+	_index				(index),
+	_survivalTime		(0.0f),
+	_yVelocity			(toScalar(0.0)),
+	_isJumping			(false),
+	_jumped				(false) {}
 
 /// <summary>
 /// Destructor
@@ -22,45 +50,51 @@ Player::~Player() = default;
 /// </summary>
 /// <param name="delta_time">Time since last update</param>
 void Player::onUpdate(double delta_time) {
+	_jumped = false;
 	if (isDead()) return;
 
-	if (Input::getInstance().isKeyDown(Input::Space) && _y >= HEIGHT) {
+	_survivalTime += static_cast<float>(delta_time);
+
+	//Everything that moves the player is computed in simulation numbers
+	const auto ground = toScalar(HEIGHT);
+	const auto dt = toScalar(delta_time);
+	const auto wasInAir = _y < ground;
+
+	if (_controller && _y >= ground && _controller->isJumpRequested(*this)) {
 		//Jump
-		_yVelocity = -5;
+		_yVelocity = toScalar(JUMP_VELOCITY);
 		_isJumping = true;
+		_jumped = true;
 	}
 
 	_y += _yVelocity;
-	if(_y >= HEIGHT && !_isJumping) {
-		_y = HEIGHT;
-		if(_yVelocity < 0) {
-			_yVelocity = 0.0f;
+	if(_y >= ground && !_isJumping) {
+		_y = ground;
+		if(_yVelocity < toScalar(0.0)) {
+			_yVelocity = toScalar(0.0);
+		}
+		if (wasInAir) {
+			emitParticles(LANDING_DUST, getX() + SIZE_X * 0.5f, HEIGHT - 2.0f);
 		}
 	} else {
-		_yVelocity -= GRAVITY * delta_time;
+		_yVelocity -= toScalar(GRAVITY) * dt;
 	}
 	_isJumping = false;
-
-	
 }
 
 /// <summary>
-/// Renders the player
+/// Renders the player, the sprite follows the state: running frames alternate on the ground
 /// </summary>
-/// <param name="render_target">Target to render to</param>
-void Player::onRender(ID2D1HwndRenderTarget* renderTarget) {
-	if (!renderTarget) return;
-
-	//Drawing the player's visuals
-	ID2D1SolidColorBrush* brush;
-	renderTarget->CreateSolidColorBrush(_color, &brush);
-
-
-	//Draw the lines
-	renderTarget->FillRectangle(getAABB(), brush);
-	//render_target->DrawRectangle(get_aabb(), brush);
-
-	Utils::safeRelease(&brush);
+/// <param name="snapshot">Frame to add the player's visuals to</param>
+void Player::onRender(FrameSnapshot& snapshot) const {
+	auto sprite = SpriteAtlas::dino_jump;
+	if (isDead()) {
+		sprite = SpriteAtlas::dino_dead;
+	} else if (_y >= toScalar(HEIGHT)) {
+		const auto frame = static_cast<uint32_t>(_survivalTime * RUN_FRAMES_PER_SECOND) % 2;
+		sprite = frame == 0 ? SpriteAtlas::dino_run_0 : SpriteAtlas::dino_run_1;
+	}
+	snapshot.addRect(getAABB(), _color, sprite);
 }
 
 /// <summary>
@@ -76,7 +110,58 @@ void Player::initialize() {
 /// <summary>
 /// Handles the collisions with other objects
 /// </summary>
-/// <param name="collided_object">Object that this object collided with</param>
-void Player::handleCollision(Transform2D* collidedObject) {
+/// <param name="collidedEntity">Entity that this object collided with</param>
+/// <param name="collidedLayer">Layer of the entity</param>
+void Player::handleCollision(Entity collidedEntity, LAYER collidedLayer) {
 	inflictDamage(1);
+
+	const auto bounds = getAABB();
+	emitParticles(COLLISION_DEBRIS, (bounds.left + bounds.right) * 0.5f, (bounds.top + bounds.bottom) * 0.5f);
+}
+
+/// <summary>
+/// Returns how long the player has been alive
+/// </summary>
+/// <returns>Time in seconds</returns>
+float Player::getSurvivalTime() const {
+	return _survivalTime;
+}
+
+/// <summary>
+/// Returns the vertical velocity of the player
+/// </summary>
+/// <returns></returns>
+float Player::getYVelocity() const {
+	return toFloat(_yVelocity);
+}
+
+/// <summary>
+/// Returns the vertical velocity of the player in simulation numbers
+/// </summary>
+/// <returns></returns>
+Scalar Player::getYVelocityScalar() const {
+	return _yVelocity;
+}
+
+/// <summary>
+/// Returns true if the player started a jump in the last update
+/// </summary>
+/// <returns></returns>
+bool Player::hasJumped() const {
+	return _jumped;
+}
+
+/// <summary>
+/// Emits a burst of particles if the game shows particles, called from the parallel player updates
+/// </summary>
+/// <param name="burst">Particles to emit</param>
+/// <param name="x">Horizontal position of the burst</param>
+/// <param name="y">Vertical position of the burst</param>
+void Player::emitParticles(const ParticleSystem::Burst& burst, const float x, const float y) const {
+	auto* particles = _logic ? _logic->getParticles() : nullptr;
+	if (!particles) return;
+
+	//The player index and the frame keep bursts apart and equal between runs, the low bits count the particles
+	const auto seed = (static_cast<uint64_t>(_index) << 48) | (static_cast<uint64_t>(_logic->getFrameCount()) << 16);
+	particles->emit(burst, x, y, seed);
 }
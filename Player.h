@@ -2,26 +2,47 @@
 #define PLAYER_HPP
 
 #include "GameObject.h"
+#include "ParticleSystem.h"
 
 #define GRAVITY	-9.81f
 
+class Controller;
 class Logic;
 
 class Player : public GameObj {
     public:
-	    explicit Player(Logic* logic);
+		//Rules of the player, shared with the event driven simulation
+		static const float SIZE_X;
+		static const float SIZE_Y;
+		static const float START_X;
+		static const float START_Y;
+		static const float JUMP_VELOCITY;
+
+	    Player(Logic* logic, Controller* controller, uint32_t index);
 	    ~Player();
 
 	    void onUpdate(double deltaTime) override;
-	    void onRender(ID2D1HwndRenderTarget* renderTarget) override;
+	    void onRender(FrameSnapshot& snapshot) const override;
 	    void initialize() override;
-	    void handleCollision(Transform2D* collidedObject) override;
+	    void handleCollision(Entity collidedEntity, LAYER collidedLayer) override;
+
+		float getSurvivalTime() const;
+		float getYVelocity() const;
+		Scalar getYVelocityScalar() const;
+		bool hasJumped() const;
 
 	private:
-		Logic* _logic;
+		Logic*		_logic;
+		Controller* _controller;
+		uint32_t	_index;
+
+		float  _survivalTime;
 
-		float  _yVelocity;
+		Scalar _yVelocity;
 		bool  _isJumping;
+		bool  _jumped;
+
+		void emitParticles(const ParticleSystem::Burst& burst, float x, float y) const;
 };
 
 #endif //PLAYER_HPP
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <sstream>
 
 #include "Quadtree.h"
+#include "Components.h"
 #include "Utils.h"
 
 /// <summary>
@@ -20,6 +21,8 @@ QuadTree::QuadTree(float x, float y, float width, float height, int level, int m
 	_height		(height),
 	_level		(level),
 	_maxLevel	(maxLevel),
+	_layers		(0),
+	_count		(0),
 	_parent		(parent)
 {
 	if (level == maxLevel) {
@@ -48,24 +51,26 @@ QuadTree::~QuadTree() {
 /// <summary>
 /// Adds a new object to the tree
 /// </summary>
-/// <param name="object">Object to add</param>
-void QuadTree::addObject(GameObj* object) {
+/// <param name="entry">Entity and bounds to add</param>
+void QuadTree::addObject(const Entry& entry) {
+	_layers |= entry.layer;
+	_count++;
+
 	if (_level == _maxLevel) {
-		_objects.push_back(object);
+		_objects.push_back(entry);
 		return;
 	}
-	if (contains(_nw, object)) {
-		_nw->addObject(object); return;
-	} else if (contains(_ne, object)) {
-		_ne->addObject(object); return;
-	} else if (contains(_sw, object)) {
-		_sw->addObject(object); return;
-	} else if (contains(_se, object)) {
-		_se->addObject(object); return;
-	}
-	if (contains(this, object)) {
-		_objects.push_back(object);
+	//Objects that no subtree contains stay here, at the root this includes objects outside the tree
+	if (contains(_nw, entry)) {
+		_nw->addObject(entry); return;
+	} else if (contains(_ne, entry)) {
+		_ne->addObject(entry); return;
+	} else if (contains(_sw, entry)) {
+		_sw->addObject(entry); return;
+	} else if (contains(_se, entry)) {
+		_se->addObject(entry); return;
 	}
+	_objects.push_back(entry);
 }
 
 /// <summary>
@@ -73,62 +78,101 @@ void QuadTree::addObject(GameObj* object) {
 /// </summary>
 /// <param name="x">Position on the x axis</param>
 /// <param name="y">Position on the y axis</param>
-/// <param name="layer">Accepted layers of the object</param>
+/// <param name="layers">Accepted layers of the object</param>
 /// <returns>List of collision objects</returns>
-vector<GameObj*> QuadTree::getObjectsAt(float x, float y, int layer) const {
-	if (_level == _maxLevel) {
-		if(layer == 0) {
-			return _objects;
+vector<QuadTree::Entry> QuadTree::getObjectsAt(float x, float y, Transform2D::LayerMask layers) const {
+	vector<Entry> returnObjects;
+	getObjectsAt(x, y, layers, returnObjects);
+	return returnObjects;
+}
+
+/// <summary>
+/// Appends the objects in the quadtree that are inside the area with the given point
+/// </summary>
+/// <param name="x">Position on the x axis</param>
+/// <param name="y">Position on the y axis</param>
+/// <param name="layers">Accepted layers of the object</param>
+/// <param name="objects">List the collision objects are appended to</param>
+void QuadTree::getObjectsAt(float x, float y, Transform2D::LayerMask layers, vector<Entry>& objects) const {
+	//Skip the whole subtree if nothing below matches
+	if (_count == 0 || !hasAnyLayer(_layers, layers)) return;
+
+	for (auto& object : _objects) {
+		if (hasAnyLayer(object.layer, layers)) {
+			objects.push_back(object);
 		}
-		return getObjectsAtLayer(layer);
 	}
 
-	vector<GameObj*> returnObjects, childReturnObjects;
-	if (!_objects.empty()) {
-		if(layer == 0) {
-			returnObjects = _objects;
-		} else {
-			returnObjects = getObjectsAtLayer(layer);
+	if (_level == _maxLevel) return;
+
+	//Only the subtree with the point can hold more objects
+	const auto* child = getChildAt(x, y);
+	if (child != nullptr) {
+		child->getObjectsAt(x, y, layers, objects);
+	}
+}
+
+/// <summary>
+/// Appends the objects in the quadtree whose bounds intersect the given area
+/// </summary>
+/// <param name="area">Area to search</param>
+/// <param name="layers">Accepted layers of the object</param>
+/// <param name="objects">List the objects are appended to</param>
+void QuadTree::getObjectsIn(const D2D1_RECT_F& area, Transform2D::LayerMask layers, vector<Entry>& objects) const {
+	if (_count == 0 || !hasAnyLayer(_layers, layers)) return;
+
+	//The root also holds the objects outside of it, so it is always searched
+	if (_parent != nullptr && !intersects(D2D1::RectF(_x, _y, _x + _width, _y + _height), area)) return;
+
+	for (auto& object : _objects) {
+		if (hasAnyLayer(object.layer, layers) && intersects(object.aabb, area)) {
+			objects.push_back(object);
 		}
 	}
 
-	//Check each subtree and add results
+	if (_level == _maxLevel) return;
+
+	_nw->getObjectsIn(area, layers, objects);
+	_ne->getObjectsIn(area, layers, objects);
+	_sw->getObjectsIn(area, layers, objects);
+	_se->getObjectsIn(area, layers, objects);
+}
+
+/// <summary>
+/// Returns the subtree containing the given point
+/// </summary>
+/// <param name="x">Position on the x axis</param>
+/// <param name="y">Position on the y axis</param>
+/// <returns>Subtree or nullptr if the point is outside the tree</returns>
+QuadTree* QuadTree::getChildAt(float x, float y) const {
 	if (x > _x + _width / 2.0f && x <= _x + _width) {
 		if (y > _y + _height / 2.0f && y <= _y + _height) {
-			childReturnObjects = _se->getObjectsAt(x, y);
-			returnObjects.insert(returnObjects.end(), childReturnObjects.begin(), childReturnObjects.end());
-			return returnObjects;
+			return _se;
 		}
 		if (y > _y && y <= _y + _height / 2.0f) {
-			childReturnObjects = _ne->getObjectsAt(x, y);
-			returnObjects.insert(returnObjects.end(), childReturnObjects.begin(), childReturnObjects.end());
-			return returnObjects;
+			return _ne;
 		}
 	} else if (x > _x && x <= _x + _width / 2.0f) {
 		if (y > _y + _height / 2.0f && y <= _y + _height) {
-			childReturnObjects = _sw->getObjectsAt(x, y);
-			returnObjects.insert(returnObjects.end(), childReturnObjects.begin(), childReturnObjects.end());
-			return returnObjects;
+			return _sw;
 		}
 		if (y > _y && y <= _y + _height / 2.0f) {
-			childReturnObjects = _nw->getObjectsAt(x, y);
-			returnObjects.insert(returnObjects.end(), childReturnObjects.begin(), childReturnObjects.end());
-			return returnObjects;
+			return _nw;
 		}
 	}
-	return returnObjects;
+	return nullptr;
 }
 
 /// <summary>
 /// Returns all the objects in the tree
 /// </summary>
 /// <returns></returns>
-vector<GameObj*> QuadTree::getAllObjects() const {
+vector<QuadTree::Entry> QuadTree::getAllObjects() const {
 	if (_level == _maxLevel) {
 		return _objects;
 	}
 
-	vector<GameObj*> returnObjects;
+	vector<Entry> returnObjects;
 	if (!_objects.empty()) {
 		returnObjects = _objects;
 	}
@@ -152,6 +196,9 @@ vector<GameObj*> QuadTree::getAllObjects() const {
 /// Clears the tree
 /// </summary>
 void QuadTree::clear() {
+	_layers = 0;
+	_count = 0;
+
 	if (_level == _maxLevel) {
 		_objects.clear();
 		return;
@@ -169,15 +216,16 @@ void QuadTree::clear() {
 /// <summary>
 /// Updates the quadtree, so that moved objects are sorted correctly
 /// </summary>
-void QuadTree::update(const std::vector<GameObj*>& objects) {
+/// <param name="world">World with the entities to sort, only entities with a transform and a collider are added</param>
+void QuadTree::update(World& world) {
 	//Only allow calling on the root
 	if (_parent != nullptr) return;
 	
 	//Rebuild the tree
 	clear();
-	for (auto* object : objects) {
-		addObject(object);
-	}
+	world.forEach<TransformComponent, ColliderComponent>([this](Entity entity, TransformComponent& transform, ColliderComponent& collider) {
+		addObject(Entry{ entity, getAABB(transform), collider.layer });
+	});
 }
 
 /// <summary>
@@ -204,49 +252,42 @@ void QuadTree::render(ID2D1HwndRenderTarget* renderTarget, ID2D1SolidColorBrush*
 }
 
 /// <summary>
-/// Returns true if the tree contains the given object, false if not
+/// Returns true if the rectangles overlap, touching edges count as overlap
 /// </summary>
-/// <param name="child">Tree to check</param>
-/// <param name="object">Object to check</param>
+/// <param name="first">First rectangle</param>
+/// <param name="second">Second rectangle</param>
 /// <returns></returns>
-bool QuadTree::contains(QuadTree *child, GameObj *object) {
-	if (child == nullptr || object == nullptr) return false;
-	//Classic aabb collision check
-	return	 !(object->getX() < child->_x ||
-				object->getY() < child->_y ||
-				object->getX() > child->_x + child->_width  ||
-				object->getY() > child->_y + child->_height ||
-				object->getX() + object->getWidth() < child->_x ||
-				object->getY() - object->getHeight() < child->_y ||
-				object->getX() + object->getWidth() > child->_x + child->_width ||
-				object->getY() - object->getHeight() > child->_y + child->_height);
+bool QuadTree::intersects(const D2D1_RECT_F& first, const D2D1_RECT_F& second) {
+	return !(first.right < second.left || first.left > second.right ||
+			 first.bottom < second.top || first.top > second.bottom);
 }
 
 /// <summary>
-/// Returns true if the object has a layer contained in the given layer
+/// Returns true if the tree contains the given object, false if not
 /// </summary>
-/// <param name="object">Object to test layer of</param>
-/// <param name="layer">Layers to check</param>
+/// <param name="child">Tree to check</param>
+/// <param name="entry">Entry to check</param>
 /// <returns></returns>
-bool QuadTree::hasAnyLayer(GameObj* object, int layer) const {
-	if (object == nullptr) return false;
-	const auto objLayer = object->getLayer();
-
-	//Test if bit is set
-	return ((objLayer & layer) == objLayer);
+bool QuadTree::contains(QuadTree *child, const Entry& entry) {
+	if (child == nullptr) return false;
+	//Classic aabb collision check
+	return	 !(entry.aabb.left < child->_x ||
+				entry.aabb.bottom < child->_y ||
+				entry.aabb.left > child->_x + child->_width  ||
+				entry.aabb.bottom > child->_y + child->_height ||
+				entry.aabb.right < child->_x ||
+				entry.aabb.top < child->_y ||
+				entry.aabb.right > child->_x + child->_width ||
+				entry.aabb.top > child->_y + child->_height);
 }
 
 /// <summary>
-/// Returns a vector of all the objects that match the given layers
+/// Returns true if any of the object layers is contained in the given layers
 /// </summary>
-/// <param name="layer">Layers to check for</param>
+/// <param name="objectLayers">Layers of an object or a subtree</param>
+/// <param name="layers">Layers to check</param>
 /// <returns></returns>
-std::vector<GameObj*> QuadTree::getObjectsAtLayer(int layer) const {
-	vector<GameObj*> returnObjects;
-	for (auto object : _objects) {
-		if (hasAnyLayer(object, layer)) {
-			returnObjects.push_back(object);
-		}
-	}
-	return returnObjects;
+bool QuadTree::hasAnyLayer(Transform2D::LayerMask objectLayers, Transform2D::LayerMask layers) const {
+	//Test if any bit is set
+	return layers == ANY_LAYER || (objectLayers & layers) != 0;
 }
@@ -3,12 +3,27 @@
 
 #include <vector>
 
-#include "GameObject.h"
+#include <d2d1.h>
+
+#include "Ecs.h"
+#include "Transform2d.h"
 
 using namespace std;
 
 class QuadTree {
     public:
+		/// <summary>
+		/// Entity stored in the tree with the bounds it had when it was added
+		/// </summary>
+		struct Entry {
+			Entity			   entity;
+			D2D1_RECT_F		   aabb;
+			Transform2D::LAYER layer;
+		};
+
+		//Matches the objects on any layer, including no_collisions
+		static const Transform2D::LayerMask ANY_LAYER = 0xFFFFFFFF;
+
 	    QuadTree(float x, 
 			float y, 
 			float width,
@@ -18,14 +33,18 @@ class QuadTree {
 			QuadTree* parent);
        ~QuadTree();
 
-	    vector<GameObj*> getObjectsAt(float x, float y, int layer = 0) const;
-	    vector<GameObj*> getAllObjects() const;
+	    vector<Entry> getObjectsAt(float x, float y, Transform2D::LayerMask layers = ANY_LAYER) const;
+	    void getObjectsAt(float x, float y, Transform2D::LayerMask layers, vector<Entry>& objects) const;
+	    void getObjectsIn(const D2D1_RECT_F& area, Transform2D::LayerMask layers, vector<Entry>& objects) const;
+	    vector<Entry> getAllObjects() const;
 
-		void addObject(GameObj *object);
+		void addObject(const Entry& entry);
 	    void clear();
-	    void update(const std::vector<GameObj*>& objects);
+	    void update(World& world);
 	    void render(ID2D1HwndRenderTarget* renderTarget, ID2D1SolidColorBrush* brush);
 
+		static bool intersects(const D2D1_RECT_F& first, const D2D1_RECT_F& second);
+
 	private:
 		float _x;
 		float _y;
@@ -35,7 +54,11 @@ class QuadTree {
 		int	_level;
 		int	_maxLevel;
 
-		vector<GameObj*> _objects;
+		vector<Entry> _objects;
+
+		//Summary of the subtree, lets queries skip subtrees without matching objects
+		Transform2D::LayerMask _layers;
+		size_t				   _count;
 
 		QuadTree * _parent;
 		QuadTree * _nw;
@@ -43,10 +66,10 @@ class QuadTree {
 		QuadTree * _sw;
 		QuadTree * _se;
 
-		bool contains(QuadTree* child, GameObj* object);
-		bool hasAnyLayer(GameObj* object, int layer) const;
+		bool contains(QuadTree* child, const Entry& entry);
+		bool hasAnyLayer(Transform2D::LayerMask objectLayers, Transform2D::LayerMask layers) const;
 
-		std::vector<GameObj*> getObjectsAtLayer(int layer) const;
+		QuadTree* getChildAt(float x, float y) const;
 };
 
 #endif //QUADTREE_HPP
@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "QuantileSketch.h"
+
+//Values up to this are counted as zero
+static const double MIN_VALUE = 1e-9;
+
+/// <summary>
+/// Constructor
+/// </summary>
+/// <param name="relativeError">Largest relative error of the quantiles</param>
+QuantileSketch::QuantileSketch(const double relativeError) :
+	_gamma		((1.0 + relativeError) / (1.0 - relativeError)),
+	_logGamma	(std::log(_gamma)),
+	_offset		(0),
+	_zeroCount	(0),
+	_count		(0),
+	_sum		(0.0),
+	_min		(std::numeric_limits<double>::max()),
+	_max		(0.0) {}
+
+/// <summary>
+/// Destructor
+/// </summary>
+QuantileSketch::~QuantileSketch() = default;
+
+/// <summary>
+/// Counts a value, negative values are counted as zero
+/// </summary>
+/// <param name="value">Value to add</param>
+void QuantileSketch::add(const double value) {
+	_count++;
+	_sum += value;
+	_min = std::min(_min, value);
+	_max = std::max(_max, value);
+
+	if (value <= MIN_VALUE) {
+		_zeroCount++;
+		return;
+	}
+
+	//Grow the buckets in both directions as needed
+	const auto bucket = getBucket(value);
+	if (_buckets.empty()) {
+		_offset = bucket;
+	}
+	if (bucket < _offset) {
+		_buckets.insert(_buckets.begin(), _offset - bucket, 0);
+		_offset = bucket;
+	}
+	if (bucket - _offset >= static_cast<int>(_buckets.size())) {
+		_buckets.resize(bucket - _offset + 1, 0);
+	}
+	_buckets[bucket - _offset]++;
+}
+
+/// <summary>
+/// Adds all values of another sketch, both need the same relative error
+/// </summary>
+/// <param name="other">Sketch to add</param>
+void QuantileSketch::merge(const QuantileSketch& other) {
+	if (other._count == 0) return;
+
+	_count += other._count;
+	_sum += other._sum;
+	_min = std::min(_min, other._min);
+	_max = std::max(_max, other._max);
+	_zeroCount += other._zeroCount;
+
+	if (other._buckets.empty()) return;
+	if (_buckets.empty()) {
+		_buckets = other._buckets;
+		_offset = other._offset;
+		return;
+	}
+
+	const auto first = std::min(_offset, other._offset);
+	const auto last = std::max(_offset + static_cast<int>(_buckets.size()), other._offset + static_cast<int>(other._buckets.size()));
+	if (first < _offset) {
+		_buckets.insert(_buckets.begin(), _offset - first, 0);
+		_offset = first;
+	}
+	_buckets.resize(last - _offset, 0);
+
+	for (size_t i = 0; i < other._buckets.size(); i++) {
+		_buckets[other._offset - _offset + i] += other._buckets[i];
+	}
+}
+
+/// <summary>
+/// Removes all values
+/// </summary>
+void QuantileSketch::clear() {
+	_buckets.clear();
+	_offset = 0;
+	_zeroCount = 0;
+	_count = 0;
+	_sum = 0.0;
+	_min = std::numeric_limits<double>::max();
+	_max = 0.0;
+}
+
+/// <summary>
+/// Returns the number of values
+/// </summary>
+/// <returns></returns>
+uint64_t QuantileSketch::getCount() const {
+	return _count;
+}
+
+/// <summary>
+/// Returns the smallest value, exact
+/// </summary>
+/// <returns></returns>
+double QuantileSketch::getMin() const {
+	return _count > 0 ? _min : 0.0;
+}
+
+/// <summary>
+/// Returns the largest value, exact
+/// </summary>
+/// <returns></returns>
+double QuantileSketch::getMax() const {
+	return _max;
+}
+
+/// <summary>
+/// Returns the mean of the values, exact
+/// </summary>
+/// <returns></returns>
+double QuantileSketch::getMean() const {
+	return _count > 0 ? _sum / _count : 0.0;
+}
+
+/// <summary>
+/// Returns the value below which the given share of the values lies
+/// </summary>
+/// <param name="quantile">Share between 0 and 1</param>
+/// <returns></returns>
+double QuantileSketch::getQuantile(const double quantile) const {
+	if (_count == 0) return 0.0;
+
+	const auto rank = static_cast<uint64_t>(std::max(0.0, std::min(1.0, quantile)) * (_count - 1));
+	if (rank < _zeroCount) return std::max(0.0, getMin());
+
+	auto seen = _zeroCount;
+	for (size_t i = 0; i < _buckets.size(); i++) {
+		seen += _buckets[i];
+		if (seen > rank) {
+			//The estimate can not leave the range of the values
+			return std::max(getMin(), std::min(_max, getBucketValue(_offset + static_cast<int>(i))));
+		}
+	}
+	return _max;
+}
+
+/// <summary>
+/// Returns the bucket of a value, bucket i holds the values in (gamma^(i-1), gamma^i]
+/// </summary>
+/// <param name="value">Positive value</param>
+/// <returns></returns>
+int QuantileSketch::getBucket(const double value) const {
+	return static_cast<int>(std::ceil(std::log(value) / _logGamma));
+}
+
+/// <summary>
+/// Returns the value that represents a bucket with the smallest relative error to all values in it
+/// </summary>
+/// <param name="bucket">Index of the bucket</param>
+/// <returns></returns>
+double QuantileSketch::getBucketValue(const int bucket) const {
+	return 2.0 * std::pow(_gamma, bucket) / (_gamma + 1.0);
+}
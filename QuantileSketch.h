@@ -0,0 +1,43 @@
+#ifndef QUANTILESKETCH_HPP
+#define QUANTILESKETCH_HPP
+
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// Streaming summary of a distribution of positive values with a fixed relative error.
+/// Values are counted in buckets whose bounds grow by a constant factor, so the memory only depends
+/// on the range of the values and not on their number. Sketches of the same accuracy can be merged
+/// </summary>
+class QuantileSketch {
+	public:
+		explicit QuantileSketch(double relativeError = 0.01);
+		~QuantileSketch();
+
+		void add(double value);
+		void merge(const QuantileSketch& other);
+		void clear();
+
+		uint64_t getCount() const;
+		double getMin() const;
+		double getMax() const;
+		double getMean() const;
+		double getQuantile(double quantile) const;
+
+	private:
+		double _gamma;
+		double _logGamma;
+
+		std::vector<uint64_t> _buckets;
+		int					  _offset;
+		uint64_t			  _zeroCount;
+		uint64_t			  _count;
+		double				  _sum;
+		double				  _min;
+		double				  _max;
+
+		int getBucket(double value) const;
+		double getBucketValue(int bucket) const;
+};
+
+#endif //QUANTILESKETCH_HPP
@@ -0,0 +1,101 @@
+#ifndef SCALAR_HPP
+#define SCALAR_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/// <summary>
+/// Number type of the simulation.
+/// Define DINO_FIXED_POINT to simulate in 16.16 fixed point, which gives bit identical results
+/// on every compiler, optimization level and SIMD width. Otherwise the simulation uses float
+/// </summary>
+#ifdef DINO_FIXED_POINT
+
+/// <summary>
+/// Signed 16.16 fixed point number, products are rounded towards negative infinity
+/// </summary>
+class Fixed {
+	public:
+		static const int FRACTION_BITS = 16;
+		static const int32_t ONE = 1 << FRACTION_BITS;
+
+		Fixed() :
+			_raw	(0) {}
+
+		/// <summary>
+		/// Creates a number from its raw representation
+		/// </summary>
+		/// <param name="raw">Value times ONE</param>
+		/// <returns></returns>
+		static Fixed fromRaw(const int32_t raw) {
+			Fixed value;
+			value._raw = raw;
+			return value;
+		}
+
+		/// <summary>
+		/// Converts a floating point value, rounding to the nearest representable number
+		/// </summary>
+		/// <param name="value">Value to convert</param>
+		/// <returns></returns>
+		static Fixed fromDouble(const double value) {
+			return fromRaw(static_cast<int32_t>(std::floor(value * ONE + 0.5)));
+		}
+
+		int32_t raw() const { return _raw; }
+		double toDouble() const { return static_cast<double>(_raw) / ONE; }
+
+		Fixed operator - () const { return fromRaw(-_raw); }
+		Fixed operator + (const Fixed other) const { return fromRaw(_raw + other._raw); }
+		Fixed operator - (const Fixed other) const { return fromRaw(_raw - other._raw); }
+		Fixed operator * (const Fixed other) const {
+			return fromRaw(static_cast<int32_t>((static_cast<int64_t>(_raw) * other._raw) >> FRACTION_BITS));
+		}
+		Fixed operator / (const Fixed other) const {
+			return fromRaw(static_cast<int32_t>((static_cast<int64_t>(_raw) << FRACTION_BITS) / other._raw));
+		}
+
+		Fixed& operator += (const Fixed other) { _raw += other._raw; return *this; }
+		Fixed& operator -= (const Fixed other) { _raw -= other._raw; return *this; }
+		Fixed& operator *= (const Fixed other) { return *this = *this * other; }
+
+		bool operator == (const Fixed other) const { return _raw == other._raw; }
+		bool operator != (const Fixed other) const { return _raw != other._raw; }
+		bool operator < (const Fixed other) const { return _raw < other._raw; }
+		bool operator <= (const Fixed other) const { return _raw <= other._raw; }
+		bool operator > (const Fixed other) const { return _raw > other._raw; }
+		bool operator >= (const Fixed other) const { return _raw >= other._raw; }
+
+	private:
+		int32_t _raw;
+};
+
+typedef Fixed Scalar;
+
+inline Scalar toScalar(const double value) { return Fixed::fromDouble(value); }
+inline float toFloat(const Scalar value) { return static_cast<float>(value.toDouble()); }
+inline uint32_t scalarBits(const Scalar value) { return static_cast<uint32_t>(value.raw()); }
+
+#else
+
+typedef float Scalar;
+
+inline Scalar toScalar(const double value) { return static_cast<float>(value); }
+inline float toFloat(const Scalar value) { return value; }
+
+/// <summary>
+/// Returns the bits of the value, used to hash the state
+/// </summary>
+/// <param name="value">Value to read</param>
+/// <returns></returns>
+inline uint32_t scalarBits(const Scalar value) {
+	uint32_t bits;
+	static_assert(sizeof(bits) == sizeof(value), "Scalar has to be 32 bits");
+	std::memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+#endif
+
+#endif //SCALAR_HPP
@@ -0,0 +1,29 @@
+#include <algorithm>
+
+#include "ScriptedController.h"
+#include "Logic.h"
+
+/// <summary>
+/// Constructor
+/// </summary>
+/// <param name="logic">Logic whose frame count is followed</param>
+/// <param name="jumpFrames">Frames on which to jump</param>
+ScriptedController::ScriptedController(const Logic& logic, std::vector<uint32_t> jumpFrames) :
+	_logic		(logic),
+	_jumpFrames	(std::move(jumpFrames)) {
+	std::sort(_jumpFrames.begin(), _jumpFrames.end());
+}
+
+/// <summary>
+/// Destructor
+/// </summary>
+ScriptedController::~ScriptedController() = default;
+
+/// <summary>
+/// Returns true if the current frame is on the list
+/// </summary>
+/// <param name="player">Player asking for its next action</param>
+/// <returns></returns>
+bool ScriptedController::isJumpRequested(const Player& player) {
+	return std::binary_search(_jumpFrames.begin(), _jumpFrames.end(), _logic.getFrameCount());
+}
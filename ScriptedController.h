@@ -0,0 +1,26 @@
+#ifndef SCRIPTEDCONTROLLER_HPP
+#define SCRIPTEDCONTROLLER_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "Controller.h"
+
+class Logic;
+
+/// <summary>
+/// Jumps on a fixed list of frames, used to replay the same input in different simulation modes
+/// </summary>
+class ScriptedController : public Controller {
+	public:
+		ScriptedController(const Logic& logic, std::vector<uint32_t> jumpFrames);
+		~ScriptedController();
+
+		bool isJumpRequested(const Player& player) override;
+
+	private:
+		const Logic&		  _logic;
+		std::vector<uint32_t> _jumpFrames;
+};
+
+#endif //SCRIPTEDCONTROLLER_HPP
@@ -0,0 +1,57 @@
+#ifndef SHAREDENVIRONMENT_HPP
+#define SHAREDENVIRONMENT_HPP
+
+#include <cstdint>
+
+#include "Observation.h"
+
+/// <summary>
+/// Layout of the shared memory of the environment server, controller processes include this header.
+///
+/// The memory named "Local\<name>" starts with an EnvironmentHeader followed by one EnvironmentSlot per instance.
+/// A step works in lock step: the controller writes the actions of all slots, increments requestSequence
+/// and signals the event "Local\<name>.request". The server steps every instance, writes the observations,
+/// copies requestSequence to responseSequence and signals "Local\<name>.response".
+/// Setting shutdown and signalling the request event stops the server.
+/// If frameWidth is not zero, a grayscale frame per instance follows at framesOffset, shaped [instance][y][x]
+/// </summary>
+static const uint32_t ENVIRONMENT_MAGIC = 0x564E4544;
+static const uint32_t ENVIRONMENT_VERSION = 2;
+
+enum ENVIRONMENT_ACTION : uint32_t {
+	action_none = 0,
+	action_jump = 1
+};
+
+struct EnvironmentHeader {
+	uint32_t		  magic;
+	uint32_t		  version;
+	uint32_t		  instanceCount;
+	uint32_t		  slotSize;
+	volatile uint32_t requestSequence;
+	volatile uint32_t responseSequence;
+	volatile uint32_t shutdown;
+	uint32_t		  frameWidth;
+	uint32_t		  frameHeight;
+	uint32_t		  reserved;
+	uint64_t		  framesOffset;
+};
+
+/// <summary>
+/// State of one game instance, every slot has its own cache lines
+/// </summary>
+struct alignas(64) EnvironmentSlot {
+	//Written by the controller
+	uint32_t	action;
+	uint32_t	reset;
+	uint64_t	seed;
+
+	//Written by the server
+	uint32_t	frame;
+	uint32_t	done;
+	float		score;
+	uint32_t	reserved;
+	Observation observation;
+};
+
+#endif //SHAREDENVIRONMENT_HPP
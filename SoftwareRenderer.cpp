@@ -0,0 +1,210 @@
+#include <algorithm>
+
+#include "SoftwareRenderer.h"
+#include "JobSystem.h"
+#include "ParticleSystem.h"
+
+/// <summary>
+/// Constructor
+/// </summary>
+/// <param name="width">Width of the picture in pixels</param>
+/// <param name="height">Height of the picture in pixels</param>
+SoftwareRenderer::SoftwareRenderer(const uint32_t width, const uint32_t height) :
+	_frame			(width, height),
+	_background		(width, height),
+	_atlas			(nullptr),
+	_scale			(static_cast<float>(height) / HEIGHT),
+	_sky			(Framebuffer::toPixel(D2D1::ColorF(D2D1::ColorF::LightSkyBlue))),
+	_tilesX			((width + TILE_SIZE - 1) / TILE_SIZE),
+	_time			(0.0f),
+	_damage			(width, height, _scale),
+	_incremental	(false) {
+	const auto tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+	_tiles.resize(static_cast<size_t>(_tilesX) * tilesY);
+
+	for (uint32_t y = 0; y < tilesY; y++) {
+		for (uint32_t x = 0; x < _tilesX; x++) {
+			_tiles[y * _tilesX + x].bounds = D2D1::RectU(
+				x * TILE_SIZE,
+				y * TILE_SIZE,
+				std::min(width, (x + 1) * TILE_SIZE),
+				std::min(height, (y + 1) * TILE_SIZE));
+		}
+	}
+
+	_graph.addParallelTask([this]() { return _tiles.size(); }, 1, [this](size_t begin, size_t end) {
+		for (auto tile = begin; tile < end; tile++) {
+			drawTile(_tiles[tile]);
+		}
+	});
+}
+
+/// <summary>
+/// Destructor
+/// </summary>
+SoftwareRenderer::~SoftwareRenderer() = default;
+
+/// <summary>
+/// Sets the atlas the sprites are drawn from, without one every rectangle is filled with its color
+/// </summary>
+/// <param name="atlas">Loaded atlas that outlives the renderer, or nullptr</param>
+void SoftwareRenderer::setAtlas(const SpriteAtlas* atlas) {
+	_atlas = atlas;
+}
+
+/// <summary>
+/// Switches between drawing whole frames and drawing only what changed since the last frame
+/// </summary>
+/// <param name="incremental">True to draw only the damaged pixels</param>
+void SoftwareRenderer::setIncremental(const bool incremental) {
+	_incremental = incremental;
+	_damage.invalidate();
+}
+
+/// <summary>
+/// Draws a frame of the game: the sky, the background layers, the sprites and rectangles and the particles
+/// </summary>
+/// <param name="snapshot">Frame to draw</param>
+void SoftwareRenderer::render(const FrameSnapshot& snapshot) {
+	findClips(snapshot);
+	bin(snapshot);
+	_graph.execute(JobSystem::getInstance());
+}
+
+/// <summary>
+/// Returns the picture of the last rendered frame
+/// </summary>
+/// <returns></returns>
+const Framebuffer& SoftwareRenderer::getFrame() const {
+	return _frame;
+}
+
+/// <summary>
+/// Returns the damage of the last frame drawn in incremental mode
+/// </summary>
+/// <returns></returns>
+const DamageTracker& SoftwareRenderer::getDamage() const {
+	return _damage;
+}
+
+/// <summary>
+/// Returns the number of tiles the picture is split into
+/// </summary>
+/// <returns></returns>
+size_t SoftwareRenderer::getTileCount() const {
+	return _tiles.size();
+}
+
+/// <summary>
+/// Decides which pixels of each tile get drawn, all of them or the damaged ones in incremental mode
+/// </summary>
+/// <param name="snapshot">Frame to draw</param>
+void SoftwareRenderer::findClips(const FrameSnapshot& snapshot) {
+	if (_incremental) {
+		_damage.begin();
+		_damage.addSnapshot(snapshot, _background);
+		_damage.end();
+	}
+
+	for (auto& tile : _tiles) {
+		tile.clips.clear();
+		if (!_incremental) {
+			tile.clips.push_back(tile.bounds);
+			continue;
+		}
+
+		for (const auto& rect : _damage.getRects()) {
+			const auto clip = Framebuffer::intersect(rect, tile.bounds);
+			if (clip.left < clip.right && clip.top < clip.bottom) {
+				tile.clips.push_back(clip);
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Scales the rectangles of a snapshot and sorts them and the particles into the tiles they touch,
+/// tiles that draw nothing are left out
+/// </summary>
+/// <param name="snapshot">Frame to draw</param>
+void SoftwareRenderer::bin(const FrameSnapshot& snapshot) {
+	for (auto& tile : _tiles) {
+		tile.items.clear();
+		tile.particles.clear();
+	}
+	_items.clear();
+	_time = snapshot.time;
+
+	const auto useAtlas = _atlas && _atlas->isLoaded();
+	for (const auto& rect : snapshot.rects) {
+		Item item;
+		item.rect = D2D1::RectF(rect.rect.left * _scale, rect.rect.top * _scale, rect.rect.right * _scale, rect.rect.bottom * _scale);
+		item.color = Framebuffer::toPixel(rect.color);
+		item.sprite = useAtlas ? rect.sprite : FrameSnapshot::NO_SPRITE;
+
+		const auto tiles = getTileRange(Framebuffer::toPixelRect(item.rect, _frame.getWidth(), _frame.getHeight()));
+		for (auto y = tiles.top; y < tiles.bottom; y++) {
+			for (auto x = tiles.left; x < tiles.right; x++) {
+				auto& tile = _tiles[y * _tilesX + x];
+				if (!tile.clips.empty()) {
+					tile.items.push_back(static_cast<uint32_t>(_items.size()));
+				}
+			}
+		}
+		_items.push_back(item);
+	}
+
+	//Particles are copied, so a tile reads its own particles one after another
+	D2D1_RECT_U square;
+	for (const auto& particle : snapshot.particles) {
+		if (!ParticleSystem::getSplatRect(particle, _frame.getWidth(), _frame.getHeight(), _scale, square)) continue;
+
+		const auto tiles = getTileRange(square);
+		for (auto y = tiles.top; y < tiles.bottom; y++) {
+			for (auto x = tiles.left; x < tiles.right; x++) {
+				auto& tile = _tiles[y * _tilesX + x];
+				if (!tile.clips.empty()) {
+					tile.particles.push_back(particle);
+				}
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Returns the tiles a rectangle of pixels touches
+/// </summary>
+/// <param name="pixels">Pixels inside the picture</param>
+/// <returns>Columns and rows of the tiles, right and bottom are exclusive</returns>
+D2D1_RECT_U SoftwareRenderer::getTileRange(const D2D1_RECT_U& pixels) const {
+	if (pixels.left >= pixels.right || pixels.top >= pixels.bottom) return D2D1::RectU();
+
+	return D2D1::RectU(
+		pixels.left / TILE_SIZE,
+		pixels.top / TILE_SIZE,
+		(pixels.right - 1) / TILE_SIZE + 1,
+		(pixels.bottom - 1) / TILE_SIZE + 1);
+}
+
+/// <summary>
+/// Draws everything inside the clips of a tile, tiles never share pixels so they can be drawn at the same time
+/// </summary>
+/// <param name="tile">Tile to draw</param>
+void SoftwareRenderer::drawTile(const Tile& tile) {
+	for (const auto& clip : tile.clips) {
+		_frame.clearRect(clip, _sky);
+		_background.draw(_frame, _time, clip);
+
+		for (const auto index : tile.items) {
+			const auto& item = _items[index];
+			if (item.sprite != FrameSnapshot::NO_SPRITE) {
+				_atlas->blit(_frame, item.sprite, item.rect, clip);
+			} else {
+				_frame.fillRect(item.rect, item.color, clip);
+			}
+		}
+
+		D2D1_RECT_U particleBounds;
+		ParticleSystem::splat(tile.particles, _frame, _scale, clip, particleBounds);
+	}
+}
@@ -0,0 +1,81 @@
+#ifndef SOFTWARERENDERER_HPP
+#define SOFTWARERENDERER_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "DamageTracker.h"
+#include "FrameSnapshot.h"
+#include "Framebuffer.h"
+#include "ParallaxBackground.h"
+#include "Resolution.h"
+#include "SpriteAtlas.h"
+#include "TaskGraph.h"
+
+/// <summary>
+/// Draws snapshots on the CPU into a framebuffer, for machines without a usable GPU and for captures.
+/// The picture may be larger than the game, everything is scaled by the ratio of the heights.
+/// The picture is split into square tiles that fit into the L2 cache, the drawables are sorted into the tiles
+/// they touch and the tiles are drawn in parallel by the job system, each one from the sky up to the particles.
+/// In incremental mode only the pixels damaged since the last frame are drawn, the rest of the picture is kept
+/// </summary>
+class SoftwareRenderer {
+	public:
+		//128 x 128 pixels are 64 KB, which leaves room in L2 for the strips and sprites they are blended from
+		static const uint32_t TILE_SIZE = 128;
+
+		SoftwareRenderer(uint32_t width = WIDTH, uint32_t height = HEIGHT);
+		~SoftwareRenderer();
+
+		void setAtlas(const SpriteAtlas* atlas);
+		void setIncremental(bool incremental);
+		void render(const FrameSnapshot& snapshot);
+		const Framebuffer& getFrame() const;
+		const DamageTracker& getDamage() const;
+		size_t getTileCount() const;
+
+		SoftwareRenderer(const SoftwareRenderer&) = delete;
+		void operator = (const SoftwareRenderer&) = delete;
+
+	private:
+		/// <summary>
+		/// Rectangle of the snapshot scaled to the picture
+		/// </summary>
+		struct Item {
+			D2D1_RECT_F rect;
+			uint32_t	color;
+			uint32_t	sprite;
+		};
+
+		/// <summary>
+		/// Area of the picture and everything drawn into it, in the order of the snapshot
+		/// </summary>
+		struct Tile {
+			D2D1_RECT_U							 bounds;
+			std::vector<D2D1_RECT_U>			 clips;
+			std::vector<uint32_t>				 items;
+			std::vector<FrameSnapshot::Particle> particles;
+		};
+
+		Framebuffer		   _frame;
+		ParallaxBackground _background;
+		const SpriteAtlas* _atlas;
+		float			   _scale;
+		uint32_t		   _sky;
+
+		uint32_t		   _tilesX;
+		std::vector<Tile>  _tiles;
+		std::vector<Item>  _items;
+		float			   _time;
+		TaskGraph		   _graph;
+
+		DamageTracker	   _damage;
+		bool			   _incremental;
+
+		void findClips(const FrameSnapshot& snapshot);
+		void bin(const FrameSnapshot& snapshot);
+		D2D1_RECT_U getTileRange(const D2D1_RECT_U& pixels) const;
+		void drawTile(const Tile& tile);
+};
+
+#endif //SOFTWARERENDERER_HPP
@@ -0,0 +1,388 @@
+#include <algorithm>
+#include <cstring>
+
+#include "SpriteAtlas.h"
+#include "Utils.h"
+
+//Identifies atlas files
+static const char ATLAS_MAGIC[4] = { 'D', 'A', 'T', 'L' };
+
+//Size of the painted atlas
+static const uint32_t DEFAULT_WIDTH = 256;
+static const uint32_t DEFAULT_HEIGHT = 64;
+
+//Pixels per step of a scaled blit, gathered on the stack before they are blended
+static const uint32_t BLIT_CHUNK = 256;
+
+static_assert(sizeof(SpriteAtlas::FileHeader) == 24, "Atlas file header has to stay 24 bytes");
+static_assert(sizeof(SpriteAtlas::Sprite) == 16, "Atlas sprites have to stay 16 bytes");
+
+/// <summary>
+/// Constructor
+/// </summary>
+SpriteAtlas::SpriteAtlas() :
+	_file		(INVALID_HANDLE_VALUE),
+	_mapping	(nullptr),
+	_view		(nullptr),
+	_sprites	(nullptr),
+	_pixels		(nullptr),
+	_width		(0),
+	_height		(0),
+	_bitmap		(nullptr) {}
+
+/// <summary>
+/// Destructor
+/// </summary>
+SpriteAtlas::~SpriteAtlas() {
+	close();
+}
+
+/// <summary>
+/// Maps an atlas file into memory and checks that every sprite lies inside its pixels
+/// </summary>
+/// <param name="path">Path of the atlas file</param>
+/// <returns>HRESULT</returns>
+HRESULT SpriteAtlas::open(const char* path) {
+	close();
+
+	_file = CreateFile(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	auto hr = _file != INVALID_HANDLE_VALUE ? S_OK : E_FAIL;
+
+	LARGE_INTEGER size;
+	if (SUCCEEDED(hr)) {
+		hr = GetFileSizeEx(_file, &size) && size.QuadPart >= static_cast<LONGLONG>(sizeof(FileHeader)) ? S_OK : E_INVALIDARG;
+	}
+	if (SUCCEEDED(hr)) {
+		_mapping = CreateFileMapping(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		hr = _mapping ? S_OK : E_FAIL;
+	}
+	if (SUCCEEDED(hr)) {
+		_view = MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+		hr = _view ? S_OK : E_FAIL;
+	}
+	if (SUCCEEDED(hr)) {
+		//Only accept files that hold every sprite and pixel the header promises
+		const auto& header = *static_cast<const FileHeader*>(_view);
+		const auto spritesEnd = sizeof(FileHeader) + static_cast<uint64_t>(header.spriteCount) * sizeof(Sprite);
+		const auto pixelsEnd = header.pixelOffset + static_cast<uint64_t>(header.width) * header.height * sizeof(uint32_t);
+
+		if (memcmp(header.magic, ATLAS_MAGIC, sizeof(ATLAS_MAGIC)) != 0 ||
+			header.version != FILE_VERSION ||
+			header.spriteCount < sprite_count ||
+			header.pixelOffset % 16 != 0 ||
+			header.pixelOffset < spritesEnd ||
+			static_cast<uint64_t>(size.QuadPart) < pixelsEnd) {
+			hr = E_INVALIDARG;
+		}
+	}
+	if (SUCCEEDED(hr)) {
+		const auto& header = *static_cast<const FileHeader*>(_view);
+		_sprites = reinterpret_cast<const Sprite*>(static_cast<const char*>(_view) + sizeof(FileHeader));
+		_pixels = reinterpret_cast<const uint32_t*>(static_cast<const char*>(_view) + header.pixelOffset);
+		_width = header.width;
+		_height = header.height;
+
+		for (uint32_t i = 0; i < sprite_count; i++) {
+			const auto& sprite = _sprites[i];
+			if (sprite.width == 0 || sprite.height == 0 ||
+				static_cast<uint64_t>(sprite.x) + sprite.width > _width ||
+				static_cast<uint64_t>(sprite.y) + sprite.height > _height) {
+				hr = E_INVALIDARG;
+			}
+		}
+	}
+	if (FAILED(hr)) {
+		close();
+	}
+	return hr;
+}
+
+/// <summary>
+/// Paints the sprites of the game, used when there is no atlas file
+/// </summary>
+void SpriteAtlas::createDefault() {
+	close();
+
+	_paintedSprites.resize(sprite_count);
+	_paintedSprites[dino_run_0] = Sprite{ 0, 0, 30, 50 };
+	_paintedSprites[dino_run_1] = Sprite{ 32, 0, 30, 50 };
+	_paintedSprites[dino_jump] = Sprite{ 64, 0, 30, 50 };
+	_paintedSprites[dino_dead] = Sprite{ 96, 0, 30, 50 };
+	_paintedSprites[cactus_normal] = Sprite{ 128, 0, 25, 35 };
+	_paintedSprites[cactus_wide] = Sprite{ 155, 0, 50, 35 };
+	_paintedSprites[cactus_high] = Sprite{ 207, 0, 25, 50 };
+
+	Framebuffer atlas(DEFAULT_WIDTH, DEFAULT_HEIGHT);
+	for (uint32_t pose = dino_run_0; pose <= dino_dead; pose++) {
+		paintDino(atlas, _paintedSprites[pose], static_cast<SPRITE>(pose));
+	}
+	paintCactus(atlas, _paintedSprites[cactus_normal], 9, 35);
+	paintCactus(atlas, _paintedSprites[cactus_wide], 9, 35);
+	paintCactus(atlas, Sprite{ _paintedSprites[cactus_wide].x + 25, 0, 25, 35 }, 9, 28);
+	paintCactus(atlas, _paintedSprites[cactus_high], 9, 50);
+
+	_paintedPixels.assign(atlas.getPixels(), atlas.getPixels() + static_cast<size_t>(DEFAULT_WIDTH) * DEFAULT_HEIGHT);
+	_sprites = _paintedSprites.data();
+	_pixels = _paintedPixels.data();
+	_width = DEFAULT_WIDTH;
+	_height = DEFAULT_HEIGHT;
+}
+
+/// <summary>
+/// Writes the atlas into a file that open maps without decoding
+/// </summary>
+/// <param name="path">Path of the atlas file</param>
+/// <returns>HRESULT</returns>
+HRESULT SpriteAtlas::save(const char* path) const {
+	if (!isLoaded()) return E_UNEXPECTED;
+
+	FileHeader header;
+	memcpy(header.magic, ATLAS_MAGIC, sizeof(ATLAS_MAGIC));
+	header.version = FILE_VERSION;
+	header.width = _width;
+	header.height = _height;
+	header.spriteCount = sprite_count;
+	//The pixels start at a multiple of 16 bytes, so they can be loaded with aligned SSE instructions
+	header.pixelOffset = static_cast<uint32_t>((sizeof(FileHeader) + sprite_count * sizeof(Sprite) + 15) & ~static_cast<size_t>(15));
+
+	auto file = CreateFile(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	auto hr = file != INVALID_HANDLE_VALUE ? S_OK : E_FAIL;
+
+	if (SUCCEEDED(hr)) {
+		const char padding[16] = {};
+		const auto spriteBytes = static_cast<DWORD>(sprite_count * sizeof(Sprite));
+		const auto paddingBytes = static_cast<DWORD>(header.pixelOffset - sizeof(FileHeader) - spriteBytes);
+		const auto pixelBytes = static_cast<DWORD>(static_cast<size_t>(_width) * _height * sizeof(uint32_t));
+
+		DWORD written;
+		if (!WriteFile(file, &header, sizeof(header), &written, nullptr) || written != sizeof(header) ||
+			!WriteFile(file, _sprites, spriteBytes, &written, nullptr) || written != spriteBytes ||
+			!WriteFile(file, padding, paddingBytes, &written, nullptr) || written != paddingBytes ||
+			!WriteFile(file, _pixels, pixelBytes, &written, nullptr) || written != pixelBytes) {
+			hr = E_FAIL;
+		}
+	}
+
+	if (file != INVALID_HANDLE_VALUE) {
+		CloseHandle(file);
+	}
+	return hr;
+}
+
+/// <summary>
+/// Unmaps the atlas file or frees the painted atlas
+/// </summary>
+void SpriteAtlas::close() {
+	discardBitmap();
+
+	if (_view) {
+		UnmapViewOfFile(_view);
+	}
+	if (_mapping) {
+		CloseHandle(_mapping);
+	}
+	if (_file != INVALID_HANDLE_VALUE) {
+		CloseHandle(_file);
+	}
+	_file = INVALID_HANDLE_VALUE;
+	_mapping = nullptr;
+	_view = nullptr;
+	_sprites = nullptr;
+	_pixels = nullptr;
+	_width = 0;
+	_height = 0;
+	_paintedSprites.clear();
+	_paintedPixels.clear();
+}
+
+/// <summary>
+/// Returns true if a file was opened or the default atlas was painted
+/// </summary>
+/// <returns></returns>
+bool SpriteAtlas::isLoaded() const {
+	return _pixels != nullptr;
+}
+
+/// <summary>
+/// Returns the width of the atlas in pixels
+/// </summary>
+/// <returns></returns>
+uint32_t SpriteAtlas::getWidth() const {
+	return _width;
+}
+
+/// <summary>
+/// Returns the height of the atlas in pixels
+/// </summary>
+/// <returns></returns>
+uint32_t SpriteAtlas::getHeight() const {
+	return _height;
+}
+
+/// <summary>
+/// Returns the area of a sprite, the atlas has to be loaded
+/// </summary>
+/// <param name="sprite">Index of the sprite</param>
+/// <returns></returns>
+const SpriteAtlas::Sprite& SpriteAtlas::getSprite(const uint32_t sprite) const {
+	return _sprites[sprite];
+}
+
+/// <summary>
+/// Returns the area of a sprite for drawing it from the bitmap of the atlas
+/// </summary>
+/// <param name="sprite">Index of the sprite</param>
+/// <returns></returns>
+D2D1_RECT_F SpriteAtlas::getSourceRect(const uint32_t sprite) const {
+	const auto& area = _sprites[sprite];
+	return D2D1::RectF(
+		static_cast<float>(area.x),
+		static_cast<float>(area.y),
+		static_cast<float>(area.x + area.width),
+		static_cast<float>(area.y + area.height));
+}
+
+/// <summary>
+/// Uploads the atlas into a bitmap of a render target, once per device
+/// </summary>
+/// <param name="renderTarget">Render target the sprites are drawn to</param>
+/// <returns>HRESULT</returns>
+HRESULT SpriteAtlas::createBitmap(ID2D1RenderTarget* renderTarget) {
+	discardBitmap();
+	if (!isLoaded()) return E_UNEXPECTED;
+
+	return renderTarget->CreateBitmap(
+		D2D1::SizeU(_width, _height),
+		_pixels,
+		_width * sizeof(uint32_t),
+		D2D1::BitmapProperties(D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED)),
+		&_bitmap
+	);
+}
+
+/// <summary>
+/// Releases the bitmap of the atlas
+/// </summary>
+void SpriteAtlas::discardBitmap() {
+	Utils::safeRelease(&_bitmap);
+}
+
+/// <summary>
+/// Returns the bitmap of the atlas
+/// </summary>
+/// <returns>Bitmap or nullptr if it was not created</returns>
+ID2D1Bitmap* SpriteAtlas::getBitmap() const {
+	return _bitmap;
+}
+
+/// <summary>
+/// Blends a sprite over a framebuffer, stretched to a rectangle with the nearest pixels.
+/// Rows that need no stretching are blended straight from the atlas, four pixels per SSE step
+/// </summary>
+/// <param name="target">Framebuffer to draw into</param>
+/// <param name="sprite">Index of the sprite</param>
+/// <param name="rect">Rectangle in the pixels of the framebuffer</param>
+/// <param name="clip">Only these pixels are drawn to, getBounds of the target for all of them</param>
+void SpriteAtlas::blit(Framebuffer& target, const uint32_t sprite, const D2D1_RECT_F& rect, const D2D1_RECT_U& clip) const {
+	if (!isLoaded() || sprite >= sprite_count || rect.right <= rect.left || rect.bottom <= rect.top) return;
+
+	const auto& area = _sprites[sprite];
+	const auto pixels = Framebuffer::intersect(Framebuffer::toPixelRect(rect, target.getWidth(), target.getHeight()), clip);
+	if (pixels.left >= pixels.right || pixels.top >= pixels.bottom) return;
+
+	const auto stepX = area.width / (rect.right - rect.left);
+	const auto stepY = area.height / (rect.bottom - rect.top);
+	const auto firstX = (pixels.left + 0.5f - rect.left) * stepX;
+	const auto count = pixels.right - pixels.left;
+	const auto unscaled = stepX == 1.0f;
+
+	uint32_t gathered[BLIT_CHUNK];
+	for (auto y = pixels.top; y < pixels.bottom; y++) {
+		const auto sourceY = std::min(area.height - 1, static_cast<uint32_t>((y + 0.5f - rect.top) * stepY));
+		const auto* source = _pixels + static_cast<size_t>(area.y + sourceY) * _width + area.x;
+		auto* destination = target.getRow(y) + pixels.left;
+
+		if (unscaled) {
+			Framebuffer::blendSpan(destination, source + std::min(area.width - count, static_cast<uint32_t>(firstX)), count);
+			continue;
+		}
+
+		for (uint32_t done = 0; done < count; done += BLIT_CHUNK) {
+			const auto chunk = std::min(BLIT_CHUNK, count - done);
+			for (uint32_t i = 0; i < chunk; i++) {
+				gathered[i] = source[std::min(area.width - 1, static_cast<uint32_t>(firstX + (done + i) * stepX))];
+			}
+			Framebuffer::blendSpan(destination + done, gathered, chunk);
+		}
+	}
+}
+
+/// <summary>
+/// Paints a pose of the dino
+/// </summary>
+/// <param name="atlas">Atlas to paint into</param>
+/// <param name="sprite">Area of the pose</param>
+/// <param name="pose">One of the dino sprites</param>
+void SpriteAtlas::paintDino(Framebuffer& atlas, const Sprite& sprite, const SPRITE pose) {
+	const auto body = Framebuffer::toPixel(D2D1::ColorF(0.33f, 0.33f, 0.33f));
+	const auto eye = Framebuffer::toPixel(D2D1::ColorF(D2D1::ColorF::White));
+	const auto fill = [&atlas, &sprite](const uint32_t x, const uint32_t y, const uint32_t width, const uint32_t height, const uint32_t color) {
+		atlas.clearRect(D2D1::RectU(sprite.x + x, sprite.y + y, sprite.x + x + width, sprite.y + y + height), color);
+	};
+
+	//Head with an open mouth, neck, body, tail and arm
+	fill(12, 0, 18, 12, body);
+	fill(24, 9, 6, 1, 0);
+	fill(12, 12, 10, 4, body);
+	fill(4, 16, 18, 20, body);
+	fill(0, 18, 4, 10, body);
+	fill(22, 20, 4, 3, body);
+	fill(24, 23, 2, 3, body);
+
+	if (pose == dino_dead) {
+		//Crossed out eye
+		fill(21, 2, 1, 1, eye);
+		fill(23, 2, 1, 1, eye);
+		fill(22, 3, 1, 1, eye);
+		fill(21, 4, 1, 1, eye);
+		fill(23, 4, 1, 1, eye);
+	} else {
+		fill(21, 2, 3, 3, eye);
+	}
+
+	//Legs, running poses lift one of them
+	const auto leftUp = pose == dino_run_1;
+	const auto rightUp = pose == dino_run_0;
+	fill(7, 36, 4, leftUp ? 8 : 14, body);
+	fill(7, leftUp ? 42 : 47, 6, 2 + (leftUp ? 0 : 1), body);
+	fill(15, 36, 4, rightUp ? 8 : 14, body);
+	fill(15, rightUp ? 42 : 47, 6, 2 + (rightUp ? 0 : 1), body);
+}
+
+/// <summary>
+/// Paints a cactus with two arms standing on the bottom of a sprite
+/// </summary>
+/// <param name="atlas">Atlas to paint into</param>
+/// <param name="sprite">Area of the cactus</param>
+/// <param name="trunkX">Left edge of the trunk inside the sprite</param>
+/// <param name="trunkHeight">Height of the trunk</param>
+void SpriteAtlas::paintCactus(Framebuffer& atlas, const Sprite& sprite, const uint32_t trunkX, const uint32_t trunkHeight) {
+	const auto green = Framebuffer::toPixel(D2D1::ColorF(0.2f, 0.55f, 0.25f));
+	const auto light = Framebuffer::toPixel(D2D1::ColorF(0.35f, 0.7f, 0.35f));
+	const auto fill = [&atlas, &sprite](const uint32_t x, const uint32_t y, const uint32_t width, const uint32_t height, const uint32_t color) {
+		atlas.clearRect(D2D1::RectU(sprite.x + x, sprite.y + y, sprite.x + x + width, sprite.y + y + height), color);
+	};
+
+	const auto top = sprite.height - trunkHeight;
+	fill(trunkX, top, 7, trunkHeight, green);
+	fill(trunkX + 2, top + 2, 1, trunkHeight - 4, light);
+
+	//Left arm lower than the right one
+	const auto leftArm = top + trunkHeight * 6 / 10;
+	fill(trunkX - 6, leftArm, 6, 4, green);
+	fill(trunkX - 6, leftArm - 8, 4, 8, green);
+
+	const auto rightArm = top + trunkHeight * 4 / 10;
+	fill(trunkX + 7, rightArm, 6, 4, green);
+	fill(trunkX + 9, rightArm - 9, 4, 9, green);
+}
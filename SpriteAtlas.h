@@ -0,0 +1,96 @@
+#ifndef SPRITEATLAS_HPP
+#define SPRITEATLAS_HPP
+
+#include <windows.h>
+#include <cstdint>
+#include <vector>
+
+#include <d2d1.h>
+
+#include "Framebuffer.h"
+
+/// <summary>
+/// All sprites of the game packed into one picture.
+/// Atlas files store the pixels premultiplied in the layout of a Framebuffer,
+/// so opening one only maps it into memory and nothing gets decoded.
+/// Without a file the sprites are painted at startup, the same atlas can be baked into a file
+/// </summary>
+class SpriteAtlas {
+	public:
+		enum SPRITE {
+			dino_run_0,
+			dino_run_1,
+			dino_jump,
+			dino_dead,
+			cactus_normal,
+			cactus_wide,
+			cactus_high,
+			sprite_count
+		};
+
+		/// <summary>
+		/// Area of a sprite in the atlas
+		/// </summary>
+		struct Sprite {
+			uint32_t x;
+			uint32_t y;
+			uint32_t width;
+			uint32_t height;
+		};
+
+		/// <summary>
+		/// Header at the start of every atlas file, the sprites follow directly, the pixels at pixelOffset
+		/// </summary>
+		struct FileHeader {
+			char	 magic[4];
+			uint32_t version;
+			uint32_t width;
+			uint32_t height;
+			uint32_t spriteCount;
+			uint32_t pixelOffset;
+		};
+
+		static const uint32_t FILE_VERSION = 1;
+
+		SpriteAtlas();
+		~SpriteAtlas();
+
+		HRESULT open(const char* path);
+		void createDefault();
+		HRESULT save(const char* path) const;
+		void close();
+
+		bool isLoaded() const;
+		uint32_t getWidth() const;
+		uint32_t getHeight() const;
+		const Sprite& getSprite(uint32_t sprite) const;
+		D2D1_RECT_F getSourceRect(uint32_t sprite) const;
+
+		HRESULT createBitmap(ID2D1RenderTarget* renderTarget);
+		void discardBitmap();
+		ID2D1Bitmap* getBitmap() const;
+
+		void blit(Framebuffer& target, uint32_t sprite, const D2D1_RECT_F& rect, const D2D1_RECT_U& clip) const;
+
+		SpriteAtlas(const SpriteAtlas&) = delete;
+		void operator = (const SpriteAtlas&) = delete;
+
+	private:
+		HANDLE			_file;
+		HANDLE			_mapping;
+		const void*		_view;
+		const Sprite*	_sprites;
+		const uint32_t* _pixels;
+		uint32_t		_width;
+		uint32_t		_height;
+		ID2D1Bitmap*	_bitmap;
+
+		//Painted atlas when no file is mapped
+		std::vector<Sprite>	  _paintedSprites;
+		std::vector<uint32_t> _paintedPixels;
+
+		static void paintDino(Framebuffer& atlas, const Sprite& sprite, SPRITE pose);
+		static void paintCactus(Framebuffer& atlas, const Sprite& sprite, uint32_t trunkX, uint32_t trunkHeight);
+};
+
+#endif //SPRITEATLAS_HPP
@@ -0,0 +1,68 @@
+#ifndef SPSCRING_HPP
+#define SPSCRING_HPP
+
+#include <atomic>
+#include <cstddef>
+
+/// <summary>
+/// Lock-free ring buffer for exactly one producer thread and one consumer thread
+/// </summary>
+template<class T, size_t Capacity>
+class SpscRing {
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity has to be a power of two");
+
+	public:
+		SpscRing() :
+			_head	(0),
+			_tail	(0) {}
+
+		/// <summary>
+		/// Appends an item, only called by the producer
+		/// </summary>
+		/// <param name="item">Item to append</param>
+		/// <returns>False if the ring is full</returns>
+		bool tryPush(const T& item) {
+			const auto tail = _tail.load(std::memory_order_relaxed);
+			if (tail - _head.load(std::memory_order_acquire) == Capacity) return false;
+
+			_items[tail & (Capacity - 1)] = item;
+			_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// <summary>
+		/// Returns the oldest item without removing it, only called by the consumer
+		/// </summary>
+		/// <returns>Pointer to the item or nullptr if the ring is empty</returns>
+		const T* peek() const {
+			const auto head = _head.load(std::memory_order_relaxed);
+			if (head == _tail.load(std::memory_order_acquire)) return nullptr;
+
+			return &_items[head & (Capacity - 1)];
+		}
+
+		/// <summary>
+		/// Removes the oldest item, only called by the consumer
+		/// </summary>
+		/// <param name="item">Receives the item</param>
+		/// <returns>False if the ring is empty</returns>
+		bool tryPop(T& item) {
+			const auto head = _head.load(std::memory_order_relaxed);
+			if (head == _tail.load(std::memory_order_acquire)) return false;
+
+			item = _items[head & (Capacity - 1)];
+			_head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		SpscRing(const SpscRing&) = delete;
+		void operator = (const SpscRing&) = delete;
+
+	private:
+		//Head and tail on their own cache lines so producer and consumer do not share one
+		alignas(64) std::atomic<size_t> _head;
+		alignas(64) std::atomic<size_t> _tail;
+		alignas(64) T					_items[Capacity];
+};
+
+#endif //SPSCRING_HPP
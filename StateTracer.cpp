@@ -0,0 +1,502 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "StateTracer.h"
+#include "Logger.h"
+
+//Identifies trace files
+static const char TRACE_MAGIC[4] = { 'D', 'T', 'R', 'C' };
+
+const float StateTracer::SCALE = 256.0f;
+
+/// <summary>
+/// Converts a position or velocity to the fixed point value stored in the trace
+/// </summary>
+/// <param name="value">Value in pixel</param>
+/// <returns></returns>
+static int64_t quantize(const float value) {
+	return static_cast<int64_t>(std::llround(value * StateTracer::SCALE));
+}
+
+/// <summary>
+/// Appends a value as zigzag varint of its delta to the previous one of the column
+/// </summary>
+/// <param name="value">Value to append</param>
+void StateTracer::Column::append(const int64_t value) {
+	appendDelta(value - previous);
+	previous = value;
+}
+
+/// <summary>
+/// Appends a delta as zigzag varint
+/// </summary>
+/// <param name="delta">Delta to append</param>
+void StateTracer::Column::appendDelta(const int64_t delta) {
+	//Zigzag keeps small negative deltas short
+	auto encoded = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+	while (encoded >= 0x80) {
+		bytes.push_back(static_cast<uint8_t>(encoded | 0x80));
+		encoded >>= 7;
+	}
+	bytes.push_back(static_cast<uint8_t>(encoded));
+}
+
+/// <summary>
+/// Reads the next zigzag varint and adds it to the previous value of the column
+/// </summary>
+/// <param name="value">Receives the value</param>
+/// <returns>False if the column ends before the value does</returns>
+bool StateTracer::ColumnReader::next(int64_t& value) {
+	int64_t delta = 0;
+	if (!nextDelta(delta)) return false;
+
+	previous += delta;
+	value = previous;
+	return true;
+}
+
+/// <summary>
+/// Reads the next zigzag varint
+/// </summary>
+/// <param name="delta">Receives the delta</param>
+/// <returns>False if the column ends before the value does</returns>
+bool StateTracer::ColumnReader::nextDelta(int64_t& delta) {
+	uint64_t encoded = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		if (position == size) return false;
+
+		const auto byte = bytes[position++];
+		encoded |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) {
+			delta = static_cast<int64_t>(encoded >> 1) ^ -static_cast<int64_t>(encoded & 1);
+			return true;
+		}
+	}
+	return false;
+}
+
+/// <summary>
+/// Returns the number of bytes that were not read yet, every value takes at least one
+/// </summary>
+/// <returns></returns>
+size_t StateTracer::ColumnReader::getRemaining() const {
+	return size - position;
+}
+
+/// <summary>
+/// Orders obstacles by id
+/// </summary>
+/// <param name="other">Obstacle to compare with</param>
+/// <returns></returns>
+bool StateTracer::ObstacleValues::operator < (const ObstacleValues& other) const {
+	return id < other.id;
+}
+
+/// <summary>
+/// Forgets the previous frame, the next values are stored as they are
+/// </summary>
+void StateTracer::History::clear() {
+	players.clear();
+	obstacles.clear();
+	previousObstacles.clear();
+	nextPlayer = 0;
+}
+
+/// <summary>
+/// Starts a frame, players that were not in the previous frame start from 0
+/// </summary>
+/// <param name="playerCount">Number of players in the frame</param>
+void StateTracer::History::beginFrame(const uint32_t playerCount) {
+	players.resize(playerCount, PlayerValues{ 0, 0, 0 });
+	nextPlayer = 0;
+}
+
+/// <summary>
+/// Returns the values the next player had in the previous frame, they get replaced by the new ones
+/// </summary>
+/// <returns></returns>
+StateTracer::PlayerValues& StateTracer::History::nextPlayerValues() {
+	return players[nextPlayer++];
+}
+
+/// <summary>
+/// Returns the values an obstacle had in the previous frame, all 0 for a new obstacle
+/// </summary>
+/// <param name="id">Id of the obstacle</param>
+/// <returns></returns>
+StateTracer::ObstacleValues StateTracer::History::findObstacle(const uint64_t id) const {
+	const ObstacleValues key{ id, 0, 0 };
+	const auto it = std::lower_bound(previousObstacles.begin(), previousObstacles.end(), key);
+	return it != previousObstacles.end() && it->id == id ? *it : key;
+}
+
+/// <summary>
+/// Makes the obstacles of the frame the reference of the next one
+/// </summary>
+void StateTracer::History::endFrame() {
+	std::sort(obstacles.begin(), obstacles.end());
+	std::swap(obstacles, previousObstacles);
+	obstacles.clear();
+}
+
+/// <summary>
+/// Empties the block but keeps the memory of its columns
+/// </summary>
+/// <param name="frame">First frame the block will hold</param>
+void StateTracer::Block::reset(const uint32_t frame) {
+	firstFrame = frame;
+	frameCount = 0;
+	for (auto& column : columns) {
+		column.bytes.clear();
+		column.previous = 0;
+	}
+}
+
+/// <summary>
+/// Constructor
+/// </summary>
+StateTracer::StateTracer() :
+	_file			(INVALID_HANDLE_VALUE),
+	_stopping		(false),
+	_writeResult	(S_OK) {}
+
+/// <summary>
+/// Destructor
+/// </summary>
+StateTracer::~StateTracer() {
+	close();
+}
+
+/// <summary>
+/// Creates the trace file and starts the writer thread
+/// </summary>
+/// <param name="path">Path of the trace file</param>
+/// <returns>HRESULT</returns>
+HRESULT StateTracer::open(const char* path) {
+	close();
+
+	_file = CreateFile(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	auto hr = _file != INVALID_HANDLE_VALUE ? S_OK : E_FAIL;
+
+	if (SUCCEEDED(hr)) {
+		FileHeader header;
+		memcpy(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+		header.version = VERSION;
+		header.columnCount = column_count;
+		header.framesPerBlock = FRAMES_PER_BLOCK;
+		header.scale = SCALE;
+		header.reserved = 0;
+
+		DWORD written = 0;
+		hr = WriteFile(_file, &header, sizeof(header), &written, nullptr) ? S_OK : E_FAIL;
+	}
+	if (SUCCEEDED(hr)) {
+		_current.reset(new Block());
+		_current->reset(0);
+		_stopping = false;
+		_writeResult = S_OK;
+		_writer = std::thread(&StateTracer::writerLoop, this);
+	} else {
+		close();
+	}
+	return hr;
+}
+
+/// <summary>
+/// Writes the remaining frames and closes the trace file
+/// </summary>
+void StateTracer::close() {
+	if (_writer.joinable()) {
+		if (_current && _current->frameCount > 0) {
+			submit();
+		}
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stopping = true;
+		}
+		_condition.notify_one();
+		_writer.join();
+	}
+	if (_file != INVALID_HANDLE_VALUE) {
+		CloseHandle(_file);
+		_file = INVALID_HANDLE_VALUE;
+	}
+	_current.reset();
+	_pending.clear();
+	_free.clear();
+}
+
+/// <summary>
+/// Returns true if frames are being recorded
+/// </summary>
+/// <returns></returns>
+bool StateTracer::isOpen() const {
+	return _current != nullptr;
+}
+
+/// <summary>
+/// Starts recording a frame, the given number of players and obstacles has to follow
+/// </summary>
+/// <param name="frame">Number of the frame</param>
+/// <param name="playerCount">Number of players that will be added</param>
+/// <param name="obstacleCount">Number of obstacles that will be added</param>
+void StateTracer::beginFrame(const uint32_t frame, const uint32_t playerCount, const uint32_t obstacleCount) {
+	if (_current->frameCount == 0) {
+		_current->firstFrame = frame;
+		_history.clear();
+	}
+	_history.beginFrame(playerCount);
+	_current->columns[player_count].append(playerCount);
+	_current->columns[obstacle_count].append(obstacleCount);
+}
+
+/// <summary>
+/// Records the state of a player
+/// </summary>
+/// <param name="y">Bottom of the player</param>
+/// <param name="velocity">Vertical velocity of the player</param>
+/// <param name="health">Health of the player</param>
+void StateTracer::addPlayer(const float y, const float velocity, const int health) {
+	auto& previous = _history.nextPlayerValues();
+	const PlayerValues values{ quantize(y), quantize(velocity), health };
+
+	_current->columns[player_y].appendDelta(values.y - previous.y);
+	_current->columns[player_velocity].appendDelta(values.velocity - previous.velocity);
+	_current->columns[player_health].appendDelta(values.health - previous.health);
+	previous = values;
+}
+
+/// <summary>
+/// Records the state of an obstacle
+/// </summary>
+/// <param name="id">Id of the obstacle, has to stay the same while it lives and must not repeat in a frame</param>
+/// <param name="x">Left edge of the obstacle</param>
+/// <param name="type">Type of the obstacle</param>
+void StateTracer::addObstacle(const uint64_t id, const float x, const uint32_t type) {
+	const auto previous = _history.findObstacle(id);
+	const ObstacleValues values{ id, quantize(x), type };
+
+	_current->columns[obstacle_id].append(static_cast<int64_t>(id));
+	_current->columns[obstacle_x].appendDelta(values.x - previous.x);
+	_current->columns[obstacle_type].appendDelta(values.type - previous.type);
+	_history.obstacles.push_back(values);
+}
+
+/// <summary>
+/// Finishes the frame, hands the block to the writer once it is full
+/// </summary>
+void StateTracer::endFrame() {
+	_history.endFrame();
+	if (++_current->frameCount == FRAMES_PER_BLOCK) {
+		submit();
+	}
+}
+
+/// <summary>
+/// Queues the current block for writing and continues with a recycled one
+/// </summary>
+void StateTracer::submit() {
+	const auto nextFrame = _current->firstFrame + _current->frameCount;
+	std::unique_ptr<Block> next;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_pending.push_back(std::move(_current));
+		if (!_free.empty()) {
+			next = std::move(_free.back());
+			_free.pop_back();
+		}
+	}
+	_condition.notify_one();
+
+	if (!next) {
+		next.reset(new Block());
+	}
+	next->reset(nextFrame);
+	_current = std::move(next);
+}
+
+/// <summary>
+/// Writes queued blocks until the tracer is closed
+/// </summary>
+void StateTracer::writerLoop() {
+	while (true) {
+		std::unique_ptr<Block> block;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_condition.wait(lock, [this]() { return _stopping || !_pending.empty(); });
+
+			if (_pending.empty()) return;
+
+			block = std::move(_pending.front());
+			_pending.pop_front();
+		}
+
+		//After a failed write the blocks are only recycled, a trace with a gap would be misread
+		if (SUCCEEDED(_writeResult)) {
+			_writeResult = writeBlock(*block);
+			LOG_IF_FAILED(_writeResult, "Writing the trace");
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_free.push_back(std::move(block));
+	}
+}
+
+/// <summary>
+/// Writes a block to the trace file
+/// </summary>
+/// <param name="block">Block to write</param>
+/// <returns>HRESULT</returns>
+HRESULT StateTracer::writeBlock(const Block& block) {
+	BlockHeader header;
+	header.firstFrame = block.firstFrame;
+	header.frameCount = block.frameCount;
+	for (int i = 0; i < column_count; i++) {
+		header.columnBytes[i] = static_cast<uint32_t>(block.columns[i].bytes.size());
+	}
+
+	DWORD written = 0;
+	auto hr = WriteFile(_file, &header, sizeof(header), &written, nullptr) && written == sizeof(header) ? S_OK : E_FAIL;
+	for (const auto& column : block.columns) {
+		if (SUCCEEDED(hr) && !column.bytes.empty()) {
+			const auto size = static_cast<DWORD>(column.bytes.size());
+			hr = WriteFile(_file, column.bytes.data(), size, &written, nullptr) && written == size ? S_OK : E_FAIL;
+		}
+	}
+	return hr;
+}
+
+/// <summary>
+/// Reads a trace file back into frames
+/// </summary>
+/// <param name="path">Path of the trace file</param>
+/// <param name="frames">Receives the frames</param>
+/// <returns>HRESULT</returns>
+HRESULT StateTracer::read(const char* path, std::vector<Frame>& frames) {
+	auto file = CreateFile(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	auto hr = file != INVALID_HANDLE_VALUE ? S_OK : E_FAIL;
+
+	LARGE_INTEGER size;
+	if (SUCCEEDED(hr)) {
+		hr = GetFileSizeEx(file, &size) && size.QuadPart >= static_cast<LONGLONG>(sizeof(FileHeader)) ? S_OK : E_INVALIDARG;
+	}
+
+	HANDLE mapping = nullptr;
+	const void* view = nullptr;
+	if (SUCCEEDED(hr)) {
+		mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		hr = mapping ? S_OK : E_FAIL;
+	}
+	if (SUCCEEDED(hr)) {
+		view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		hr = view ? S_OK : E_FAIL;
+	}
+	if (SUCCEEDED(hr)) {
+		const auto& header = *static_cast<const FileHeader*>(view);
+		if (memcmp(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0 ||
+			header.version != VERSION ||
+			header.columnCount != column_count ||
+			!(header.scale > 0.0f)) {
+			hr = E_INVALIDARG;
+		}
+	}
+
+	frames.clear();
+	const auto* data = static_cast<const uint8_t*>(view);
+	const auto end = SUCCEEDED(hr) ? static_cast<uint64_t>(size.QuadPart) : 0;
+	uint64_t offset = sizeof(FileHeader);
+	while (SUCCEEDED(hr) && offset < end) {
+		BlockHeader block;
+		if (end - offset < sizeof(block)) {
+			hr = E_INVALIDARG;
+			break;
+		}
+		memcpy(&block, data + offset, sizeof(block));
+		offset += sizeof(block);
+
+		//Every block starts without a previous frame
+		ColumnReader columns[column_count];
+		History history;
+		history.clear();
+		for (int i = 0; i < column_count && SUCCEEDED(hr); i++) {
+			if (end - offset < block.columnBytes[i]) {
+				hr = E_INVALIDARG;
+			} else {
+				columns[i] = ColumnReader{ data + offset, block.columnBytes[i], 0, 0 };
+				offset += block.columnBytes[i];
+			}
+		}
+
+		const auto scale = static_cast<const FileHeader*>(view)->scale;
+		for (uint32_t i = 0; i < block.frameCount && SUCCEEDED(hr); i++) {
+			int64_t playerCount = 0;
+			int64_t obstacleCount = 0;
+			if (!columns[player_count].next(playerCount) || !columns[obstacle_count].next(obstacleCount) ||
+				playerCount < 0 || static_cast<uint64_t>(playerCount) > columns[player_y].getRemaining() ||
+				obstacleCount < 0 || static_cast<uint64_t>(obstacleCount) > columns[obstacle_id].getRemaining()) {
+				hr = E_INVALIDARG;
+				break;
+			}
+
+			Frame frame;
+			frame.frame = block.firstFrame + i;
+			frame.players.resize(static_cast<size_t>(playerCount));
+			frame.obstacles.resize(static_cast<size_t>(obstacleCount));
+
+			history.beginFrame(static_cast<uint32_t>(playerCount));
+			for (auto& player : frame.players) {
+				int64_t y, velocity, health;
+				if (!columns[player_y].nextDelta(y) || !columns[player_velocity].nextDelta(velocity) || !columns[player_health].nextDelta(health)) {
+					hr = E_INVALIDARG;
+					break;
+				}
+				auto& values = history.nextPlayerValues();
+				values.y += y;
+				values.velocity += velocity;
+				values.health += health;
+
+				player.y = static_cast<float>(values.y) / scale;
+				player.velocity = static_cast<float>(values.velocity) / scale;
+				player.health = static_cast<int>(values.health);
+			}
+			for (auto& obstacle : frame.obstacles) {
+				int64_t id, x, type;
+				if (FAILED(hr) || !columns[obstacle_id].next(id) || !columns[obstacle_x].nextDelta(x) || !columns[obstacle_type].nextDelta(type)) {
+					hr = E_INVALIDARG;
+					break;
+				}
+				auto values = history.findObstacle(static_cast<uint64_t>(id));
+				values.x += x;
+				values.type += type;
+				history.obstacles.push_back(values);
+
+				obstacle.id = values.id;
+				obstacle.x = static_cast<float>(values.x) / scale;
+				obstacle.type = static_cast<uint32_t>(values.type);
+			}
+			history.endFrame();
+			if (SUCCEEDED(hr)) {
+				frames.push_back(std::move(frame));
+			}
+		}
+
+		//A block has to use up exactly the bytes its header names
+		for (int i = 0; i < column_count && SUCCEEDED(hr); i++) {
+			if (columns[i].getRemaining() != 0) {
+				hr = E_INVALIDARG;
+			}
+		}
+	}
+
+	if (view) {
+		UnmapViewOfFile(view);
+	}
+	if (mapping) {
+		CloseHandle(mapping);
+	}
+	if (file != INVALID_HANDLE_VALUE) {
+		CloseHandle(file);
+	}
+	return hr;
+}
@@ -0,0 +1,197 @@
+#ifndef STATETRACER_HPP
+#define STATETRACER_HPP
+
+#include <windows.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// Records the state of every frame into per field columns.
+/// Values are stored as zigzag varints of their delta to the same entity in the previous frame,
+/// players are matched by their index and obstacles by their id.
+/// Full blocks are written to disk by a background thread so recording never waits for the file
+/// </summary>
+class StateTracer {
+	public:
+		enum COLUMN {
+			player_count,
+			player_y,
+			player_velocity,
+			player_health,
+			obstacle_count,
+			obstacle_id,
+			obstacle_x,
+			obstacle_type,
+			column_count
+		};
+
+		/// <summary>
+		/// Header at the start of every trace file
+		/// </summary>
+		struct FileHeader {
+			char	 magic[4];
+			uint32_t version;
+			uint32_t columnCount;
+			uint32_t framesPerBlock;
+			float	 scale;
+			uint32_t reserved;
+		};
+
+		/// <summary>
+		/// Header in front of every block, the column bytes follow in column order.
+		/// The first frame of a block has no previous frame, its values are stored as they are,
+		/// so blocks can be decoded on their own
+		/// </summary>
+		struct BlockHeader {
+			uint32_t firstFrame;
+			uint32_t frameCount;
+			uint32_t columnBytes[column_count];
+		};
+
+		/// <summary>
+		/// Decoded state of a player
+		/// </summary>
+		struct PlayerState {
+			float y;
+			float velocity;
+			int	  health;
+		};
+
+		/// <summary>
+		/// Decoded state of an obstacle
+		/// </summary>
+		struct ObstacleState {
+			uint64_t id;
+			float	 x;
+			uint32_t type;
+		};
+
+		/// <summary>
+		/// Decoded frame of a trace
+		/// </summary>
+		struct Frame {
+			uint32_t				   frame;
+			std::vector<PlayerState>   players;
+			std::vector<ObstacleState> obstacles;
+		};
+
+		static const uint32_t VERSION = 1;
+		static const uint32_t FRAMES_PER_BLOCK = 256;
+
+		//Positions and velocities are stored in 1/256 pixel
+		static const float SCALE;
+
+		StateTracer();
+		~StateTracer();
+
+		HRESULT open(const char* path);
+		void close();
+
+		static HRESULT read(const char* path, std::vector<Frame>& frames);
+
+		bool isOpen() const;
+
+		void beginFrame(uint32_t frame, uint32_t playerCount, uint32_t obstacleCount);
+		void addPlayer(float y, float velocity, int health);
+		void addObstacle(uint64_t id, float x, uint32_t type);
+		void endFrame();
+
+		StateTracer(const StateTracer&) = delete;
+		void operator = (const StateTracer&) = delete;
+
+	private:
+		/// <summary>
+		/// Delta encoded bytes of one field
+		/// </summary>
+		struct Column {
+			std::vector<uint8_t> bytes;
+			int64_t				 previous;
+
+			void append(int64_t value);
+			void appendDelta(int64_t delta);
+		};
+
+		/// <summary>
+		/// Reads the values of one column of a block back
+		/// </summary>
+		struct ColumnReader {
+			const uint8_t* bytes;
+			size_t		   size;
+			size_t		   position;
+			int64_t		   previous;
+
+			bool next(int64_t& value);
+			bool nextDelta(int64_t& delta);
+			size_t getRemaining() const;
+		};
+
+		/// <summary>
+		/// Quantized values of a player, the reference for its deltas in the next frame
+		/// </summary>
+		struct PlayerValues {
+			int64_t y;
+			int64_t velocity;
+			int64_t health;
+		};
+
+		/// <summary>
+		/// Quantized values of an obstacle, the reference for its deltas in the next frame
+		/// </summary>
+		struct ObstacleValues {
+			uint64_t id;
+			int64_t	 x;
+			int64_t	 type;
+
+			bool operator < (const ObstacleValues& other) const;
+		};
+
+		/// <summary>
+		/// Values of the previous frame, the obstacles are sorted by id so each one finds its own
+		/// </summary>
+		struct History {
+			std::vector<PlayerValues>	players;
+			std::vector<ObstacleValues>	obstacles;
+			std::vector<ObstacleValues>	previousObstacles;
+			size_t						nextPlayer;
+
+			void clear();
+			void beginFrame(uint32_t playerCount);
+			PlayerValues& nextPlayerValues();
+			ObstacleValues findObstacle(uint64_t id) const;
+			void endFrame();
+		};
+
+		struct Block {
+			uint32_t firstFrame;
+			uint32_t frameCount;
+			Column	 columns[column_count];
+
+			void reset(uint32_t frame);
+		};
+
+		HANDLE _file;
+
+		std::unique_ptr<Block>				_current;
+		History								_history;
+		std::deque<std::unique_ptr<Block>>	_pending;
+		std::vector<std::unique_ptr<Block>>	_free;
+
+		std::thread				_writer;
+		std::mutex				_mutex;
+		std::condition_variable	_condition;
+		bool					_stopping;
+
+		//Only used by the writer thread, it stops writing after the first error
+		HRESULT					_writeResult;
+
+		void submit();
+		void writerLoop();
+		HRESULT writeBlock(const Block& block);
+};
+
+#endif //STATETRACER_HPP
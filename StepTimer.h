@@ -17,6 +17,7 @@ class StepTimer {
 			m_framesPerSecond(0),
 			m_framesThisSecond(0),
 			m_qpcSecondCounter(0),
+			m_qpcTickTime(0),
 			m_isFixedTimeStep(false),
 			m_targetElapsedTicks(TicksPerSecond / 60) {
 			if (!QueryPerformanceFrequency(&m_qpcFrequency)) {
@@ -39,6 +40,9 @@ class StepTimer {
 		uint64_t GetTotalTicks() const { return m_totalTicks; }
 		double GetTotalSeconds() const { return TicksToSeconds(m_totalTicks); }
 
+		// Get the performance counter time the current update simulates up to.
+		int64_t GetTickTimestamp() const { return m_qpcTickTime; }
+
 		// Get total number of updates since start of the program.
 		uint32_t GetFrameCount() const { return m_frameCount; }
 
@@ -121,6 +125,9 @@ class StepTimer {
 					m_leftOverTicks -= m_targetElapsedTicks;
 					m_frameCount++;
 
+					// Catch-up updates end before the current time by the ticks still left over.
+					m_qpcTickTime = currentTime.QuadPart - static_cast<int64_t>(m_leftOverTicks * m_qpcFrequency.QuadPart / TicksPerSecond);
+
 					update();
 				}
 			} else {
@@ -129,6 +136,7 @@ class StepTimer {
 				m_totalTicks += timeDelta;
 				m_leftOverTicks = 0;
 				m_frameCount++;
+				m_qpcTickTime = currentTime.QuadPart;
 
 				update();
 			}
@@ -162,6 +170,9 @@ class StepTimer {
 		uint32_t m_framesThisSecond;
 		uint64_t m_qpcSecondCounter;
 
+		// Performance counter time of the current update.
+		int64_t m_qpcTickTime;
+
 		// Members for configuring fixed timestep mode.
 		bool m_isFixedTimeStep;
 		uint64_t m_targetElapsedTicks;
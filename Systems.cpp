@@ -0,0 +1,125 @@
+#ifdef DINO_FIXED_POINT
+#include <emmintrin.h>
+#endif
+
+#include "Systems.h"
+#include "Components.h"
+
+//Distance entities may have moved since the spatial index was built
+static const float CULL_MARGIN = 32.0f;
+
+#ifdef DINO_FIXED_POINT
+/// <summary>
+/// Multiplies four fixed point numbers by a factor in [0, 1), rounded exactly like Fixed::operator*.
+/// The number is split into its integer part and its fraction, so every partial product fits into 32 bits
+/// </summary>
+/// <param name="value">Four fixed point numbers</param>
+/// <param name="factor">Raw factor in the even lanes</param>
+/// <returns></returns>
+static __m128i multiplyFraction(const __m128i value, const __m128i factor) {
+	const auto high = _mm_srai_epi32(value, Fixed::FRACTION_BITS);
+	const auto low = _mm_and_si128(value, _mm_set1_epi32(Fixed::ONE - 1));
+
+	//The low 32 bits of an unsigned product equal the signed ones
+	const auto highEven = _mm_mul_epu32(high, factor);
+	const auto highOdd = _mm_mul_epu32(_mm_srli_epi64(high, 32), factor);
+	const auto lowEven = _mm_srli_epi64(_mm_mul_epu32(low, factor), Fixed::FRACTION_BITS);
+	const auto lowOdd = _mm_srli_epi64(_mm_mul_epu32(_mm_srli_epi64(low, 32), factor), Fixed::FRACTION_BITS);
+
+	const auto even = _mm_shuffle_epi32(_mm_add_epi32(highEven, lowEven), _MM_SHUFFLE(0, 0, 2, 0));
+	const auto odd = _mm_shuffle_epi32(_mm_add_epi32(highOdd, lowOdd), _MM_SHUFFLE(0, 0, 2, 0));
+	return _mm_unpacklo_epi32(even, odd);
+}
+#endif
+
+/// <summary>
+/// Moves the entities of a chunk by their velocity, requires transform and velocity
+/// </summary>
+/// <param name="chunk">Chunk to update</param>
+/// <param name="deltaTime">Time since last frame</param>
+void Systems::move(const ChunkView& chunk, const Scalar deltaTime) {
+	auto* transforms = chunk.get<TransformComponent>();
+	const auto* velocities = chunk.get<VelocityComponent>();
+	const auto size = chunk.size();
+	size_t i = 0;
+
+#ifdef DINO_FIXED_POINT
+	//Two entities per step, a transform fills a register and two velocities fill another
+	static_assert(sizeof(TransformComponent) == 16 && sizeof(VelocityComponent) == 8, "Kernel expects packed components");
+	if (deltaTime.raw() >= 0 && deltaTime.raw() < Fixed::ONE) {
+		const auto factor = _mm_set1_epi32(deltaTime.raw());
+		const auto zero = _mm_setzero_si128();
+
+		for (; i + 2 <= size; i += 2) {
+			const auto steps = multiplyFraction(_mm_loadu_si128(reinterpret_cast<const __m128i*>(velocities + i)), factor);
+
+			auto* first = reinterpret_cast<__m128i*>(transforms + i);
+			auto* second = reinterpret_cast<__m128i*>(transforms + i + 1);
+			_mm_store_si128(first, _mm_add_epi32(_mm_load_si128(first), _mm_unpacklo_epi64(steps, zero)));
+			_mm_store_si128(second, _mm_add_epi32(_mm_load_si128(second), _mm_unpackhi_epi64(steps, zero)));
+		}
+	}
+#endif
+
+	for (; i < size; i++) {
+		transforms[i].x += velocities[i].x * deltaTime;
+		transforms[i].y += velocities[i].y * deltaTime;
+	}
+}
+
+/// <summary>
+/// Kills the entities of a chunk that left the screen on the left side, requires transform and health
+/// </summary>
+/// <param name="chunk">Chunk to update</param>
+void Systems::expireOffscreen(const ChunkView& chunk) {
+	const auto* transforms = chunk.get<TransformComponent>();
+	auto* healths = chunk.get<HealthComponent>();
+	const auto size = chunk.size();
+
+	for (size_t i = 0; i < size; i++) {
+		if (transforms[i].x + transforms[i].w <= toScalar(0.0)) {
+			healths[i].value = 0;
+		}
+	}
+}
+
+/// <summary>
+/// Adds the entities inside the viewport that have a transform and a render color to the frame.
+/// Candidates come from the spatial index, so the cost depends on what is visible and not on the size of the world.
+/// Only indexed entities, the ones with a collider, can be drawn
+/// </summary>
+/// <param name="world">World to render</param>
+/// <param name="quadTree">Spatial index of the world</param>
+/// <param name="viewport">Visible area</param>
+/// <param name="visible">Scratch list for the candidates</param>
+/// <param name="snapshot">Frame to add the visuals to</param>
+void Systems::render(const World& world, const QuadTree& quadTree, const D2D1_RECT_F& viewport,
+	std::vector<QuadTree::Entry>& visible, FrameSnapshot& snapshot) {
+	//The index holds the bounds from before the last move, so search a little further
+	const auto area = D2D1::RectF(
+		viewport.left - CULL_MARGIN,
+		viewport.top - CULL_MARGIN,
+		viewport.right + CULL_MARGIN,
+		viewport.bottom + CULL_MARGIN);
+
+	visible.clear();
+	quadTree.getObjectsIn(area, QuadTree::ANY_LAYER, visible);
+
+	uint32_t drawn = 0;
+	for (auto& entry : visible) {
+		//Entities destroyed since the index was built are no longer alive
+		const auto* transform = world.get<TransformComponent>(entry.entity);
+		const auto* color = world.get<RenderColorComponent>(entry.entity);
+		if (!transform || !color) continue;
+
+		const auto aabb = getAABB(*transform);
+		if (!QuadTree::intersects(aabb, viewport)) continue;
+
+		const auto* sprite = world.get<SpriteComponent>(entry.entity);
+		snapshot.addRect(aabb, color->color, sprite ? sprite->sprite : FrameSnapshot::NO_SPRITE);
+		drawn++;
+	}
+
+	snapshot.drawn = drawn;
+	snapshot.culled = static_cast<uint32_t>(world.count<TransformComponent, RenderColorComponent>()) - drawn;
+}
@@ -0,0 +1,23 @@
+#ifndef SYSTEMS_HPP
+#define SYSTEMS_HPP
+
+#include <d2d1.h>
+
+#include "Ecs.h"
+#include "FrameSnapshot.h"
+#include "Quadtree.h"
+#include "Scalar.h"
+
+/// <summary>
+/// Systems that run over the entities of the world.
+/// The chunk based systems only touch the given chunk, so different chunks can run in parallel
+/// </summary>
+class Systems {
+	public:
+		static void move(const ChunkView& chunk, Scalar deltaTime);
+		static void expireOffscreen(const ChunkView& chunk);
+		static void render(const World& world, const QuadTree& quadTree, const D2D1_RECT_F& viewport,
+			std::vector<QuadTree::Entry>& visible, FrameSnapshot& snapshot);
+};
+
+#endif //SYSTEMS_HPP
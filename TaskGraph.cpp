@@ -0,0 +1,189 @@
+#include "TaskGraph.h"
+
+/// <summary>
+/// Constructor
+/// </summary>
+TaskGraph::TaskGraph() :
+	_remaining	(0),
+	_wakeups	(0),
+	_sleeping	(false) {}
+
+/// <summary>
+/// Destructor
+/// </summary>
+TaskGraph::~TaskGraph() = default;
+
+/// <summary>
+/// Adds a task that runs once on a single thread
+/// </summary>
+/// <param name="work">Work of the task</param>
+/// <returns>Id of the new task</returns>
+TaskGraph::TaskId TaskGraph::addTask(std::function<void()> work) {
+	return addParallelTask([]() { return static_cast<size_t>(1); }, 1, [work](size_t, size_t) {
+		work();
+	});
+}
+
+/// <summary>
+/// Adds a task whose range gets split into chunks that may run in parallel.
+/// The range size is queried when the task becomes ready, so it may depend on earlier tasks
+/// </summary>
+/// <param name="count">Returns the size of the range</param>
+/// <param name="grainSize">Maximum number of elements per chunk</param>
+/// <param name="work">Work for the range [begin, end)</param>
+/// <returns>Id of the new task</returns>
+TaskGraph::TaskId TaskGraph::addParallelTask(std::function<size_t()> count, const size_t grainSize, RangeWork work) {
+	std::unique_ptr<Task> task(new Task());
+	task->count = std::move(count);
+	task->work = std::move(work);
+	task->grainSize = grainSize > 0 ? grainSize : 1;
+	task->dependencyCount = 0;
+	task->pendingDependencies = 0;
+	task->pendingChunks = 0;
+
+	_tasks.push_back(std::move(task));
+	return _tasks.size() - 1;
+}
+
+/// <summary>
+/// Makes a task wait for another task to finish
+/// </summary>
+/// <param name="before">Task that has to finish first</param>
+/// <param name="after">Task that waits</param>
+void TaskGraph::addDependency(const TaskId before, const TaskId after) {
+	if (before >= _tasks.size() || after >= _tasks.size()) return;
+
+	_tasks[before]->successors.push_back(after);
+	_tasks[after]->dependencyCount++;
+}
+
+/// <summary>
+/// Runs all tasks in dependency order and returns when they have finished.
+/// The calling thread helps running jobs while it waits and sleeps when there are none,
+/// it wakes up when new chunks are queued or the last task finished
+/// </summary>
+/// <param name="jobs">Job system to run the tasks on</param>
+void TaskGraph::execute(JobSystem& jobs) {
+	if (_tasks.empty()) return;
+
+	for (auto& task : _tasks) {
+		task->pendingDependencies = task->dependencyCount;
+	}
+	_remaining = _tasks.size();
+
+	//Start all tasks without dependencies
+	for (auto& task : _tasks) {
+		if (task->dependencyCount == 0) {
+			schedule(jobs, task.get());
+		}
+	}
+
+	while (_remaining > 0) {
+		//Read before looking for jobs, so chunks queued in between are not slept through
+		const auto wakeups = _wakeups.load();
+		if (jobs.tryRunPending()) continue;
+
+		std::unique_lock<std::mutex> lock(_waitMutex);
+		_sleeping = true;
+		_waitCondition.wait(lock, [this, wakeups]() { return _remaining == 0 || _wakeups != wakeups; });
+		_sleeping = false;
+	}
+
+	//The last task is released under the lock, once it is free no thread touches the graph any more
+	std::lock_guard<std::mutex> lock(_waitMutex);
+}
+
+/// <summary>
+/// Runs all tasks in dependency order on the calling thread, the chunks of a task one after another.
+/// For graphs that are themselves run by a job, so they do not wait for the job system they are part of
+/// </summary>
+void TaskGraph::executeSerial() {
+	for (auto& task : _tasks) {
+		task->pendingDependencies = task->dependencyCount;
+		if (task->dependencyCount == 0) {
+			_ready.push_back(task.get());
+		}
+	}
+
+	while (!_ready.empty()) {
+		auto* task = _ready.back();
+		_ready.pop_back();
+
+		const auto count = task->count();
+		for (size_t begin = 0; begin < count; begin += task->grainSize) {
+			task->work(begin, begin + task->grainSize < count ? begin + task->grainSize : count);
+		}
+
+		for (auto successor : task->successors) {
+			auto* next = _tasks[successor].get();
+			if (next->pendingDependencies.fetch_sub(1) == 1) {
+				_ready.push_back(next);
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Splits a ready task into chunks and queues them
+/// </summary>
+/// <param name="jobs">Job system to run the task on</param>
+/// <param name="task">Task to schedule</param>
+void TaskGraph::schedule(JobSystem& jobs, Task* task) {
+	const auto count = task->count();
+	const auto chunks = (count + task->grainSize - 1) / task->grainSize;
+
+	if (chunks == 0) {
+		complete(jobs, task);
+		return;
+	}
+
+	//One extra chunk keeps the task from finishing before the waiting thread was told about the others
+	task->pendingChunks = chunks + 1;
+	for (size_t chunk = 0; chunk < chunks; chunk++) {
+		const auto begin = chunk * task->grainSize;
+		const auto end = begin + task->grainSize < count ? begin + task->grainSize : count;
+
+		jobs.submit([this, &jobs, task, begin, end]() {
+			task->work(begin, end);
+			if (task->pendingChunks.fetch_sub(1) == 1) {
+				complete(jobs, task);
+			}
+		});
+	}
+
+	wakeWaiter();
+	if (task->pendingChunks.fetch_sub(1) == 1) {
+		complete(jobs, task);
+	}
+}
+
+/// <summary>
+/// Releases the successors of a finished task
+/// </summary>
+/// <param name="jobs">Job system to run the successors on</param>
+/// <param name="task">Task that finished</param>
+void TaskGraph::complete(JobSystem& jobs, Task* task) {
+	for (auto successor : task->successors) {
+		auto* next = _tasks[successor].get();
+		if (next->pendingDependencies.fetch_sub(1) == 1) {
+			schedule(jobs, next);
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(_waitMutex);
+	if (--_remaining == 0) {
+		_waitCondition.notify_one();
+	}
+}
+
+/// <summary>
+/// Wakes the thread waiting in execute if it sleeps, called when new chunks were queued
+/// </summary>
+void TaskGraph::wakeWaiter() {
+	//Pairs with the check of the sleeping thread, either it sees the wakeup or this sees it sleeping
+	_wakeups++;
+	if (!_sleeping) return;
+
+	std::lock_guard<std::mutex> lock(_waitMutex);
+	_waitCondition.notify_one();
+}
@@ -0,0 +1,56 @@
+#ifndef TASKGRAPH_HPP
+#define TASKGRAPH_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "JobSystem.h"
+
+class TaskGraph {
+	public:
+		typedef size_t TaskId;
+		typedef std::function<void(size_t begin, size_t end)> RangeWork;
+
+		TaskGraph();
+		~TaskGraph();
+
+		TaskId addTask(std::function<void()> work);
+		TaskId addParallelTask(std::function<size_t()> count, size_t grainSize, RangeWork work);
+
+		void addDependency(TaskId before, TaskId after);
+		void execute(JobSystem& jobs);
+		void executeSerial();
+
+	private:
+		struct Task {
+			std::function<size_t()> count;
+			RangeWork				work;
+			size_t					grainSize;
+			std::vector<TaskId>		successors;
+			int						dependencyCount;
+			std::atomic<int>		pendingDependencies;
+			std::atomic<size_t>		pendingChunks;
+		};
+
+		std::vector<std::unique_ptr<Task>> _tasks;
+		std::atomic<size_t>				   _remaining;
+
+		//The thread running execute sleeps here once it finds no job, until chunks are queued or the graph is done
+		std::mutex						   _waitMutex;
+		std::condition_variable			   _waitCondition;
+		std::atomic<uint64_t>			   _wakeups;
+		std::atomic<bool>				   _sleeping;
+
+		//Tasks that are ready while the graph runs serially
+		std::vector<Task*>				   _ready;
+
+		void schedule(JobSystem& jobs, Task* task);
+		void complete(JobSystem& jobs, Task* task);
+		void wakeWaiter();
+};
+
+#endif //TASKGRAPH_HPP
@@ -1,12 +1,35 @@
 #include "Transform2d.h"
 
-bool Transform2D::collisionMatrix[4][4] = {
-	false,	false,	false,	false,
-	false,	false,	true,	false,
-	false,	true,	false,	true,
-	false,	false,	true,	false,
+Transform2D::LayerMask Transform2D::collisionMatrix[LAYER_COUNT] = {
+	cactus,					//player_bullet
+	player_bullet | player,	//cactus
+	cactus,					//player
 };
 
+/// <summary>
+/// Returns the mask of all layers the given layer collides with
+/// </summary>
+/// <param name="layer">Layer to check</param>
+/// <returns></returns>
+Transform2D::LayerMask Transform2D::getCollisionMask(const LAYER layer) {
+	for (int i = 0; i < LAYER_COUNT; i++) {
+		if (layer == (1u << i)) {
+			return collisionMatrix[i];
+		}
+	}
+	return 0;
+}
+
+/// <summary>
+/// Returns true if objects on the given layers should collide
+/// </summary>
+/// <param name="layer">Layer of the first object</param>
+/// <param name="other">Layer of the second object</param>
+/// <returns></returns>
+bool Transform2D::canCollide(const LAYER layer, const LAYER other) {
+	return (getCollisionMask(layer) & other) != 0;
+}
+
 /// <summary>
 /// Constructor
 /// </summary>
@@ -15,10 +38,10 @@ bool Transform2D::collisionMatrix[4][4] = {
 /// <param name="width">Width of the object</param>
 /// <param name="height">Height of the object</param>
 Transform2D::Transform2D(const float x, const float y, const float width, const float height):
-	_x			(x),
-	_y			(y),
-	_w		(width),
-	_h		(height) {
+	_x			(toScalar(x)),
+	_y			(toScalar(y)),
+	_w		(toScalar(width)),
+	_h		(toScalar(height)) {
 	
 }
 
@@ -31,43 +54,51 @@ Transform2D::~Transform2D() = default;
 /// Returns the x position
 /// </summary>
 /// <returns></returns>
-float Transform2D::getX() const { return _x; }
+float Transform2D::getX() const { return toFloat(_x); }
 
 /// <summary>
 /// Returns the y position
 /// </summary>
 /// <returns></returns>
-float Transform2D::getY() const { return _y; }
+float Transform2D::getY() const { return toFloat(_y); }
 
 /// <summary>
 /// Returns the width
 /// </summary>
 /// <returns></returns>
-float Transform2D::getWidth() const { return _w; }
+float Transform2D::getWidth() const { return toFloat(_w); }
 
 /// <summary>
 /// Returns the height
 /// </summary>
 /// <returns></returns>
-float Transform2D::getHeight() const { return _h; }
+float Transform2D::getHeight() const { return toFloat(_h); }
 
 /// <summary>
 /// Returns the axis-aligned bounding box of this object
 /// </summary>
 /// <returns>Rect</returns>
 D2D1_RECT_F Transform2D::getAABB() const {
-	const auto rect = D2D1::RectF(_x, _y - _h, _x + _w, _y);
+	const auto rect = D2D1::RectF(toFloat(_x), toFloat(_y - _h), toFloat(_x + _w), toFloat(_y));
 	return rect;
 }
 
+/// <summary>
+/// Returns the bounding box of this object in simulation numbers
+/// </summary>
+/// <returns></returns>
+Bounds Transform2D::getBounds() const {
+	return Bounds{ _x, _y - _h, _x + _w, _y };
+}
+
 /// <summary>
 /// Sets the size of this object
 /// </summary>
 /// <param name="width">Width of the object</param>
 /// <param name="height">Height of the object</param>
 void Transform2D::setSize(const float width, const float height) {
-	_w = width;
-	_h = height;
+	_w = toScalar(width);
+	_h = toScalar(height);
 }
 
 /// <summary>
@@ -76,8 +107,8 @@ void Transform2D::setSize(const float width, const float height) {
 /// <param name="x"></param>
 /// <param name="y"></param>
 void Transform2D::setPos(const float x, const float y) {
-	_x = x;
-	_y = y;
+	_x = toScalar(x);
+	_y = toScalar(y);
 }
 
 /// <summary>
@@ -87,12 +118,20 @@ void Transform2D::setPos(const float x, const float y) {
 /// <returns></returns>
 bool Transform2D::isColliding(Transform2D* other) const {
 	if (other == nullptr) return false;
-	const auto otherAABB = other->getAABB();
-	const auto myAABB = getAABB();
+	return isColliding(other->getBounds());
+}
+
+/// <summary>
+/// Returns true if this transform collides with the given bounding box, false if not
+/// </summary>
+/// <param name="otherBounds">Bounding box to check against</param>
+/// <returns></returns>
+bool Transform2D::isColliding(const Bounds& otherBounds) const {
+	const auto myBounds = getBounds();
 
 	//Collision tests
-	if (myAABB.right < otherAABB.left || myAABB.left > otherAABB.right) return false;
-	if (myAABB.top > otherAABB.bottom || myAABB.bottom < otherAABB.top) return false;
+	if (myBounds.right < otherBounds.left || myBounds.left > otherBounds.right) return false;
+	if (myBounds.top > otherBounds.bottom || myBounds.bottom < otherBounds.top) return false;
 
 	return true;
 }
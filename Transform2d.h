@@ -2,26 +2,49 @@
 #define TRANSFORMTWOD_HPP
 #include <d2d1.h>
 
+#include "Scalar.h"
+
+/// <summary>
+/// Bounding box in simulation numbers, collisions are decided on these so they stay deterministic
+/// </summary>
+struct Bounds {
+	Scalar left;
+	Scalar top;
+	Scalar right;
+	Scalar bottom;
+};
+
 class Transform2D {
 	protected:
-		float _x;
-		float _y;
-		float _w;
-		float _h;
+		Scalar _x;
+		Scalar _y;
+		Scalar _w;
+		Scalar _h;
 
 	public:
+		typedef unsigned int LayerMask;
+
 		/// <summary>
-		/// Collision matrix to determine which layers should collide
+		/// Layers are single bits, so a set of layers fits into a LayerMask
 		/// </summary>
-		static bool collisionMatrix[4][4];
-
 		enum LAYER {
 			no_collisions = 0,
-			player_bullet = 1,
-			cactus = 2,
-			player = 3
+			player_bullet = 1 << 0,
+			cactus = 1 << 1,
+			player = 1 << 2
 		};
 
+		static const int LAYER_COUNT = 3;
+
+		/// <summary>
+		/// Collision matrix to determine which layers should collide,
+		/// holds the mask of layers colliding with each layer, indexed by the bit of the layer
+		/// </summary>
+		static LayerMask collisionMatrix[LAYER_COUNT];
+
+		static LayerMask getCollisionMask(LAYER layer);
+		static bool canCollide(LAYER layer, LAYER other);
+
 		Transform2D(float x, float y, float width, float height);
 		virtual ~Transform2D();
 
@@ -31,12 +54,14 @@ class Transform2D {
 		float getHeight() const;
 
 		D2D1_RECT_F getAABB() const;
+		Bounds getBounds() const;
 
 		void setSize(float width, float height);
 		void setPos(float x, float y);
 		void setLayer(LAYER layer);
 
 		bool isColliding(Transform2D* other) const;
+		bool isColliding(const Bounds& otherBounds) const;
 
 		LAYER getLayer() const;
 
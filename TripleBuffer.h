@@ -0,0 +1,67 @@
+#ifndef TRIPLEBUFFER_HPP
+#define TRIPLEBUFFER_HPP
+
+#include <atomic>
+
+/// <summary>
+/// Lock-free triple buffer for one writer thread and one reader thread.
+/// The writer always has a buffer to fill, the reader always sees the latest published one
+/// </summary>
+template<class T>
+class TripleBuffer {
+	public:
+		TripleBuffer() :
+			_write	(0),
+			_middle	(1),
+			_read	(2) {}
+
+		/// <summary>
+		/// Returns the buffer the writer fills, only called by the writer
+		/// </summary>
+		/// <returns></returns>
+		T& getWriteBuffer() {
+			return _buffers[_write];
+		}
+
+		/// <summary>
+		/// Hands the filled buffer to the reader and takes the unused one, only called by the writer
+		/// </summary>
+		void publish() {
+			const auto previous = _middle.exchange(_write | FRESH, std::memory_order_acq_rel);
+			_write = previous & INDEX_MASK;
+		}
+
+		/// <summary>
+		/// Takes the latest published buffer if there is a newer one, only called by the reader
+		/// </summary>
+		/// <returns>True if the read buffer changed</returns>
+		bool acquireLatest() {
+			if ((_middle.load(std::memory_order_acquire) & FRESH) == 0) return false;
+
+			const auto previous = _middle.exchange(_read, std::memory_order_acq_rel);
+			_read = previous & INDEX_MASK;
+			return true;
+		}
+
+		/// <summary>
+		/// Returns the buffer the reader currently owns, only called by the reader
+		/// </summary>
+		/// <returns></returns>
+		const T& getReadBuffer() const {
+			return _buffers[_read];
+		}
+
+		TripleBuffer(const TripleBuffer&) = delete;
+		void operator = (const TripleBuffer&) = delete;
+
+	private:
+		static const unsigned int INDEX_MASK = 3;
+		static const unsigned int FRESH = 4;
+
+		T						  _buffers[3];
+		unsigned int			  _write;
+		std::atomic<unsigned int> _middle;
+		unsigned int			  _read;
+};
+
+#endif //TRIPLEBUFFER_HPP